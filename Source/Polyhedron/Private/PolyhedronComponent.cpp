@@ -1,24 +1,42 @@
 // Copyright 2024 TabbyCoder
 
 #include "PolyhedronComponent.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceDynamic.h"
 #include "Helpers.h"
+#include "PolyhedronTerrain.h"
+#include "PolyhedronTools.h"
 
 namespace {
-  FVector ConvertToSphericalCoordinates(const FVector& CartesianPoint) {
-    double X = CartesianPoint.X;
-    double Y = CartesianPoint.Y;
-    double Z = CartesianPoint.Z;
-
-    // Calculate radius
-    double Radius = FMath::Sqrt(X * X + Y * Y + Z * Z);
-
-    // Calculate theta or azimuth or longitude
-    double Theta = FMath::Atan2(Y, X);
+  // Approximates FMath::Atan2() within 2e-6 radians, without branches, so that the compiler can vectorize the loops over
+  // many vertices. The polynomial fits the arctangent on [0, 1]; the other octants are folded onto it.
+  FORCEINLINE double ApproximateAtan2(double Y, double X) {
+    double AbsX = FMath::Abs(X), AbsY = FMath::Abs(Y);
+    double Ratio = FMath::Min(AbsX, AbsY) / FMath::Max(FMath::Max(AbsX, AbsY), UE_DOUBLE_SMALL_NUMBER);
+    double Square = Ratio * Ratio;
+    double Angle = Ratio * (0.99997726 + Square * (-0.33262347 + Square * (0.19354346 + Square * (-0.11643287 + Square * (0.05265332 + Square * -0.01172120)))));
+    Angle = AbsY > AbsX ? UE_DOUBLE_HALF_PI - Angle : Angle;
+    Angle = X < 0.0 ? UE_DOUBLE_PI - Angle : Angle;
+    return Y < 0.0 ? -Angle : Angle;
+  }
 
-    // Calculate phi or inclination or latitude
-    double Phi = (Radius > 0.0f) ? FMath::Asin(Z / Radius) : 0.0f;
+  // Projects a batch of vertices into spherical coordinates: U follows the longitude and V the latitude.
+  // The latitude, asin(Z / Radius), is also atan2(Z, DistanceToAxis), which saves the division and the asin.
+  void ProjectOntoSphere(TArrayView<const FVector> Vertices, TArrayView<FVector2D> OutUVs) {
+    for (int32 VertexIndex = 0; VertexIndex < Vertices.Num(); ++VertexIndex) {
+      const FVector& Vertex = Vertices[VertexIndex];
+      double Theta = ApproximateAtan2(Vertex.Y, Vertex.X);
+      double Phi = ApproximateAtan2(Vertex.Z, FMath::Sqrt(Vertex.X * Vertex.X + Vertex.Y * Vertex.Y));
+      OutUVs[VertexIndex] = FVector2D(1.0 - (Theta + UE_DOUBLE_PI) / UE_DOUBLE_TWO_PI, 1.0 - (Phi + UE_DOUBLE_HALF_PI) / UE_DOUBLE_PI);
+    }
+  }
 
-    return FVector(Radius, 1.0 - (Theta + UE_DOUBLE_PI) / UE_DOUBLE_TWO_PI, 1.0 - (Phi + UE_DOUBLE_HALF_PI) / UE_DOUBLE_PI);
+  // Projects a batch of vertices onto the unit sphere, for the Cubic projection.
+  void ProjectOntoUnitSphere(TArrayView<const FVector> Vertices, TArrayView<FVector> OutDirections) {
+    for (int32 VertexIndex = 0; VertexIndex < Vertices.Num(); ++VertexIndex) {
+      OutDirections[VertexIndex] = Vertices[VertexIndex].GetSafeNormal();
+    }
   }
 
   enum class EPolyhedronCubicFace : uint8 {
@@ -49,6 +67,260 @@ namespace {
     case EPolyhedronCubicFace::NegativeZ: return FVector2D(-Normal.X, Normal.Y); break;
     }
   }
+
+  // The 2D basis of the Cellular texture coordinates on a polygon: U grows along the SidewaysAxis, V along the UpwardAxis.
+  void GetCellularAxes(const FVector& PolygonNormal, FVector& OutUpwardAxis, FVector& OutSidewaysAxis) {
+    FVector UpAxis = FMath::Abs(FVector::ZAxisVector.Dot(PolygonNormal)) > 0.90 ? FVector::XAxisVector : FVector::ZAxisVector;
+    OutUpwardAxis = (UpAxis - UpAxis.ProjectOnToNormal(PolygonNormal)).GetUnsafeNormal();
+    OutSidewaysAxis = PolygonNormal.Cross(OutUpwardAxis).GetUnsafeNormal();
+  }
+
+  // Appends one polygon to the mesh section buffers, fan-triangulated.
+  // Without bBuildGeometry, only the texture coordinates are appended. Without a PolygonIndex, the PolygonUVs are skipped.
+  // The Spherical and Cubic projections of the vertices are computed beforehand, see FPolyhedronSectionBuilder.
+  void AppendPolygon(FPolyhedronSection& Section, const FPolyhedronMesh& Polyhedron, const FPolyhedronPolygon& Polygon, EPolyhedronUVGeneration UVGeneration, bool bBuildGeometry, int32 PolygonIndex, TArrayView<const FVector2D> VertexUVs, TArrayView<const FVector> VertexDirections) {
+    int32 PolygonVertexCount = Polygon.VertexIndices.Num();
+
+    // Compute the vertex normal; this assumes planar polygons.
+    FVector PolygonNormal = FPolyhedronTools::GetPolygonNormal(Polyhedron, Polygon);
+
+    // Copy the vertex data into the final mesh arrays.
+    int32 PolygonVertexOffset = Section.Positions.Num();
+    if (bBuildGeometry) {
+      for (const int32& VertexIndex : Polygon.VertexIndices) {
+        Section.Positions.Add(Polyhedron.Vertices[VertexIndex]);
+        Section.Normals.Add(PolygonNormal);
+      }
+      if (PolygonIndex != INDEX_NONE) {
+        FVector2D PolygonUV(PolygonIndex % UPolyhedronComponent::PolygonStateTextureWidth, PolygonIndex / UPolyhedronComponent::PolygonStateTextureWidth);
+        for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+          Section.PolygonUVs.Add(PolygonUV);
+        }
+      }
+    }
+
+    // Calculate the offset for each vertex position away from the center's normal.
+    if (UVGeneration == EPolyhedronUVGeneration::Cellular || UVGeneration == EPolyhedronUVGeneration::CellularArray) {
+      // Use the PolygonNormal to generate a 2D basis for the local UV coordinates.
+      FVector UpwardAxis, SidewaysAxis;
+      GetCellularAxes(PolygonNormal, UpwardAxis, SidewaysAxis);
+
+      // Compute the center of the polygon, which will be (0.5, 0.5), and the 2D bounding box of the polygon.
+      // The center of the polygon produces a PlanarOffset of (0, 0).
+      FVector PolygonCenter = FPolyhedronTools::GetPolygonCenter(Polyhedron, Polygon);
+      FBox2D PolygonUVBounds;
+
+      for (const int32& VertexIndex : Polygon.VertexIndices) {
+        FVector CenterOffset = Polyhedron.Vertices[VertexIndex] - PolygonCenter;
+        CenterOffset -= CenterOffset.ProjectOnToNormal(PolygonNormal);
+        FVector2D PlanarOffset(CenterOffset.Dot(SidewaysAxis), CenterOffset.Dot(UpwardAxis));
+        PolygonUVBounds += PlanarOffset;
+        Section.UVs.Add(PlanarOffset); // Record this value, but it is not a texture coordinate.
+      }
+
+      // Rescale the texture coordinates in the [0,1] range, around the center.
+      //--------
+      // Note that the UV Bounds should always include (0, 0), which we want to map to (0.5, 0.5).
+      // Retrieve the largest distance in Min/Max and in U/V.
+      double UVBoundMaxDistance = FMath::Max(-PolygonUVBounds.Min.GetMin(), PolygonUVBounds.Max.GetMax());
+      float PolygonUVScaleFactor = 0.5 / UVBoundMaxDistance;
+      int32 PolygonUVOffset = Section.UVs.Num() - PolygonVertexCount;
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < Polygon.VertexIndices.Num(); ++PolygonVertexIndex) {
+        FVector2D& MeshUV = Section.UVs[PolygonUVOffset + PolygonVertexIndex];
+        MeshUV = FVector2D(0.5, 0.5) + PolygonUVScaleFactor * MeshUV;
+      }
+    } else if (UVGeneration == EPolyhedronUVGeneration::Spherical) {
+      // To fix the wrapping problem, pin on the first vertex of the polygon.
+      const FVector2D& Pin = VertexUVs[Polygon.VertexIndices[0]];
+      Section.UVs.Add(Pin);
+
+      for (int32 PolygonVertexIndex = 1; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+        FVector2D UV = VertexUVs[Polygon.VertexIndices[PolygonVertexIndex]];
+        if (UV.X - Pin.X < -0.5) UV.X += 1.0;
+        else if (UV.X - Pin.X > 0.5) UV.X -= 1.0;
+        if (UV.Y - Pin.Y < -0.5) UV.Y += 1.0;
+        else if (UV.Y - Pin.Y > 0.5) UV.Y -= 1.0;
+
+        Section.UVs.Add(UV);
+      }
+    } else if (UVGeneration == EPolyhedronUVGeneration::Cubic) {
+      // Select the Face of the cube based on the Normal.
+      EPolyhedronCubicFace Pin = ChooseFaceForCubicProjection(PolygonNormal);
+      for (int32 VertexIndex : Polygon.VertexIndices) {
+        // Project each coordinate unto the cube.
+        FVector2D UV = ProjectOntoCube(VertexDirections[VertexIndex], Pin);
+        Section.UVs.Add((UV + FVector2D(1.0, 1.0)) / FVector2D(2.0, 2.0));
+      }
+    }
+    if (UVGeneration == EPolyhedronUVGeneration::CellularArray) {
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+        Section.SliceUVs.Add(FVector2D(Polygon.MaterialIndex, 0.0));
+      }
+    }
+
+    // The tangents follow the texture coordinates, which are planar on each polygon.
+    if (UVGeneration != EPolyhedronUVGeneration::None) {
+      FProcMeshTangent PolygonTangent = FPolyhedronSectionBuilder::GetPolygonTangent(Polyhedron, Polygon, PolygonNormal, UVGeneration);
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+        Section.Tangents.Add(PolygonTangent);
+      }
+    }
+
+    // Fan-triangulate the polygon into the mesh arrays.
+    if (!bBuildGeometry) return;
+    for (int32 PolygonVertexIndex = 2; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+      Section.Triangles.Add(PolygonVertexOffset);
+      Section.Triangles.Add(PolygonVertexOffset + PolygonVertexIndex - 1);
+      Section.Triangles.Add(PolygonVertexOffset + PolygonVertexIndex);
+    }
+  }
+}
+
+FPolyhedronSectionBuilder::FPolyhedronSectionBuilder(const FPolyhedronMesh& InPolyhedron, EPolyhedronUVGeneration InUVGeneration, bool bInBuildGeometry, bool bInEncodePolygonIndices)
+  : Polyhedron(InPolyhedron)
+  , UVGeneration(InUVGeneration)
+  , bBuildGeometry(bInBuildGeometry)
+  , bEncodePolygonIndices(bInBuildGeometry && bInEncodePolygonIndices) {
+  if (bEncodePolygonIndices && Polyhedron.Polygons.Num() > UPolyhedronComponent::MaxEncodedPolygonCount) {
+    REPORT_ERROR("Cannot encode the indices of %d polygons in half floats, only %d", Polyhedron.Polygons.Num(), UPolyhedronComponent::MaxEncodedPolygonCount);
+    bEncodePolygonIndices = false;
+  }
+
+  // Count the Polygon-Vertex pairs and the triangles of each section.
+  TArray<int32> UniqueVertexTotals, TriangleTotals;
+  for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+    int32 SectionIndex = GetSectionIndex(Polygon, UVGeneration);
+    if (SectionIndex == INDEX_NONE) continue;
+    if (SectionIndex >= UniqueVertexTotals.Num()) {
+      UniqueVertexTotals.SetNumZeroed(SectionIndex + 1);
+      TriangleTotals.SetNumZeroed(SectionIndex + 1);
+    }
+    int32 PolygonVertexCount = Polygon.VertexIndices.Num();
+    UniqueVertexTotals[SectionIndex] += PolygonVertexCount;
+    TriangleTotals[SectionIndex] += PolygonVertexCount - 2; // Fan-triangulation
+  }
+
+  // Allocate the mesh buffers.
+  Sections.SetNum(UniqueVertexTotals.Num());
+  for (int32 MaterialIndex = 0; MaterialIndex < Sections.Num(); ++MaterialIndex) {
+    FPolyhedronSection& Section = Sections[MaterialIndex];
+    Section.MaterialIndex = MaterialIndex;
+    if (UVGeneration != EPolyhedronUVGeneration::None) {
+      Section.UVs.Reserve(UniqueVertexTotals[MaterialIndex]);
+      Section.Tangents.Reserve(UniqueVertexTotals[MaterialIndex]);
+    }
+    if (UVGeneration == EPolyhedronUVGeneration::CellularArray) {
+      Section.SliceUVs.Reserve(UniqueVertexTotals[MaterialIndex]);
+    }
+    if (bBuildGeometry) {
+      Section.Positions.Reserve(UniqueVertexTotals[MaterialIndex]);
+      Section.Normals.Reserve(UniqueVertexTotals[MaterialIndex]);
+      if (bEncodePolygonIndices) {
+        Section.PolygonUVs.Reserve(UniqueVertexTotals[MaterialIndex]);
+      }
+      Section.Triangles.Reserve(TriangleTotals[MaterialIndex] * 3);
+    }
+  }
+
+  // The projection of the vertices runs in Build(), within its time budget.
+  if (UVGeneration == EPolyhedronUVGeneration::Spherical) {
+    VertexUVs.SetNumUninitialized(Polyhedron.Vertices.Num());
+  } else if (UVGeneration == EPolyhedronUVGeneration::Cubic) {
+    VertexDirections.SetNumUninitialized(Polyhedron.Vertices.Num());
+  }
+}
+
+int32 FPolyhedronSectionBuilder::GetSectionIndex(const FPolyhedronPolygon& Polygon, EPolyhedronUVGeneration UVGeneration) {
+  if (Polygon.MaterialIndex < 0 || Polygon.VertexIndices.Num() < 3) return INDEX_NONE;
+  return UVGeneration == EPolyhedronUVGeneration::CellularArray ? 0 : Polygon.MaterialIndex;
+}
+
+FProcMeshTangent FPolyhedronSectionBuilder::GetPolygonTangent(const FPolyhedronMesh& Polyhedron, const FPolyhedronPolygon& Polygon, const FVector& PolygonNormal, EPolyhedronUVGeneration UVGeneration) {
+  // Find the directions in which U and V grow, from the basis of each texture coordinate generation.
+  FVector UDirection, VDirection;
+  switch (UVGeneration) {
+  case EPolyhedronUVGeneration::Cellular:
+  case EPolyhedronUVGeneration::CellularArray:
+    GetCellularAxes(PolygonNormal, VDirection, UDirection);
+    break;
+  case EPolyhedronUVGeneration::Spherical: {
+    // U grows westwards and V southwards, see ProjectOntoSphere().
+    FVector PolygonCenter = FPolyhedronTools::GetPolygonCenter(Polyhedron, Polygon);
+    UDirection = FVector(PolygonCenter.Y, -PolygonCenter.X, 0.0);
+    VDirection = -FVector::ZAxisVector;
+    break;
+  }
+  case EPolyhedronUVGeneration::Cubic: {
+    // The projection unto a face is linear: its axes are the projections of the unit vectors.
+    EPolyhedronCubicFace Pin = ChooseFaceForCubicProjection(PolygonNormal);
+    FVector2D X = ProjectOntoCube(FVector::XAxisVector, Pin), Y = ProjectOntoCube(FVector::YAxisVector, Pin), Z = ProjectOntoCube(FVector::ZAxisVector, Pin);
+    UDirection = FVector(X.X, Y.X, Z.X);
+    VDirection = FVector(X.Y, Y.Y, Z.Y);
+    break;
+  }
+  default:
+    return FProcMeshTangent();
+  }
+
+  // The tangent is U's direction within the polygon; the sign of the bitangent makes it follow V.
+  FVector TangentX = (UDirection - UDirection.ProjectOnToNormal(PolygonNormal)).GetSafeNormal();
+  if (TangentX.IsZero()) {
+    // At the poles of the Spherical projection, U has no direction.
+    FVector Unused;
+    PolygonNormal.FindBestAxisVectors(TangentX, Unused);
+  }
+  return FProcMeshTangent(TangentX, PolygonNormal.Cross(TangentX).Dot(VDirection) < 0.0);
+}
+
+bool FPolyhedronSectionBuilder::Build(double TimeBudgetSeconds) {
+  // Only look at the clock once in a while; it is not free either.
+  static constexpr int32 PolygonsBetweenClockChecks = 256;
+  double StartTime = FPlatformTime::Seconds();
+
+  int32 PolygonTotal = Polyhedron.Polygons.Num();
+
+  // Project each vertex once, for all the polygons around it, by batches over the worker threads.
+  static constexpr int32 VerticesPerBatch = 4096;
+  static constexpr int32 BatchesBetweenClockChecks = 16;
+  int32 ProjectedVertexTotal = FMath::Max(VertexUVs.Num(), VertexDirections.Num());
+  while (NextProjectedVertexIndex < ProjectedVertexTotal) {
+    int32 SliceOffset = NextProjectedVertexIndex;
+    int32 SliceCount = FMath::Min(VerticesPerBatch * BatchesBetweenClockChecks, ProjectedVertexTotal - SliceOffset);
+    ParallelFor(FMath::DivideAndRoundUp(SliceCount, VerticesPerBatch), [&] (int32 BatchIndex) {
+      int32 BatchOffset = SliceOffset + BatchIndex * VerticesPerBatch;
+      int32 BatchCount = FMath::Min(VerticesPerBatch, SliceOffset + SliceCount - BatchOffset);
+      TArrayView<const FVector> BatchVertices = MakeArrayView(Polyhedron.Vertices).Slice(BatchOffset, BatchCount);
+      if (UVGeneration == EPolyhedronUVGeneration::Spherical) {
+        ProjectOntoSphere(BatchVertices, MakeArrayView(VertexUVs).Slice(BatchOffset, BatchCount));
+      } else {
+        ProjectOntoUnitSphere(BatchVertices, MakeArrayView(VertexDirections).Slice(BatchOffset, BatchCount));
+      }
+    });
+    NextProjectedVertexIndex += SliceCount;
+    if (NextPolygonIndex < PolygonTotal && FPlatformTime::Seconds() - StartTime >= TimeBudgetSeconds) return false;
+  }
+
+  while (NextPolygonIndex < PolygonTotal) {
+    int32 SliceEnd = FMath::Min(NextPolygonIndex + PolygonsBetweenClockChecks, PolygonTotal);
+    for (; NextPolygonIndex < SliceEnd; ++NextPolygonIndex) {
+      const FPolyhedronPolygon& Polygon = Polyhedron.Polygons[NextPolygonIndex];
+      int32 SectionIndex = GetSectionIndex(Polygon, UVGeneration);
+      if (SectionIndex == INDEX_NONE) continue;
+      AppendPolygon(Sections[SectionIndex], Polyhedron, Polygon, UVGeneration, bBuildGeometry, bEncodePolygonIndices ? NextPolygonIndex : INDEX_NONE, VertexUVs, VertexDirections);
+    }
+    if (NextPolygonIndex < PolygonTotal && FPlatformTime::Seconds() - StartTime >= TimeBudgetSeconds) return false;
+  }
+
+  for (const FPolyhedronSection& Section : Sections) {
+    REPORT_ERROR_RETURN_IF(Section.Normals.Num() != Section.Positions.Num(), true, "Broken Algorithm -- Mismatched MeshNormals.Num()");
+    REPORT_ERROR_RETURN_IF(bBuildGeometry && UVGeneration != EPolyhedronUVGeneration::None && Section.UVs.Num() != Section.Positions.Num(), true, "Broken Algorithm -- Mismatched MeshUVs.Num()");
+  }
+  return true;
+}
+
+float FPolyhedronSectionBuilder::GetProgress() const {
+  int32 PolygonTotal = Polyhedron.Polygons.Num();
+  return PolygonTotal > 0 ? static_cast<float>(NextPolygonIndex) / static_cast<float>(PolygonTotal) : 1.0f;
 }
 
 UPolyhedronComponent::UPolyhedronComponent(const FObjectInitializer& ObjectInitializer)
@@ -60,130 +332,226 @@ UPolyhedronComponent::UPolyhedronComponent(const FObjectInitializer& ObjectIniti
 }
 
 void UPolyhedronComponent::SetPolyhedronMesh(const FPolyhedronMesh& Polyhedron, bool bEnableCollision, EPolyhedronUVGeneration UVGeneration) {
-
-  // Count the number of materials.
-  int32 MaterialCount = 0;
-  for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
-    if (Polygon.MaterialIndex >= MaterialCount) {
-      MaterialCount = Polygon.MaterialIndex + 1;
-    }
+  FPolyhedronSectionBuilder SectionBuilder(Polyhedron, UVGeneration, /*bBuildGeometry=*/true, bEncodePolygonIndices);
+  SectionBuilder.Build();
+  SetPolyhedronSections(SectionBuilder.GetSections(), bEnableCollision);
+  if (bEncodePolygonIndices && Polyhedron.Polygons.Num() <= MaxEncodedPolygonCount) {
+    SetPolygonStateCount(Polyhedron.Polygons.Num());
   }
+}
 
+void UPolyhedronComponent::SetPolyhedronSections(const TArray<FPolyhedronSection>& Sections, bool bEnableCollision) {
   // Restart the Procedural Mesh.
   ClearAllMeshSections();
 
   // Build each mesh section according to its material properties.
-  for (int32 MaterialIndex = 0; MaterialIndex < MaterialCount; ++MaterialIndex) {
-
-    // Count the Polygon-Vertex pairs.
-    int32 UniqueVertexTotal = 0;
-    int32 TriangleTotal = 0;
-    for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
-      if (Polygon.MaterialIndex != MaterialIndex) continue;
-      int32 PolygonVertexCount = Polygon.VertexIndices.Num();
-      if (PolygonVertexCount >= 3) {
-        UniqueVertexTotal += PolygonVertexCount;
-        TriangleTotal += PolygonVertexCount - 2; // Fan-triangulation
-      }
+  for (const FPolyhedronSection& Section : Sections) {
+    // Skip material indices without polygons.
+    if (Section.Triangles.Num() == 0) continue;
+
+    CreateMeshSection_LinearColor(Section.MaterialIndex, Section.Positions, Section.Triangles, Section.Normals, Section.UVs, Section.PolygonUVs, Section.SliceUVs, TArray<FVector2D>(), TArray<FLinearColor>(), Section.Tangents, bEnableCollision, /*bSRGBConversion=*/false);
+  }
+}
+
+void UPolyhedronComponent::SetPolyhedronTileSection(int32 SectionIndex, const FPolyhedronSection& Section, bool bEnableCollision) {
+  if (Section.Triangles.Num() == 0) {
+    ClearMeshSection(SectionIndex);
+    return;
+  }
+  CreateMeshSection_LinearColor(SectionIndex, Section.Positions, Section.Triangles, Section.Normals, Section.UVs, Section.PolygonUVs, Section.SliceUVs, TArray<FVector2D>(), TArray<FLinearColor>(), Section.Tangents, bEnableCollision, /*bSRGBConversion=*/false);
+}
+
+void UPolyhedronComponent::RescalePolyhedronMesh(double ScaleFactor) {
+  // Scaling about the origin changes neither the normals nor the texture coordinates.
+  TArray<FVector> MeshPositions;
+  for (int32 SectionIndex = 0; SectionIndex < GetNumSections(); ++SectionIndex) {
+    const FProcMeshSection* Section = GetProcMeshSection(SectionIndex);
+    if (Section == nullptr || Section->ProcVertexBuffer.Num() == 0) continue;
+
+    MeshPositions.Reset(Section->ProcVertexBuffer.Num());
+    for (const FProcMeshVertex& Vertex : Section->ProcVertexBuffer) {
+      MeshPositions.Add(Vertex.Position * ScaleFactor);
     }
+    UpdateMeshSection_LinearColor(SectionIndex, MeshPositions, TArray<FVector>(), TArray<FVector2D>(), TArray<FLinearColor>(), TArray<FProcMeshTangent>(), /*bSRGBConversion=*/false);
+  }
+}
 
-    // Skip material indices without polygons.
-    if (TriangleTotal == 0) continue;
+bool UPolyhedronComponent::UpdatePolyhedronUVs(const FPolyhedronMesh& Polyhedron, EPolyhedronUVGeneration UVGeneration) {
+  FPolyhedronSectionBuilder SectionBuilder(Polyhedron, UVGeneration, /*bBuildGeometry=*/false);
+  SectionBuilder.Build();
 
-    // Allocate the mesh buffers.
-    TArray<FVector> MeshPositions; MeshPositions.Reserve(UniqueVertexTotal);
-    TArray<FVector> MeshNormals; MeshNormals.Reserve(UniqueVertexTotal);
-    TArray<FVector2D> MeshUVs; MeshUVs.Reserve(UniqueVertexTotal);
-    TArray<int32> MeshTriangles; MeshTriangles.Reserve(TriangleTotal * 3);
+  // The sections must still hold the same polygons; otherwise the caller has to rebuild them.
+  TArray<FPolyhedronSection>& Sections = SectionBuilder.GetSections();
+  for (FPolyhedronSection& Section : Sections) {
+    const FProcMeshSection* MeshSection = GetProcMeshSection(Section.MaterialIndex);
+    int32 MeshSectionVertexCount = MeshSection != nullptr ? MeshSection->ProcVertexBuffer.Num() : 0;
+    if (UVGeneration == EPolyhedronUVGeneration::None) {
+      Section.UVs.SetNumZeroed(MeshSectionVertexCount);
+    }
+    if (Section.UVs.Num() != MeshSectionVertexCount) return false;
+  }
 
-    // Iterate over the polygons
-    for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
-      if (Polygon.MaterialIndex != MaterialIndex) continue;
-      int32 PolygonVertexCount = Polygon.VertexIndices.Num();
-      if (PolygonVertexCount < 3) continue;
+  for (const FPolyhedronSection& Section : Sections) {
+    if (Section.UVs.Num() == 0) continue;
+    UpdateMeshSection_LinearColor(Section.MaterialIndex, TArray<FVector>(), TArray<FVector>(), Section.UVs, TArray<FVector2D>(), Section.SliceUVs, TArray<FVector2D>(), TArray<FLinearColor>(), Section.Tangents, /*bSRGBConversion=*/false);
+  }
+  return true;
+}
 
-      // Compute the vertex normal; this assumes planar polygons.
-      FVector PolygonNormal = FPolyhedronTools::GetPolygonNormal(Polyhedron, Polygon);
+bool UPolyhedronComponent::UpdatePolyhedronVertices(const FPolyhedronMesh& Polyhedron, EPolyhedronUVGeneration UVGeneration) {
+  // Find where each polygon starts in its mesh section; the polygons were appended in order by FPolyhedronSectionBuilder.
+  TArray<int32> PolygonVertexOffsets, SectionVertexTotals;
+  PolygonVertexOffsets.SetNumUninitialized(Polyhedron.Polygons.Num());
+  for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.Polygons.Num(); ++PolygonIndex) {
+    const FPolyhedronPolygon& Polygon = Polyhedron.Polygons[PolygonIndex];
+    PolygonVertexOffsets[PolygonIndex] = INDEX_NONE;
+    int32 SectionIndex = FPolyhedronSectionBuilder::GetSectionIndex(Polygon, UVGeneration);
+    if (SectionIndex == INDEX_NONE) continue;
+    if (SectionIndex >= SectionVertexTotals.Num()) {
+      SectionVertexTotals.SetNumZeroed(SectionIndex + 1);
+    }
+    PolygonVertexOffsets[PolygonIndex] = SectionVertexTotals[SectionIndex];
+    SectionVertexTotals[SectionIndex] += Polygon.VertexIndices.Num();
+  }
 
-      // Copy the vertex data into the final mesh arrays.
-      int32 PolygonVertexOffset = MeshPositions.Num();
-      for (const int32& VertexIndex : Polygon.VertexIndices) {
-        MeshPositions.Add(Polyhedron.Vertices[VertexIndex]);
-        MeshNormals.Add(PolygonNormal);
-      }
+  // The mesh sections must still hold the same polygons; otherwise the caller has to rebuild them.
+  TArray<TArray<FVector>> SectionPositions, SectionNormals;
+  TArray<TArray<FProcMeshTangent>> SectionTangents;
+  SectionPositions.SetNum(SectionVertexTotals.Num());
+  SectionNormals.SetNum(SectionVertexTotals.Num());
+  SectionTangents.SetNum(SectionVertexTotals.Num());
+  bool bUpdateTangents = UVGeneration != EPolyhedronUVGeneration::None;
+  for (int32 MaterialIndex = 0; MaterialIndex < SectionVertexTotals.Num(); ++MaterialIndex) {
+    const FProcMeshSection* MeshSection = GetProcMeshSection(MaterialIndex);
+    int32 MeshSectionVertexCount = MeshSection != nullptr ? MeshSection->ProcVertexBuffer.Num() : 0;
+    if (SectionVertexTotals[MaterialIndex] != MeshSectionVertexCount) return false;
+    SectionPositions[MaterialIndex].SetNumUninitialized(MeshSectionVertexCount);
+    SectionNormals[MaterialIndex].SetNumUninitialized(MeshSectionVertexCount);
+    if (bUpdateTangents) {
+      SectionTangents[MaterialIndex].SetNumUninitialized(MeshSectionVertexCount);
+    }
+  }
 
-      // Calculate the offset for each vertex position away from the center's normal.
-      if (UVGeneration == EPolyhedronUVGeneration::Cellular) {
-        // Use the PolygonNormal to generate a 2D basis for the local UV coordinates.
-        FVector UpAxis = FMath::Abs(FVector::ZAxisVector.Dot(PolygonNormal)) > 0.90 ? FVector::XAxisVector : FVector::ZAxisVector;
-        FVector UpwardAxis = (UpAxis - UpAxis.ProjectOnToNormal(PolygonNormal)).GetUnsafeNormal();
-        FVector SidewaysAxis = PolygonNormal.Cross(UpwardAxis).GetUnsafeNormal();
-
-        // Compute the center of the polygon, which will be (0.5, 0.5), and the 2D bounding box of the polygon.
-        // The center of the polygon produces a PlanarOffset of (0, 0).
-        FVector PolygonCenter = FPolyhedronTools::GetPolygonCenter(Polyhedron, Polygon);
-        FBox2D PolygonUVBounds;
-
-        for (const int32& VertexIndex : Polygon.VertexIndices) {
-          FVector CenterOffset = Polyhedron.Vertices[VertexIndex] - PolygonCenter;
-          CenterOffset -= CenterOffset.ProjectOnToNormal(PolygonNormal);
-          FVector2D PlanarOffset(CenterOffset.Dot(SidewaysAxis), CenterOffset.Dot(UpwardAxis));
-          PolygonUVBounds += PlanarOffset;
-          MeshUVs.Add(PlanarOffset); // Record this value, but it is not a texture coordinate.
-        }
+  // Every polygon writes its own range of vertices, so the polygons can be processed in parallel.
+  ParallelFor(Polyhedron.Polygons.Num(), [&] (int32 PolygonIndex) {
+    if (PolygonVertexOffsets[PolygonIndex] == INDEX_NONE) return;
+    const FPolyhedronPolygon& Polygon = Polyhedron.Polygons[PolygonIndex];
+    FVector PolygonNormal = FPolyhedronTools::GetPolygonNormal(Polyhedron, Polygon);
+    int32 SectionIndex = FPolyhedronSectionBuilder::GetSectionIndex(Polygon, UVGeneration);
+    TArray<FVector>& Positions = SectionPositions[SectionIndex];
+    TArray<FVector>& Normals = SectionNormals[SectionIndex];
+    for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < Polygon.VertexIndices.Num(); ++PolygonVertexIndex) {
+      Positions[PolygonVertexOffsets[PolygonIndex] + PolygonVertexIndex] = Polyhedron.Vertices[Polygon.VertexIndices[PolygonVertexIndex]];
+      Normals[PolygonVertexOffsets[PolygonIndex] + PolygonVertexIndex] = PolygonNormal;
+    }
+    if (!bUpdateTangents) return;
+    FProcMeshTangent PolygonTangent = FPolyhedronSectionBuilder::GetPolygonTangent(Polyhedron, Polygon, PolygonNormal, UVGeneration);
+    for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < Polygon.VertexIndices.Num(); ++PolygonVertexIndex) {
+      SectionTangents[SectionIndex][PolygonVertexOffsets[PolygonIndex] + PolygonVertexIndex] = PolygonTangent;
+    }
+  });
 
-        // Rescale the texture coordinates in the [0,1] range, around the center.
-        //--------
-        // Note that the UV Bounds should always include (0, 0), which we want to map to (0.5, 0.5).
-        // Retrieve the largest distance in Min/Max and in U/V.
-        double UVBoundMaxDistance = FMath::Max(-PolygonUVBounds.Min.GetMin(), PolygonUVBounds.Max.GetMax());
-        float PolygonUVScaleFactor = 0.5 / UVBoundMaxDistance;
-        for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < Polygon.VertexIndices.Num(); ++PolygonVertexIndex) {
-          FVector2D& MeshUV = MeshUVs[PolygonVertexOffset + PolygonVertexIndex];
-          MeshUV = FVector2D(0.5, 0.5) + PolygonUVScaleFactor * MeshUV;
-        }
-      } else if (UVGeneration == EPolyhedronUVGeneration::Spherical) {
-        // To fix the wrapping problem, pin on the first vertex of the polygon.
-        FVector SphereProjectedPin = ConvertToSphericalCoordinates(Polyhedron.Vertices[Polygon.VertexIndices[0]]);
-        double PinU = SphereProjectedPin.Y, PinV = SphereProjectedPin.Z;
-        MeshUVs.Add(FVector2D(PinU, PinV));
-
-        for (int32 PolygonVertexIndex = 1; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
-          // Project each coordinate into spherical coordinates.
-          int32 VertexIndex = Polygon.VertexIndices[PolygonVertexIndex];
-          FVector SphereProjectedVertex = ConvertToSphericalCoordinates(Polyhedron.Vertices[VertexIndex]);
-          double U = SphereProjectedVertex.Y;
-          if (U - PinU < -0.5) U += 1.0;
-          else if (U - PinU > 0.5) U -= 1.0;
-          double V = SphereProjectedVertex.Z;
-          if (V - PinV < -0.5) V += 1.0;
-          else if (V - PinV > 0.5) V -= 1.0;
-
-          MeshUVs.Add(FVector2D(U, V));
-        }
-      } else if (UVGeneration == EPolyhedronUVGeneration::Cubic) {
-        // Select the Face of the cube based on the Normal.
-        EPolyhedronCubicFace Pin = ChooseFaceForCubicProjection(PolygonNormal);
-        for (int32 VertexIndex : Polygon.VertexIndices) {
-          // Project each coordinate unto the cube.
-          FVector2D UV = ProjectOntoCube(Polyhedron.Vertices[VertexIndex].GetSafeNormal(), Pin);
-          MeshUVs.Add((UV + FVector2D(1.0, 1.0)) / FVector2D(2.0, 2.0));
-        }
-      }
+  for (int32 MaterialIndex = 0; MaterialIndex < SectionVertexTotals.Num(); ++MaterialIndex) {
+    if (SectionVertexTotals[MaterialIndex] == 0) continue;
+    UpdateMeshSection_LinearColor(MaterialIndex, SectionPositions[MaterialIndex], SectionNormals[MaterialIndex], TArray<FVector2D>(), TArray<FLinearColor>(), SectionTangents[MaterialIndex], /*bSRGBConversion=*/false);
+  }
+  return true;
+}
 
-      // Fan-triangulate the polygon into the mesh arrays.
-      for (int32 PolygonVertexIndex = 2; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
-        MeshTriangles.Add(PolygonVertexOffset);
-        MeshTriangles.Add(PolygonVertexOffset + PolygonVertexIndex - 1);
-        MeshTriangles.Add(PolygonVertexOffset + PolygonVertexIndex);
-      }
+void UPolyhedronComponent::SetPolyhedronTerrain(FPolyhedronTerrain& Terrain, bool bEnableCollision, TArrayView<UMaterialInterface* const> Materials) {
+  Terrain.Update();
+  ClearAllMeshSections();
+  // The chunks are mesh sections, not materials: each slot gets the material of its chunk.
+  UMaterialInterface* FirstMaterial = GetMaterial(0);
+  for (int32 ChunkIndex = 0; ChunkIndex < Terrain.GetChunkCount(); ++ChunkIndex) {
+    const FPolyhedronSection& Section = Terrain.GetChunkSection(ChunkIndex);
+    SetPolyhedronTileSection(ChunkIndex, Section, bEnableCollision);
+    SetMaterial(ChunkIndex, Materials.IsValidIndex(Section.MaterialIndex) ? Materials[Section.MaterialIndex] : FirstMaterial);
+  }
+}
+
+void UPolyhedronComponent::UpdatePolyhedronTerrain(FPolyhedronTerrain& Terrain) {
+  // The chunks keep their triangles and texture coordinates, only their vertices move.
+  for (int32 ChunkIndex : Terrain.Update()) {
+    const FPolyhedronSection& Section = Terrain.GetChunkSection(ChunkIndex);
+    UpdateMeshSection_LinearColor(ChunkIndex, Section.Positions, Section.Normals, TArray<FVector2D>(), TArray<FLinearColor>(), TArray<FProcMeshTangent>(), /*bSRGBConversion=*/false);
+  }
+}
+
+void UPolyhedronComponent::SetPolygonStateCount(int32 PolygonCount) {
+  if (PolygonCount == PolygonStates.Num()) return;
+  int32 FirstNewRow = FMath::Min(PolygonCount, PolygonStates.Num()) / PolygonStateTextureWidth;
+  PolygonStates.SetNumZeroed(PolygonCount);
+  DirtyPolygonStateRowBegin = FMath::Min(DirtyPolygonStateRowBegin, FirstNewRow);
+  DirtyPolygonStateRowEnd = FMath::DivideAndRoundUp(PolygonCount, PolygonStateTextureWidth);
+}
+
+void UPolyhedronComponent::SetPolygonState(int32 PolygonIndex, FColor State) {
+  REPORT_ERROR_IF(!PolygonStates.IsValidIndex(PolygonIndex), "Cannot set the state of polygon %d out of %d", PolygonIndex, PolygonStates.Num());
+  PolygonStates[PolygonIndex] = State;
+  int32 Row = PolygonIndex / PolygonStateTextureWidth;
+  DirtyPolygonStateRowBegin = FMath::Min(DirtyPolygonStateRowBegin, Row);
+  DirtyPolygonStateRowEnd = FMath::Max(DirtyPolygonStateRowEnd, Row + 1);
+}
+
+void UPolyhedronComponent::SetPolygonStates(TArrayView<const FColor> States) {
+  SetPolygonStateCount(States.Num());
+  FMemory::Memcpy(PolygonStates.GetData(), States.GetData(), States.Num() * sizeof(FColor));
+  DirtyPolygonStateRowBegin = 0;
+  DirtyPolygonStateRowEnd = FMath::DivideAndRoundUp(States.Num(), PolygonStateTextureWidth);
+}
+
+UTexture2D* UPolyhedronComponent::UpdatePolygonStateTexture() {
+  // FColor matches the texel layout of PF_B8G8R8A8.
+  int32 RowCount = FMath::Max(1, FMath::DivideAndRoundUp(PolygonStates.Num(), PolygonStateTextureWidth));
+  if (PolygonStateTexture == nullptr || PolygonStateTexture->GetSizeY() != RowCount) {
+    PolygonStateTexture = UTexture2D::CreateTransient(PolygonStateTextureWidth, RowCount, PF_B8G8R8A8);
+    REPORT_ERROR_RETURN_IF(PolygonStateTexture == nullptr, nullptr, "Cannot create a %dx%d polygon state texture", PolygonStateTextureWidth, RowCount);
+    PolygonStateTexture->Filter = TF_Nearest;
+    PolygonStateTexture->AddressX = TA_Clamp;
+    PolygonStateTexture->AddressY = TA_Clamp;
+    PolygonStateTexture->SRGB = false;
+    PolygonStateTexture->UpdateResource();
+    DirtyPolygonStateRowBegin = 0;
+    DirtyPolygonStateRowEnd = RowCount;
+    if (!PolygonStateParameterName.IsNone()) {
+      BindPolygonStateTexture(PolygonStateParameterName);
     }
+  }
+  DirtyPolygonStateRowEnd = FMath::Min(DirtyPolygonStateRowEnd, RowCount);
+  if (DirtyPolygonStateRowBegin >= DirtyPolygonStateRowEnd) return PolygonStateTexture;
+
+  // The render thread uploads the rows later, from a copy that it frees; the last row is padded with zeros.
+  int32 DirtyRowCount = DirtyPolygonStateRowEnd - DirtyPolygonStateRowBegin;
+  int32 FirstPolygonIndex = DirtyPolygonStateRowBegin * PolygonStateTextureWidth;
+  int32 CopiedStateCount = FMath::Min(DirtyRowCount * PolygonStateTextureWidth, PolygonStates.Num() - FirstPolygonIndex);
+  FColor* Texels = new FColor[DirtyRowCount * PolygonStateTextureWidth];
+  FMemory::Memzero(Texels, DirtyRowCount * PolygonStateTextureWidth * sizeof(FColor));
+  if (CopiedStateCount > 0) {
+    FMemory::Memcpy(Texels, PolygonStates.GetData() + FirstPolygonIndex, CopiedStateCount * sizeof(FColor));
+  }
+  FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, DirtyPolygonStateRowBegin, 0, 0, PolygonStateTextureWidth, DirtyRowCount);
+  PolygonStateTexture->UpdateTextureRegions(0, 1, Region, PolygonStateTextureWidth * sizeof(FColor), sizeof(FColor), reinterpret_cast<uint8*>(Texels), [] (uint8* SrcData, const FUpdateTextureRegion2D* Regions) {
+    delete[] reinterpret_cast<FColor*>(SrcData);
+    delete Regions;
+  });
 
-    REPORT_ERROR_IF(MeshPositions.Num() != UniqueVertexTotal, "Broken Algorithm -- Mismatched MeshPositions.Num()");
-    REPORT_ERROR_IF(MeshNormals.Num() != UniqueVertexTotal, "Broken Algorithm -- Mismatched MeshNormals.Num()");
-    REPORT_ERROR_IF(MeshUVs.Num() != UniqueVertexTotal, "Broken Algorithm -- Mismatched MeshUVs.Num()");
-    REPORT_ERROR_IF(MeshTriangles.Num() != 3 * TriangleTotal, "Broken Algorithm -- Mismatched MeshTriangles.Num()");
+  DirtyPolygonStateRowBegin = MAX_int32;
+  DirtyPolygonStateRowEnd = 0;
+  return PolygonStateTexture;
+}
 
-    CreateMeshSection_LinearColor(MaterialIndex, MeshPositions, MeshTriangles, MeshNormals, MeshUVs, TArray<FLinearColor>(), TArray<FProcMeshTangent>(), bEnableCollision, /*bSRGBConversion=*/false);
+void UPolyhedronComponent::BindPolygonStateTexture(FName ParameterName) {
+  PolygonStateParameterName = ParameterName;
+  if (PolygonStateTexture == nullptr) {
+    UpdatePolygonStateTexture(); // Binds the new texture.
+    return;
+  }
+  for (int32 ElementIndex = 0; ElementIndex < GetNumMaterials(); ++ElementIndex) {
+    if (GetMaterial(ElementIndex) == nullptr) continue;
+    UMaterialInstanceDynamic* MaterialInstance = CreateDynamicMaterialInstance(ElementIndex);
+    if (MaterialInstance != nullptr) {
+      MaterialInstance->SetTextureParameterValue(ParameterName, PolygonStateTexture);
+    }
   }
 }
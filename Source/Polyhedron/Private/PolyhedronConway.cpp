@@ -7,6 +7,29 @@
 #include "Helpers.h"
 #include "Polyhedron.h"
 #include "PolyhedronComponent.h"
+#include "PolyhedronGenerationJob.h"
+#include "PolyhedronGenerationSubsystem.h"
+#include "PolyhedronStreaming.h"
+#include "PolyhedronSymmetry.h"
+#include "PolyhedronTools.h"
+#include "Async/Async.h"
+#if WITH_EDITOR
+#include "HAL/IConsoleManager.h"
+
+namespace {
+  TAutoConsoleVariable<int32> CVarPolyhedronEditorPreviewPolygonBudget(
+    TEXT("Polyhedron.Editor.PreviewPolygonBudget"),
+    2000,
+    TEXT("While editing a PolyhedronConway, operations are previewed synchronously until the preview exceeds this many polygons."),
+    ECVF_Default);
+
+  TAutoConsoleVariable<float> CVarPolyhedronEditorRefinementDelay(
+    TEXT("Polyhedron.Editor.RefinementDelay"),
+    0.3f,
+    TEXT("Seconds without edits before a PolyhedronConway preview is refined to the full notation, in the background."),
+    ECVF_Default);
+}
+#endif
 
 APolyhedronConway::APolyhedronConway()
   : AActor() {
@@ -19,15 +42,55 @@ APolyhedronConway::APolyhedronConway()
 
 void APolyhedronConway::BeginPlay() {
   Super::BeginPlay();
+
+  // Hand the deferred polyhedra over to the world's generation queue.
+  // Any mesh sections saved or duplicated from the editor are dropped until then.
+  if (IsGenerationDeferred() && !bPolyhedronGenerated) {
+    ReleasePolyhedron();
+    UPolyhedronGenerationSubsystem* GenerationSubsystem = GetWorld()->GetSubsystem<UPolyhedronGenerationSubsystem>();
+    REPORT_ERROR_IF(GenerationSubsystem == nullptr, "Missing PolyhedronGenerationSubsystem");
+    GenerationSubsystem->RegisterPolyhedron(this);
+  }
+
+  // The streamed polyhedra follow the viewers of game worlds.
+  if (bStreamSurface && GetWorld()->IsGameWorld()) {
+    UPolyhedronGenerationSubsystem* GenerationSubsystem = GetWorld()->GetSubsystem<UPolyhedronGenerationSubsystem>();
+    REPORT_ERROR_IF(GenerationSubsystem == nullptr, "Missing PolyhedronGenerationSubsystem");
+    GenerationSubsystem->RegisterStreamingPolyhedron(this);
+  }
+}
+
+void APolyhedronConway::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+  if (UWorld* World = GetWorld()) {
+    if (UPolyhedronGenerationSubsystem* GenerationSubsystem = World->GetSubsystem<UPolyhedronGenerationSubsystem>()) {
+      GenerationSubsystem->UnregisterPolyhedron(this);
+      GenerationSubsystem->UnregisterStreamingPolyhedron(this);
+    }
+  }
+  StopStreaming();
+
+  Super::EndPlay(EndPlayReason);
 }
 
 void APolyhedronConway::PostLoad() {
   Super::PostLoad();
 
-  GeneratePolyhedron();
+  // Deferred polyhedra are generated once their world is known, see PostRegisterAllComponents().
+  if (!bDeferGeneration) {
+    GeneratePolyhedron();
+  }
   AttachMaterial();
 }
 
+void APolyhedronConway::PostRegisterAllComponents() {
+  Super::PostRegisterAllComponents();
+
+  // Outside of game worlds, there is no viewer to wait for.
+  if (bDeferGeneration && !bPolyhedronGenerated && !IsGenerationDeferred()) {
+    GeneratePolyhedron();
+  }
+}
+
 #if WITH_EDITOR
 void APolyhedronConway::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) {
   Super::PostEditChangeProperty(PropertyChangedEvent);
@@ -43,27 +106,397 @@ void APolyhedronConway::PostEditChangeProperty(FPropertyChangedEvent& PropertyCh
     return;
   }
   if (Property->HasMetaData("Recreate")) {
-    GeneratePolyhedron();
+    UpdatePolyhedron(EPolyhedronDirtyFlags::Topology);
+  } else if (Property->HasMetaData("Rescale")) {
+    UpdatePolyhedron(EPolyhedronDirtyFlags::Scale);
+  } else if (Property->HasMetaData("Reshape")) {
+    UpdatePolyhedron(EPolyhedronDirtyFlags::Parameters);
+  } else if (Property->HasMetaData("RegenerateUVs")) {
+    UpdatePolyhedron(EPolyhedronDirtyFlags::UVs);
   } else if (Property->HasMetaData("AttachMaterial")) {
-    AttachMaterial();
+    UpdatePolyhedron(EPolyhedronDirtyFlags::Material);
+  }
+}
+
+void APolyhedronConway::GeneratePreviewPolyhedron() {
+  REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
+
+  // Any work in flight is now obsolete.
+  CancelRefinement();
+  StopStreaming();
+  int32 PreviewEditSerial = ++EditSerial;
+
+  // Show the size of the full notation right away, zero when it cannot be predicted, and keep the current mesh when the
+  // notation is invalid or too large to generate.
+  TArray<FPolyhedronNotationStep> Steps;
+  bool bParsed = FPolyhedronTools::ParseConwayPolyhedronNotation(GetGenerationNotation(), Steps);
+  FPolyhedronMeshSize PredictedSize;
+  bool bPredicted = bParsed && FPolyhedronTools::PredictConwayPolyhedronNotation(Steps, PredictedSize);
+  if (!bPredicted) PredictedSize = FPolyhedronMeshSize();
+  PredictedVertexCount = PredictedSize.VertexCount;
+  PredictedPolygonCount = PredictedSize.PolygonCount;
+  PredictedMemoryMB = static_cast<float>(static_cast<double>(PredictedSize.PeakMemorySize) / (1024.0 * 1024.0));
+  if (!bParsed || (bPredicted && !FPolyhedronTools::CheckMemoryBudget(PredictedSize))) return;
+
+  // Apply the seed and the first operations, until the preview grows past its budget.
+  int32 PreviewPolygonBudget = CVarPolyhedronEditorPreviewPolygonBudget.GetValueOnGameThread();
+  FPolyhedronMesh Preview;
+  int32 StepIndex = 0;
+  for (; StepIndex < Steps.Num(); ++StepIndex) {
+    if (StepIndex > 0 && Preview.Polygons.Num() > PreviewPolygonBudget) break;
+    Preview = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Steps[StepIndex], Preview, OperationParameters);
+  }
+
+  Polyhedron = FPolyhedronTools::ScaleToSphere(Preview, Scale);
+  PolyhedronComponent->SetPolyhedronMesh(Polyhedron, bEnableCollision, UVGeneration);
+  ParametricMesh.Reset();
+  VertexCount = Polyhedron.Vertices.Num();
+  PolygonCount = Polyhedron.Polygons.Num();
+  GeneratedScale = Scale;
+  GeneratedUVGeneration = UVGeneration;
+  bPolyhedronGenerated = true;
+
+  // The preview may already be the whole polyhedron.
+  if (StepIndex >= Steps.Num()) return;
+
+  // Wait for the edits to settle down before refining; every newer edit restarts the delay.
+  float RefinementDelay = FMath::Max(0.0f, CVarPolyhedronEditorRefinementDelay.GetValueOnGameThread());
+  RefinementTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this, PreviewEditSerial] (float) {
+    RefinementTickerHandle.Reset();
+    StartRefinementJob(PreviewEditSerial);
+    return false; // One-shot.
+  }), RefinementDelay);
+}
+
+void APolyhedronConway::StartRefinementJob(int32 RefinementEditSerial) {
+  if (RefinementEditSerial != EditSerial) return;
+
+  RefinementJob = MakeShared<FPolyhedronGenerationJob, ESPMode::ThreadSafe>(GetGenerationNotation(), Scale, UVGeneration, OperationParameters, PolyhedronComponent->bEncodePolygonIndices);
+  TSharedPtr<FPolyhedronGenerationJob, ESPMode::ThreadSafe> Job = RefinementJob;
+  TWeakObjectPtr<APolyhedronConway> WeakThis(this);
+
+  Async(EAsyncExecution::ThreadPool, [Job, WeakThis, RefinementEditSerial] () {
+    Job->Run();
+
+    // Only the game thread may touch the component; drop the result if a newer edit made it obsolete.
+    AsyncTask(ENamedThreads::GameThread, [Job, WeakThis, RefinementEditSerial] () {
+      APolyhedronConway* This = WeakThis.Get();
+      if (This == nullptr || This->EditSerial != RefinementEditSerial || This->RefinementJob != Job) return;
+      This->RefinementJob.Reset();
+      if (Job->GetState() == EPolyhedronGenerationJobState::Completed) {
+        This->ApplyGenerationJob(*Job);
+      }
+    });
+  });
+}
+
+void APolyhedronConway::CancelRefinement() {
+  if (RefinementTickerHandle.IsValid()) {
+    FTSTicker::GetCoreTicker().RemoveTicker(RefinementTickerHandle);
+    RefinementTickerHandle.Reset();
+  }
+  if (RefinementJob.IsValid()) {
+    RefinementJob->Cancel();
+    RefinementJob.Reset();
   }
 }
 #endif
 
+void APolyhedronConway::SetConwayPolyhedronNotation(const FString& InConwayPolyhedronNotation) {
+  if (ConwayPolyhedronNotation == InConwayPolyhedronNotation) return;
+  ConwayPolyhedronNotation = InConwayPolyhedronNotation;
+  UpdatePolyhedron(EPolyhedronDirtyFlags::Topology);
+}
+
+void APolyhedronConway::SetScale(float InScale) {
+  if (Scale == InScale) return;
+  Scale = InScale;
+  UpdatePolyhedron(EPolyhedronDirtyFlags::Scale);
+}
+
+void APolyhedronConway::SetMaterial(UMaterialInterface* InMaterial) {
+  if (Material == InMaterial) return;
+  Material = InMaterial;
+  UpdatePolyhedron(EPolyhedronDirtyFlags::Material);
+}
+
+void APolyhedronConway::SetUVGeneration(EPolyhedronUVGeneration InUVGeneration) {
+  if (UVGeneration == InUVGeneration) return;
+  UVGeneration = InUVGeneration;
+  UpdatePolyhedron(EPolyhedronDirtyFlags::UVs);
+}
+
+void APolyhedronConway::SetOperationParameters(const FPolyhedronOperationParameters& InOperationParameters) {
+  if (OperationParameters == InOperationParameters) return;
+  OperationParameters = InOperationParameters;
+  UpdatePolyhedron(EPolyhedronDirtyFlags::Parameters);
+}
+
+void APolyhedronConway::UpdatePolyhedron(EPolyhedronDirtyFlags DirtyFlags) {
+  if (EnumHasAnyFlags(DirtyFlags, EPolyhedronDirtyFlags::Material)) {
+    AttachMaterial();
+  }
+
+  // The tiles of a streamed polyhedron all share the values they were generated with: start over.
+  if (bStreamSurface) {
+    if (EnumHasAnyFlags(DirtyFlags, ~EPolyhedronDirtyFlags::Material)) {
+      GeneratePolyhedron();
+    }
+    return;
+  }
+
+  // A deferred polyhedron is not generated yet; its generation job picks up the new values, see ApplyGenerationJob().
+  if (!bPolyhedronGenerated) {
+    if (EnumHasAnyFlags(DirtyFlags, EPolyhedronDirtyFlags::Topology) && !IsGenerationDeferred()) {
+      GeneratePolyhedron();
+    }
+    return;
+  }
+
+#if WITH_EDITOR
+  // The refinement in flight was started with the previous values; restart it, along with its preview.
+  bool bRefreshPreview = EnumHasAnyFlags(DirtyFlags, EPolyhedronDirtyFlags::Topology) || (IsRefinementPending() && EnumHasAnyFlags(DirtyFlags, EPolyhedronDirtyFlags::Scale | EPolyhedronDirtyFlags::UVs | EPolyhedronDirtyFlags::Parameters));
+  if (bRefreshPreview && GetWorld() != nullptr && !GetWorld()->IsGameWorld()) {
+    GeneratePreviewPolyhedron();
+    return;
+  }
+#endif
+  if (EnumHasAnyFlags(DirtyFlags, EPolyhedronDirtyFlags::Topology)) {
+    GeneratePolyhedron();
+    return;
+  }
+  if (EnumHasAnyFlags(DirtyFlags, EPolyhedronDirtyFlags::Parameters)) {
+    ReshapePolyhedron(); // Also applies the new Scale.
+  }
+  if (EnumHasAnyFlags(DirtyFlags, EPolyhedronDirtyFlags::Scale)) {
+    RescalePolyhedron();
+  }
+  if (EnumHasAnyFlags(DirtyFlags, EPolyhedronDirtyFlags::UVs)) {
+    RegeneratePolyhedronUVs();
+  }
+}
+
 void APolyhedronConway::GeneratePolyhedron() {
   REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
   REPORT_ERROR_IF(ConwayPolyhedronNotation.Len() < 1, "Empty ConwayPolyhedronNotation makes no Polyhedron");
+#if WITH_EDITOR
+  CancelRefinement();
+#endif
+  if (bStreamSurface) {
+    StartStreaming();
+    return;
+  }
+  StopStreaming();
 
   FPolyhedronTools PolyhedronTools;
-  Polyhedron = PolyhedronTools.GenerateFromConwayPolyhedronNotation(ConwayPolyhedronNotation, Scale);
+  if (bUseSymmetry) {
+    Polyhedron = FPolyhedronSymmetry::GenerateFromConwayPolyhedronNotation(GetGenerationNotation(), Scale, OperationParameters);
+  } else {
+    Polyhedron = PolyhedronTools.GenerateFromConwayPolyhedronNotation(GetGenerationNotation(), Scale, OperationParameters);
+  }
+  ParametricMesh.Reset();
   PolyhedronComponent->SetPolyhedronMesh(Polyhedron, bEnableCollision, UVGeneration);
 
   // Record the statistics values exposed to Blueprint and the user.
   VertexCount = Polyhedron.Vertices.Num();
   PolygonCount = Polyhedron.Polygons.Num();
+  GeneratedScale = Scale;
+  GeneratedUVGeneration = UVGeneration;
+  bPolyhedronGenerated = true;
+}
+
+void APolyhedronConway::RescalePolyhedron() {
+  REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
+  if (GeneratedScale == Scale) return;
+
+  // A zero scale loses the shape of the polyhedron; only the Conway operations can bring it back.
+  if (FMath::IsNearlyZero(GeneratedScale)) {
+    GeneratePolyhedron();
+    return;
+  }
+
+  // The polyhedron is centered on the origin, so a uniform scale keeps its normals and its texture coordinates.
+  double ScaleFactor = static_cast<double>(Scale) / static_cast<double>(GeneratedScale);
+  for (FVector& Vertex : Polyhedron.Vertices) {
+    Vertex *= ScaleFactor;
+  }
+  PolyhedronComponent->RescalePolyhedronMesh(ScaleFactor);
+  GeneratedScale = Scale;
+}
+
+void APolyhedronConway::ReshapePolyhedron() {
+  REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
+
+  // Record the topology of the notation once; every later call only replays the vertex recipes.
+  // The first call rebuilds the mesh sections, since the current ones may come from a preview.
+  bool bTopologyChanged = false;
+  if (!ParametricMesh.IsValid() || ParametricMesh->GetConwayPolyhedronNotation() != GetGenerationNotation()) {
+    ParametricMesh = MakeUnique<FPolyhedronParametricMesh>();
+    if (!ParametricMesh->Build(GetGenerationNotation(), Scale, OperationParameters)) {
+      // A canonicalized notation has no recipes to replay; generate it again.
+      ParametricMesh.Reset();
+      GeneratePolyhedron();
+      return;
+    }
+    bTopologyChanged = true;
+  }
+  ParametricMesh->Evaluate(OperationParameters, Scale, bSinglePrecisionReshape);
+  GeneratedScale = Scale;
+
+  if (bTopologyChanged) {
+    Polyhedron = ParametricMesh->GetPolyhedron();
+  } else {
+    Polyhedron.Vertices = ParametricMesh->GetPolyhedron().Vertices;
+  }
+  if (bTopologyChanged || !PolyhedronComponent->UpdatePolyhedronVertices(Polyhedron, GeneratedUVGeneration)) {
+    PolyhedronComponent->SetPolyhedronMesh(Polyhedron, bEnableCollision, UVGeneration);
+    GeneratedUVGeneration = UVGeneration;
+  }
+  VertexCount = Polyhedron.Vertices.Num();
+  PolygonCount = Polyhedron.Polygons.Num();
+}
+
+void APolyhedronConway::RegeneratePolyhedronUVs() {
+  REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
+  if (GeneratedUVGeneration == UVGeneration) return;
+
+  if (!PolyhedronComponent->UpdatePolyhedronUVs(Polyhedron, UVGeneration)) {
+    PolyhedronComponent->SetPolyhedronMesh(Polyhedron, bEnableCollision, UVGeneration);
+  }
+  GeneratedUVGeneration = UVGeneration;
+}
+
+FString APolyhedronConway::GetGenerationNotation() const {
+  // The notation is processed from back to front, so a leading K canonicalizes last.
+  return bCanonicalize ? TEXT("K") + ConwayPolyhedronNotation : ConwayPolyhedronNotation;
+}
+
+bool APolyhedronConway::IsGenerationDeferred() const {
+  // A streamed polyhedron always shows its base level; its tiles are refined on demand instead.
+  UWorld* World = GetWorld();
+  return bDeferGeneration && !bStreamSurface && World != nullptr && World->IsGameWorld();
+}
+
+TUniquePtr<FPolyhedronGenerationJob> APolyhedronConway::CreateGenerationJob() const {
+  bool bEncodePolygonIndices = PolyhedronComponent != nullptr && PolyhedronComponent->bEncodePolygonIndices;
+  return MakeUnique<FPolyhedronGenerationJob>(GetGenerationNotation(), Scale, UVGeneration, OperationParameters, bEncodePolygonIndices);
+}
+
+void APolyhedronConway::ApplyGenerationJob(FPolyhedronGenerationJob& Job) {
+  REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
+  REPORT_ERROR_IF(Job.GetState() != EPolyhedronGenerationJobState::Completed, "Incomplete PolyhedronGenerationJob");
+
+  // The notation changed while the job was running: a deferred polyhedron waits for a new job.
+  if (Job.GetConwayPolyhedronNotation() != GetGenerationNotation() && IsGenerationDeferred()) return;
+
+  PolyhedronComponent->SetPolyhedronSections(Job.GetSections(), bEnableCollision);
+  Polyhedron = MoveTemp(Job.GetPolyhedron());
+  if (PolyhedronComponent->bEncodePolygonIndices && Polyhedron.Polygons.Num() <= UPolyhedronComponent::MaxEncodedPolygonCount) {
+    PolyhedronComponent->SetPolygonStateCount(Polyhedron.Polygons.Num());
+  }
+  AttachMaterial();
+
+  // Record the statistics values exposed to Blueprint and the user.
+  VertexCount = Polyhedron.Vertices.Num();
+  PolygonCount = Polyhedron.Polygons.Num();
+  GeneratedScale = Job.GetScale();
+  GeneratedUVGeneration = Job.GetUVGeneration();
+  bPolyhedronGenerated = true;
+
+  // Catch up with the changes made while the job was running.
+  if (Job.GetConwayPolyhedronNotation() != GetGenerationNotation()) {
+    UpdatePolyhedron(EPolyhedronDirtyFlags::Topology);
+  } else {
+    EPolyhedronDirtyFlags DirtyFlags = EPolyhedronDirtyFlags::Scale | EPolyhedronDirtyFlags::UVs;
+    if (Job.GetOperationParameters() != OperationParameters) {
+      DirtyFlags |= EPolyhedronDirtyFlags::Parameters;
+    }
+    UpdatePolyhedron(DirtyFlags);
+  }
+}
+
+void APolyhedronConway::ReleasePolyhedron() {
+  REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
+
+  StopStreaming();
+  PolyhedronComponent->ClearAllMeshSections();
+  Polyhedron = FPolyhedronMesh();
+  ParametricMesh.Reset();
+  VertexCount = 0;
+  PolygonCount = 0;
+  GeneratedScale = 0.0;
+  GeneratedUVGeneration = EPolyhedronUVGeneration::None;
+  bPolyhedronGenerated = false;
 }
 
 void APolyhedronConway::AttachMaterial() {
   REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
   PolyhedronComponent->SetMaterial(0, Material);
+
+  // Each tile of a streamed polyhedron has its own mesh section.
+  if (Streamer.IsValid()) {
+    for (int32 TileIndex = 1; TileIndex < Streamer->GetTileCount(); ++TileIndex) {
+      PolyhedronComponent->SetMaterial(TileIndex, Material);
+    }
+  }
+}
+
+void APolyhedronConway::StartStreaming() {
+  REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
+  StopStreaming();
+  int32 StartStreamingSerial = StreamingSerial;
+
+  // The base level and the calibration of the depths take a while: build the streamer on a worker thread.
+  TWeakObjectPtr<APolyhedronConway> WeakThis(this);
+  Async(EAsyncExecution::ThreadPool, [WeakThis, StartStreamingSerial, Notation = GetGenerationNotation(), Scale = Scale, UVGeneration = UVGeneration, OperationParameters = OperationParameters, StreamingTileCount = StreamingTileCount] () {
+    TSharedPtr<FPolyhedronStreamer, ESPMode::ThreadSafe> NewStreamer = MakeShared<FPolyhedronStreamer, ESPMode::ThreadSafe>(Notation, Scale, UVGeneration, OperationParameters, StreamingTileCount);
+
+    // Only the game thread may touch the component; drop the streamer if a newer generation made it obsolete.
+    AsyncTask(ENamedThreads::GameThread, [WeakThis, StartStreamingSerial, NewStreamer, Scale, UVGeneration] () {
+      APolyhedronConway* This = WeakThis.Get();
+      if (This == nullptr || This->StreamingSerial != StartStreamingSerial || !This->bStreamSurface || !NewStreamer->IsValid()) return;
+
+      This->Streamer = NewStreamer;
+      This->PolyhedronComponent->ClearAllMeshSections();
+      for (int32 TileIndex = 0; TileIndex < NewStreamer->GetTileCount(); ++TileIndex) {
+        This->PolyhedronComponent->SetPolyhedronTileSection(TileIndex, NewStreamer->GetResidentTile(TileIndex).Section, This->bEnableCollision);
+      }
+      This->AttachMaterial();
+
+      // The base level stands for the whole polyhedron.
+      This->Polyhedron = NewStreamer->GetBasePolyhedron();
+      This->ParametricMesh.Reset();
+      This->VertexCount = This->Polyhedron.Vertices.Num();
+      This->PolygonCount = This->Polyhedron.Polygons.Num();
+      This->GeneratedScale = Scale;
+      This->GeneratedUVGeneration = UVGeneration;
+      This->bPolyhedronGenerated = true;
+    });
+  });
+}
+
+void APolyhedronConway::StopStreaming() {
+  // Any streamer still being built is dropped once done.
+  ++StreamingSerial;
+  Streamer.Reset();
+}
+
+void APolyhedronConway::UpdateStreaming(TArrayView<const FVector> WorldViewLocations) {
+  REPORT_ERROR_IF(PolyhedronComponent == nullptr, "Missing PolyhedronComponent");
+  if (!Streamer.IsValid()) return;
+
+  // The streamer works in the space of the polyhedron, where the distances shrink with the scale of the actor.
+  const FTransform& ComponentTransform = PolyhedronComponent->GetComponentTransform();
+  TArray<FVector> ViewLocations;
+  ViewLocations.Reserve(WorldViewLocations.Num());
+  for (const FVector& WorldViewLocation : WorldViewLocations) {
+    ViewLocations.Add(ComponentTransform.InverseTransformPosition(WorldViewLocation));
+  }
+  FPolyhedronStreamer::FSettings Settings;
+  Settings.DetailDistance = StreamingDetailDistance / FMath::Max(ComponentTransform.GetMaximumAxisScale(), UE_KINDA_SMALL_NUMBER);
+  Settings.MemoryBudgetBytes = static_cast<int64>(StreamingMemoryBudgetMB) << 20;
+
+  for (int32 TileIndex : Streamer->Update(ViewLocations, Settings)) {
+    PolyhedronComponent->SetPolyhedronTileSection(TileIndex, Streamer->GetResidentTile(TileIndex).Section, bEnableCollision);
+  }
 }
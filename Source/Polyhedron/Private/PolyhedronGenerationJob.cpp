@@ -0,0 +1,72 @@
+// Copyright 2024 TabbyCoder
+
+#include "PolyhedronGenerationJob.h"
+#include "Helpers.h"
+
+FPolyhedronGenerationJob::FPolyhedronGenerationJob(const FString& InConwayPolyhedronNotation, float InScale, EPolyhedronUVGeneration InUVGeneration, const FPolyhedronOperationParameters& InOperationParameters, bool bInEncodePolygonIndices)
+  : ConwayPolyhedronNotation(InConwayPolyhedronNotation)
+  , Scale(InScale)
+  , UVGeneration(InUVGeneration)
+  , OperationParameters(InOperationParameters)
+  , bEncodePolygonIndices(bInEncodePolygonIndices) {}
+
+bool FPolyhedronGenerationJob::Run(double TimeBudgetSeconds) {
+  if (IsFinished()) return true;
+  double StartTime = FPlatformTime::Seconds();
+  auto IsOverBudget = [&] () { return FPlatformTime::Seconds() - StartTime >= TimeBudgetSeconds; };
+
+  // Parse the notation on the first slice, and refuse the ones too large to generate.
+  if (NextStepIndex == INDEX_NONE) {
+    FPolyhedronMeshSize PredictedSize;
+    if (!FPolyhedronTools::ParseConwayPolyhedronNotation(ConwayPolyhedronNotation, Steps) || (FPolyhedronTools::PredictConwayPolyhedronNotation(Steps, PredictedSize) && !FPolyhedronTools::CheckMemoryBudget(PredictedSize))) {
+      State = EPolyhedronGenerationJobState::Failed;
+      return true;
+    }
+    NextStepIndex = 0;
+  }
+
+  // Apply the seed and operations; an operation is the smallest slice.
+  while (NextStepIndex < Steps.Num()) {
+    if (bCancelRequested) { State = EPolyhedronGenerationJobState::Cancelled; return true; }
+    Polyhedron = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Steps[NextStepIndex++], Polyhedron, OperationParameters);
+    if (Polyhedron.Polygons.Num() == 0) {
+      State = EPolyhedronGenerationJobState::Failed;
+      return true;
+    }
+    UpdateProgress();
+    if (IsOverBudget()) return false;
+  }
+
+  if (!bScaled) {
+    if (bCancelRequested) { State = EPolyhedronGenerationJobState::Cancelled; return true; }
+    Polyhedron = FPolyhedronTools::ScaleToSphere(Polyhedron, Scale);
+    bScaled = true;
+    SectionBuilder = MakeUnique<FPolyhedronSectionBuilder>(Polyhedron, UVGeneration, /*bBuildGeometry=*/true, bEncodePolygonIndices);
+    UpdateProgress();
+    if (IsOverBudget()) return false;
+  }
+
+  // Build the mesh sections by ranges of polygons, with whatever budget remains.
+  while (!SectionBuilder->IsComplete()) {
+    if (bCancelRequested) { State = EPolyhedronGenerationJobState::Cancelled; return true; }
+    double RemainingSeconds = TimeBudgetSeconds - (FPlatformTime::Seconds() - StartTime);
+    SectionBuilder->Build(FMath::Max(0.0, RemainingSeconds));
+    UpdateProgress();
+    if (!SectionBuilder->IsComplete()) return false;
+  }
+
+  State = EPolyhedronGenerationJobState::Completed;
+  return true;
+}
+
+TArray<FPolyhedronSection>& FPolyhedronGenerationJob::GetSections() {
+  check(SectionBuilder.IsValid());
+  return SectionBuilder->GetSections();
+}
+
+void FPolyhedronGenerationJob::UpdateProgress() {
+  // Every operation weighs as much as the scaling and the section building; good enough for a progress bar.
+  float StepTotal = static_cast<float>(Steps.Num() + 2);
+  float StepsDone = static_cast<float>(NextStepIndex) + (bScaled ? 1.0f : 0.0f) + (SectionBuilder.IsValid() ? SectionBuilder->GetProgress() : 0.0f);
+  Progress = FMath::Clamp(StepsDone / StepTotal, 0.0f, 1.0f);
+}
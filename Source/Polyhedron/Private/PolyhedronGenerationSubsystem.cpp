@@ -0,0 +1,201 @@
+// Copyright 2024 TabbyCoder
+
+#include "PolyhedronGenerationSubsystem.h"
+#include "PolyhedronConway.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+namespace {
+  TAutoConsoleVariable<float> CVarPolyhedronGenerationFrameBudget(
+    TEXT("Polyhedron.Generation.FrameBudgetMs"),
+    4.0f,
+    TEXT("Time budget, in milliseconds, spent each frame generating deferred polyhedra. Every frame, at least one generation job advances by one slice."),
+    ECVF_Default);
+
+  TAutoConsoleVariable<int32> CVarPolyhedronGenerationMaxJobs(
+    TEXT("Polyhedron.Generation.MaxJobs"),
+    4,
+    TEXT("Number of deferred polyhedra generated concurrently; they share the frame budget."),
+    ECVF_Default);
+
+  struct FPolyhedronGenerationCandidate {
+    APolyhedronConway* Polyhedron;
+    double Distance;
+    bool bInView;
+  };
+}
+
+void UPolyhedronGenerationSubsystem::Tick(float DeltaTime) {
+  Super::Tick(DeltaTime);
+
+  // Forget about the polyhedra that were destroyed without unregistering.
+  Polyhedra.RemoveAllSwap([] (const TWeakObjectPtr<APolyhedronConway>& Polyhedron) { return !Polyhedron.IsValid(); });
+  StreamingPolyhedra.RemoveAllSwap([] (const TWeakObjectPtr<APolyhedronConway>& Polyhedron) { return !Polyhedron.IsValid(); });
+  TArray<FViewPoint> ViewPoints;
+  if (Polyhedra.Num() > 0 || StreamingPolyhedra.Num() > 0) {
+    GatherViewPoints(ViewPoints);
+  }
+
+  // The streamed polyhedra generate their tiles on worker threads; they only need to know where the viewers are.
+  if (StreamingPolyhedra.Num() > 0) {
+    TArray<FVector> ViewLocations;
+    for (const FViewPoint& ViewPoint : ViewPoints) {
+      ViewLocations.Add(ViewPoint.Location);
+    }
+    for (const TWeakObjectPtr<APolyhedronConway>& StreamingPolyhedron : StreamingPolyhedra) {
+      StreamingPolyhedron->UpdateStreaming(ViewLocations);
+    }
+  }
+
+  if (Polyhedra.Num() > 0) {
+
+    // Measure each polyhedron against the closest view point; release the far-away ones on the way.
+    TArray<FPolyhedronGenerationCandidate> Candidates;
+    for (const TWeakObjectPtr<APolyhedronConway>& WeakPolyhedron : Polyhedra) {
+      if (ViewPoints.Num() == 0) break;
+      APolyhedronConway* Polyhedron = WeakPolyhedron.Get();
+      FVector PolyhedronLocation = Polyhedron->GetActorLocation();
+      double BoundingRadius = Polyhedron->GetBoundingRadius();
+
+      double Distance = TNumericLimits<double>::Max();
+      bool bInView = false;
+      for (const FViewPoint& ViewPoint : ViewPoints) {
+        FVector ToPolyhedron = PolyhedronLocation - ViewPoint.Location;
+        double CenterDistance = ToPolyhedron.Size();
+        Distance = FMath::Min(Distance, FMath::Max(0.0, CenterDistance - BoundingRadius));
+
+        // The polyhedron is in view when its bounding sphere overlaps the view cone.
+        if (CenterDistance <= BoundingRadius) {
+          bInView = true;
+        } else {
+          double AngularRadius = FMath::Asin(BoundingRadius / CenterDistance);
+          double Angle = FMath::Acos(FMath::Clamp(ToPolyhedron.Dot(ViewPoint.Direction) / CenterDistance, -1.0, 1.0));
+          bInView |= Angle <= ViewPoint.HalfFOVRadians + AngularRadius;
+        }
+      }
+
+      if (Polyhedron->IsPolyhedronGenerated()) {
+        if (Polyhedron->ShouldReleaseWhenFar() && Distance > Polyhedron->GetReleaseDistance()) {
+          Polyhedron->ReleasePolyhedron();
+        }
+      } else if (Distance <= Polyhedron->GetGenerationDistance()) {
+        Candidates.Add({ Polyhedron, Distance, bInView });
+      }
+    }
+
+    // The polyhedra in view come first, then the closest ones.
+    Candidates.Sort([] (const FPolyhedronGenerationCandidate& A, const FPolyhedronGenerationCandidate& B) {
+      if (A.bInView != B.bInView) return A.bInView;
+      return A.Distance < B.Distance;
+    });
+
+    TArray<APolyhedronConway*> SortedCandidates;
+    SortedCandidates.Reserve(Candidates.Num());
+    for (const FPolyhedronGenerationCandidate& Candidate : Candidates) {
+      SortedCandidates.Add(Candidate.Polyhedron);
+    }
+    AdmitJobs(SortedCandidates);
+  }
+
+  RunJobs();
+}
+
+void UPolyhedronGenerationSubsystem::AdmitJobs(const TArray<APolyhedronConway*>& Candidates) {
+  int32 MaxJobs = FMath::Max(1, CVarPolyhedronGenerationMaxJobs.GetValueOnGameThread());
+  for (APolyhedronConway* Candidate : Candidates) {
+    if (Jobs.Num() >= MaxJobs) break;
+    if (Jobs.ContainsByPredicate([Candidate] (const FJob& Job) { return Job.Polyhedron.Get() == Candidate; })) continue;
+    Jobs.Add({ Candidate, Candidate->CreateGenerationJob() });
+  }
+}
+
+void UPolyhedronGenerationSubsystem::RunJobs() {
+  if (Jobs.Num() == 0) return;
+
+  // Visit each job once, resuming the round-robin where the previous frame stopped.
+  // Each job gets an equal share of the remaining budget, so the time left over by a quick job goes to the next ones.
+  double BudgetSeconds = FMath::Max(0.0f, CVarPolyhedronGenerationFrameBudget.GetValueOnGameThread()) / 1000.0;
+  double Deadline = FPlatformTime::Seconds() + BudgetSeconds;
+  int32 JobTotal = Jobs.Num();
+  int32 FirstJobIndex = NextJobIndex % JobTotal;
+  for (int32 Visit = 0; Visit < JobTotal; ++Visit) {
+    int32 JobIndex = (FirstJobIndex + Visit) % JobTotal;
+    double RemainingSeconds = Deadline - FPlatformTime::Seconds();
+    if (Visit > 0 && RemainingSeconds <= 0.0) {
+      NextJobIndex = JobIndex;
+      break;
+    }
+    NextJobIndex = JobIndex + 1;
+
+    FJob& Job = Jobs[JobIndex];
+    if (!Job.Polyhedron.IsValid()) {
+      Job.Job->Cancel();
+    }
+    Job.Job->Run(FMath::Max(0.0, RemainingSeconds) / static_cast<double>(JobTotal - Visit));
+  }
+
+  // Hand the finished polyhedra over to their actors.
+  for (int32 JobIndex = Jobs.Num() - 1; JobIndex >= 0; --JobIndex) {
+    FJob& Job = Jobs[JobIndex];
+    if (!Job.Job->IsFinished()) continue;
+    if (Job.Job->GetState() == EPolyhedronGenerationJobState::Completed && Job.Polyhedron.IsValid()) {
+      Job.Polyhedron->ApplyGenerationJob(*Job.Job);
+    }
+    Jobs.RemoveAt(JobIndex);
+    if (JobIndex < NextJobIndex) --NextJobIndex;
+  }
+}
+
+TStatId UPolyhedronGenerationSubsystem::GetStatId() const {
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UPolyhedronGenerationSubsystem, STATGROUP_Tickables);
+}
+
+bool UPolyhedronGenerationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+  // Editor worlds have no viewer to measure against; they generate their polyhedra right away.
+  return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPolyhedronGenerationSubsystem::RegisterPolyhedron(APolyhedronConway* Polyhedron) {
+  if (Polyhedron == nullptr) return;
+  Polyhedra.AddUnique(Polyhedron);
+}
+
+void UPolyhedronGenerationSubsystem::UnregisterPolyhedron(APolyhedronConway* Polyhedron) {
+  Polyhedra.RemoveSwap(Polyhedron);
+
+  // Drop the pending work of that polyhedron.
+  for (int32 JobIndex = Jobs.Num() - 1; JobIndex >= 0; --JobIndex) {
+    if (Jobs[JobIndex].Polyhedron.Get() == Polyhedron) {
+      Jobs[JobIndex].Job->Cancel();
+      Jobs.RemoveAt(JobIndex);
+      if (JobIndex < NextJobIndex) --NextJobIndex;
+    }
+  }
+}
+
+void UPolyhedronGenerationSubsystem::RegisterStreamingPolyhedron(APolyhedronConway* Polyhedron) {
+  if (Polyhedron == nullptr) return;
+  StreamingPolyhedra.AddUnique(Polyhedron);
+}
+
+void UPolyhedronGenerationSubsystem::UnregisterStreamingPolyhedron(APolyhedronConway* Polyhedron) {
+  StreamingPolyhedra.RemoveSwap(Polyhedron);
+}
+
+void UPolyhedronGenerationSubsystem::GatherViewPoints(TArray<FViewPoint>& OutViewPoints) const {
+  UWorld* World = GetWorld();
+  if (World == nullptr) return;
+
+  for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator) {
+    APlayerController* PlayerController = Iterator->Get();
+    if (PlayerController == nullptr || !PlayerController->IsLocalController()) continue;
+
+    FVector Location;
+    FRotator Rotation;
+    PlayerController->GetPlayerViewPoint(Location, Rotation);
+
+    float FOVDegrees = PlayerController->PlayerCameraManager != nullptr ? PlayerController->PlayerCameraManager->GetFOVAngle() : 90.0f;
+    OutViewPoints.Add({ Location, Rotation.Vector(), FMath::DegreesToRadians(FOVDegrees * 0.5) });
+  }
+}
@@ -3,86 +3,670 @@
 // Based on earlier work from George W. Hart.  http://www.georgehart.com/
 
 #include "PolyhedronOperations.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+#include "Helpers.h"
 #include "PolyhedronTools.h"
 
-// This structure is intended to remain similar to the Polyhedronisme "poly_flag" structure.
-// It helps with porting the operation code. Some operations have been optimized to avoid this structure.
-struct FPolyhedronOperationFlagHelper {
-  void AddWorkVertex(int64 VertexId, const FVector& Position);
-  void AddWorkFlag(int64 FaceId, int64 VertexId1, int64 VertexId2);
-  FPolyhedronMesh ConvertWorkBuffers();
+namespace {
+  using EElement = EPolyhedronLocalElement;
+  using EWalk = EPolyhedronLocalWalk;
+  using EParameter = EPolyhedronOperationParameter;
 
-  TMap<int64, FVector> WorkVertexPositions;
-  TMap<int64, int64> WorkVertexIndices;
-  TMap<int64, TMap<int64, int64>> WorkPolygonFlags;
-};
+  FPolyhedronVertexRecipe MakeVertexRecipe(int32 VertexIndex) {
+    FPolyhedronVertexRecipe Recipe;
+    Recipe.Terms.Add({ VertexIndex, 1.0 });
+    return Recipe;
+  }
+
+  FPolyhedronVertexRecipe MakePolygonCenterRecipe(const FPolyhedronPolygon& Polygon) {
+    FPolyhedronVertexRecipe Recipe;
+    double Weight = 1.0 / static_cast<double>(Polygon.VertexIndices.Num());
+    for (int32 VertexIndex : Polygon.VertexIndices) {
+      Recipe.Terms.Add({ VertexIndex, Weight });
+    }
+    return Recipe;
+  }
+
+  // The half-edge that runs the other way along the same edge.
+  int32 GetTwinHalfEdgeIndex(FPolyhedronExtendedMesh& ExtendedMesh, int32 HalfEdgeIndex) {
+    const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedMesh.PolygonHalfEdges[HalfEdgeIndex];
+    FPolyhedronDirectedHalfEdge* TwinHalfEdge = ExtendedMesh.FindHalfEdge(HalfEdge.VertexIndexTo, HalfEdge.VertexIndexFrom);
+    check(TwinHalfEdge != nullptr); // your mesh is not manifold if this check triggers.
+    return static_cast<int32>(TwinHalfEdge - ExtendedMesh.PolygonHalfEdges.GetData());
+  }
+
+  // The half-edge that ends where this one starts, within the same polygon.
+  int32 GetPreviousHalfEdgeIndex(const FPolyhedronExtendedMesh& ExtendedMesh, int32 HalfEdgeIndex) {
+    int32 PolygonIndex = ExtendedMesh.PolygonHalfEdges[HalfEdgeIndex].PolygonIndex;
+    int32 PolygonHalfEdgeOffset = ExtendedMesh.PolygonHalfEdgeOffsets[PolygonIndex];
+    return HalfEdgeIndex == PolygonHalfEdgeOffset ? ExtendedMesh.PolygonHalfEdgeOffsets[PolygonIndex + 1] - 1 : HalfEdgeIndex - 1;
+  }
+
+  // The provenance of an output element: a vertex belongs to the first polygon around it, a half-edge or an edge to its polygon.
+  FPolyhedronProvenance MakeVertexSource(const FPolyhedronExtendedMesh& ExtendedMesh, int32 VertexIndex) {
+    int32 VertexHalfEdgeOffset = ExtendedMesh.VertexHalfEdgeOffsets[VertexIndex];
+    bool bHasPolygon = VertexHalfEdgeOffset < ExtendedMesh.VertexHalfEdgeOffsets[VertexIndex + 1];
+    return { EElement::Vertex, VertexIndex, bHasPolygon ? ExtendedMesh.PolygonHalfEdges[ExtendedMesh.VertexHalfEdgeIndices[VertexHalfEdgeOffset].Get<1>()].PolygonIndex : INDEX_NONE };
+  }
+
+  FPolyhedronProvenance MakeHalfEdgeSource(const FPolyhedronExtendedMesh& ExtendedMesh, int32 HalfEdgeIndex, EElement Element = EElement::HalfEdge) {
+    return { Element, HalfEdgeIndex, ExtendedMesh.PolygonHalfEdges[HalfEdgeIndex].PolygonIndex };
+  }
+
+  FPolyhedronProvenance MakePolygonSource(int32 PolygonIndex) {
+    return { EElement::Polygon, PolygonIndex, PolygonIndex };
+  }
+
+  // Chains the sources of the stages from FirstStageIndex on; the sources of each stage refer to the output of the previous one.
+  void ComposeSources(const FPolyhedronOperationRecorder& Recorder, int32 FirstStageIndex, TArray<FPolyhedronProvenance>& VertexSources, TArray<FPolyhedronProvenance>& PolygonSources) {
+    VertexSources.Reset();
+    PolygonSources.Reset();
+    REPORT_ERROR_IF(FirstStageIndex < 0 || FirstStageIndex >= Recorder.Stages.Num(), "Stage %d is not recorded", FirstStageIndex);
+    for (int32 StageIndex = FirstStageIndex; StageIndex < Recorder.Stages.Num(); ++StageIndex) {
+      const FPolyhedronOperationStage& Stage = Recorder.Stages[StageIndex];
+      if (Stage.PolygonSources.Num() == 0 && Stage.Vertices.Num() > 0) {
+        VertexSources.Reset();
+        PolygonSources.Reset();
+        REPORT_ERROR("Stage %d was recorded without its provenance", StageIndex);
+        return;
+      }
+      if (StageIndex == FirstStageIndex) {
+        VertexSources = Stage.VertexSources;
+        PolygonSources = Stage.PolygonSources;
+        continue;
+      }
+
+      // Vertices and polygons follow their own kind; the edges and half-edges are not recorded, so they follow their polygon.
+      auto Resolve = [&] (const FPolyhedronProvenance& Source) -> const FPolyhedronProvenance& {
+        switch (Source.Element) {
+        case EElement::Vertex: return VertexSources[Source.Index];
+        case EElement::Polygon: return PolygonSources[Source.Index];
+        default: return PolygonSources[Source.PolygonIndex];
+        }
+      };
+      TArray<FPolyhedronProvenance> NextVertexSources, NextPolygonSources;
+      NextVertexSources.SetNumUninitialized(Stage.VertexSources.Num());
+      NextPolygonSources.SetNumUninitialized(Stage.PolygonSources.Num());
+      ParallelFor(Stage.VertexSources.Num(), [&] (int32 VertexIndex) {
+        NextVertexSources[VertexIndex] = Resolve(Stage.VertexSources[VertexIndex]);
+      });
+      ParallelFor(Stage.PolygonSources.Num(), [&] (int32 PolygonIndex) {
+        NextPolygonSources[PolygonIndex] = Resolve(Stage.PolygonSources[PolygonIndex]);
+      });
+      VertexSources = MoveTemp(NextVertexSources);
+      PolygonSources = MoveTemp(NextPolygonSources);
+    }
+  }
 
-void FPolyhedronOperationFlagHelper::AddWorkVertex(int64 VertexId, const FVector& Position) {
-  if (!WorkVertexIndices.Contains(VertexId)) {
-    WorkVertexIndices.Add(VertexId, static_cast<int64>(0)); // Indexed at a later time?
-    WorkVertexPositions.Add(VertexId, Position);
+  // Each edge is shared by two polygons.
+  int64 CountEdges(const TMap<int32, int64>& PolygonSideCounts) {
+    int64 HalfEdgeCount = 0;
+    for (const TPair<int32, int64>& SideCount : PolygonSideCounts) {
+      HalfEdgeCount += SideCount.Key * SideCount.Value;
+    }
+    return HalfEdgeCount / 2;
+  }
+
+  // The memory that one primitive operation holds at once: its input, the half-edges of ComputeEdgeDetails(), the few
+  // indices per half-edge and the polygon centers and normals of the operation, and its output.
+  int64 PredictOperationMemorySize(const FPolyhedronMeshSize& Input, const FPolyhedronMeshSize& Output) {
+    int64 HalfEdgeSize = sizeof(FPolyhedronDirectedHalfEdge) + sizeof(TPair<int32, int32>) + 3 * sizeof(int32);
+    int64 OffsetsSize = (Input.VertexCount + Input.PolygonCount + 2) * sizeof(int32);
+    return Input.GetMemorySize() + 2 * Input.EdgeCount * HalfEdgeSize + OffsetsSize + 2 * Input.PolygonCount * sizeof(FVector) + Output.GetMemorySize();
+  }
+
+  // The local operator tables.
+  // Vertices: { Element, FromWeight, ToWeight, CenterWeight, Parameter, RadialFactor, NormalFactor, bNormalize }.
+  // Faces: { Element, { { Walk, Element, Index }, ... }, bReverse }, where half-edge k of a polygon goes from its vertex k - 1 to its vertex k.
+  const FPolyhedronLocalOperator& GetDualOperator() {
+    // Every polygon becomes a vertex at its center, and every vertex becomes the polygon of its surrounding centers.
+    static const FPolyhedronLocalOperator Operator = {
+      { { EElement::Polygon, 0.0, 0.0, 1.0 } },
+      { { EElement::Vertex, { { EWalk::Self, EElement::Polygon } } } }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetReflectOperator() {
+    // The reflection turns the polygons inside out; reversing them keeps them facing outward.
+    static const FPolyhedronLocalOperator Operator = {
+      { { EElement::Vertex, -1.0 } },
+      { { EElement::Polygon, { { EWalk::Self, EElement::Vertex } }, true } }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetAmboOperator() {
+    // The edge midpoints, joined around each polygon and around each vertex.
+    static const FPolyhedronLocalOperator Operator = {
+      { { EElement::Edge, 0.5, 0.5 } },
+      {
+        { EElement::Polygon, { { EWalk::Self, EElement::Edge } } },
+        { EElement::Vertex, { { EWalk::Self, EElement::Edge } } }
+      }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetKisOperator() {
+    // A pyramid on every polygon, with its apex above the polygon center.
+    static const FPolyhedronLocalOperator Operator = {
+      {
+        { EElement::Vertex, 1.0 },
+        { EElement::Polygon, 0.0, 0.0, 1.0, EParameter::KisApexOffset, 0.0, 1.0 }
+      },
+      { { EElement::HalfEdge, { { EWalk::Self, EElement::Vertex }, { EWalk::Next, EElement::Vertex }, { EWalk::Self, EElement::Polygon } } } }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetChamferOperator() {
+    // The original vertices move outward, each polygon moves along its normal, and every edge becomes a hexagon between them.
+    static const FPolyhedronLocalOperator Operator = {
+      {
+        { EElement::Vertex, 1.0, 0.0, 0.0, EParameter::ChamferOffset, 1.0 },
+        { EElement::HalfEdge, 0.0, 1.0, 0.0, EParameter::ChamferOffset, 0.0, 1.5 }
+      },
+      {
+        { EElement::Polygon, { { EWalk::Self, EElement::HalfEdge } } },
+        { EElement::Edge, { { EWalk::Next, EElement::Vertex }, { EWalk::Self, EElement::HalfEdge }, { EWalk::Previous, EElement::HalfEdge } } }
+      }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetGyroOperator() {
+    // Each half-edge gets a point a third of the way along, and a pentagon from the polygon center around its end vertex.
+    static const FPolyhedronLocalOperator Operator = {
+      {
+        { EElement::Vertex, 1.0, 0.0, 0.0, EParameter::None, 0.0, 0.0, true },
+        { EElement::Polygon, 0.0, 0.0, 1.0, EParameter::None, 0.0, 0.0, true },
+        { EElement::HalfEdge, 2.0 / 3.0, 1.0 / 3.0 }
+      },
+      { { EElement::HalfEdge, { { EWalk::Self, EElement::Polygon }, { EWalk::Self, EElement::HalfEdge }, { EWalk::Twin, EElement::HalfEdge }, { EWalk::Next, EElement::Vertex }, { EWalk::Next, EElement::HalfEdge } } } }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetLoftOperator() {
+    static const FPolyhedronLocalOperator Operator = {
+      {
+        { EElement::Vertex, 1.0 },
+        { EElement::HalfEdge, 0.0, 2.0 / 3.0, 1.0 / 3.0 }
+      },
+      {
+        { EElement::Polygon, { { EWalk::Self, EElement::HalfEdge } } },
+        { EElement::HalfEdge, { { EWalk::Self, EElement::Vertex }, { EWalk::Next, EElement::Vertex }, { EWalk::Self, EElement::HalfEdge }, { EWalk::Previous, EElement::HalfEdge } } }
+      }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetPropellerOperator() {
+    static const FPolyhedronLocalOperator Operator = {
+      {
+        { EElement::Vertex, 1.0 },
+        { EElement::HalfEdge, 2.0 / 3.0, 1.0 / 3.0 }
+      },
+      {
+        { EElement::Polygon, { { EWalk::Self, EElement::HalfEdge } } },
+        { EElement::HalfEdge, { { EWalk::Self, EElement::HalfEdge }, { EWalk::Twin, EElement::HalfEdge }, { EWalk::Next, EElement::Vertex }, { EWalk::Next, EElement::HalfEdge } } }
+      }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetQuintoOperator() {
+    // The inner points sit halfway between the edge midpoints and the polygon center.
+    static const FPolyhedronLocalOperator Operator = {
+      {
+        { EElement::Vertex, 1.0 },
+        { EElement::Edge, 0.5, 0.5 },
+        { EElement::HalfEdge, 0.25, 0.25, 0.5 }
+      },
+      {
+        { EElement::Polygon, { { EWalk::Self, EElement::HalfEdge } } },
+        { EElement::HalfEdge, { { EWalk::Self, EElement::Edge }, { EWalk::Next, EElement::Vertex }, { EWalk::Next, EElement::Edge }, { EWalk::Next, EElement::HalfEdge }, { EWalk::Self, EElement::HalfEdge } } }
+      }
+    };
+    return Operator;
+  }
+
+  const FPolyhedronLocalOperator& GetWhirlOperator() {
+    // Gyro, with the polygon center replaced by a smaller rotated copy of the polygon: its points sit a third of the way
+    // from the polygon center to the gyro points.
+    static const FPolyhedronLocalOperator Operator = {
+      {
+        { EElement::Vertex, 1.0 },
+        { EElement::HalfEdge, 2.0 / 3.0, 1.0 / 3.0 },
+        { EElement::HalfEdge, 2.0 / 9.0, 1.0 / 9.0, 2.0 / 3.0 }
+      },
+      {
+        { EElement::Polygon, { { EWalk::Self, EElement::HalfEdge, 1 } } },
+        { EElement::HalfEdge, { { EWalk::Self, EElement::HalfEdge, 1 }, { EWalk::Self, EElement::HalfEdge, 0 }, { EWalk::Twin, EElement::HalfEdge, 0 }, { EWalk::Next, EElement::Vertex }, { EWalk::Next, EElement::HalfEdge, 0 }, { EWalk::Next, EElement::HalfEdge, 1 } } }
+      }
+    };
+    return Operator;
   }
-  WorkVertexPositions[VertexId] = Position;
 }
 
-void FPolyhedronOperationFlagHelper::AddWorkFlag(int64 FaceId, int64 VertexId1, int64 VertexId2) {
-  if (!WorkPolygonFlags.Contains(FaceId)) {
-    WorkPolygonFlags.Add(FaceId, TMap<int64, int64>());
+double FPolyhedronOperationParameters::GetValue(EPolyhedronOperationParameter Parameter) const {
+  switch (Parameter) {
+  case EPolyhedronOperationParameter::KisApexOffset: return KisApexOffset;
+  case EPolyhedronOperationParameter::ChamferOffset: return ChamferOffset;
+  default: return 1.0;
   }
-  WorkPolygonFlags[FaceId].FindOrAdd(VertexId1) = VertexId2;
 }
 
-FPolyhedronMesh FPolyhedronOperationFlagHelper::ConvertWorkBuffers() {
+void FPolyhedronOperationStage::AddVertex(const FPolyhedronVertexRecipe& Recipe) {
+  Vertices.Add({ Terms.Num(), Recipe.Terms.Num(), Recipe.NormalPolygonIndex, Recipe.Parameter, Recipe.bNormalize, Recipe.bKeepTermRadius, Recipe.RadialFactor, Recipe.NormalFactor });
+  Terms.Append(Recipe.Terms);
+}
 
-  // A Flag is an associative triple of a face index and two adjacent vertex vertidxs,
-  // listed in geometric clockwise order (staring into the normal)
-  //
-  // Face_i -> V_i -> V_j
-  //
-  // They are a useful abstraction for defining topological transformations of the polyhedral mesh, as
-  // one can refer to vertices and faces that don't yet exist or haven't been traversed yet in the
-  // transformation code.
+FPolyhedronOperationStage& FPolyhedronOperationRecorder::AddStage(const FPolyhedronMesh& Input, bool bKeepInputPolygons) {
+  FPolyhedronOperationStage& Stage = Stages.AddDefaulted_GetRef();
+  Stage.InputVertexCount = Input.Vertices.Num();
+  if (bKeepInputPolygons) {
+    Stage.InputPolygons = Input.Polygons;
+  }
+  return Stage;
+}
+
+FPolyhedronMeshSize FPolyhedronMeshSize::Measure(const FPolyhedronMesh& Polyhedron) {
+  FPolyhedronMeshSize Size;
+  Size.VertexCount = Polyhedron.Vertices.Num();
+  Size.PolygonCount = Polyhedron.Polygons.Num();
+  TArray<int32> VertexDegrees;
+  VertexDegrees.SetNumZeroed(Polyhedron.Vertices.Num());
+  for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+    ++Size.PolygonSideCounts.FindOrAdd(Polygon.VertexIndices.Num());
+    for (int32 VertexIndex : Polygon.VertexIndices) {
+      ++VertexDegrees[VertexIndex];
+    }
+  }
+  for (int32 VertexDegree : VertexDegrees) {
+    ++Size.VertexDegreeCounts.FindOrAdd(VertexDegree);
+  }
+  Size.EdgeCount = CountEdges(Size.PolygonSideCounts);
+  return Size;
+}
+
+int64 FPolyhedronMeshSize::GetMemorySize() const {
+  return VertexCount * sizeof(FVector) + PolygonCount * sizeof(FPolyhedronPolygon) + 2 * EdgeCount * sizeof(int32);
+}
+
+TArray<FPolyhedronProvenance> FPolyhedronOperationRecorder::ComposeVertexSources(int32 FirstStageIndex) const {
+  TArray<FPolyhedronProvenance> VertexSources, PolygonSources;
+  ComposeSources(*this, FirstStageIndex, VertexSources, PolygonSources);
+  return VertexSources;
+}
+
+TArray<FPolyhedronProvenance> FPolyhedronOperationRecorder::ComposePolygonSources(int32 FirstStageIndex) const {
+  TArray<FPolyhedronProvenance> VertexSources, PolygonSources;
+  ComposeSources(*this, FirstStageIndex, VertexSources, PolygonSources);
+  return PolygonSources;
+}
+
+FPolyhedronMesh FPolyhedronOperations::ApplyLocalOperator(const FPolyhedronMesh& Input, const FPolyhedronLocalOperator& Operator, const FPolyhedronOperationParameters& Parameters, FPolyhedronOperationRecorder* Recorder) {
+  // Local Operator
+  // ------------------------------------------------------------------------------------------
+  // A local Conway operator repeats the same pattern on every vertex, edge, polygon and half-edge of its input.
+  // The output vertices and faces are numbered by element kind, then by element, then by rule, so that every one of
+  // them is computed independently from the half-edge structure.
   //
-  // A flag is similar in concept to a directed edge.
+  constexpr int32 ElementKindCount = 4;
+  int32 ElementVertexCounts[ElementKindCount] = {};
+  TArray<int32> ElementVertexRules[ElementKindCount];
+  bool bUsesNormals = false;
+  for (int32 RuleIndex = 0; RuleIndex < Operator.Vertices.Num(); ++RuleIndex) {
+    const FPolyhedronLocalVertex& Rule = Operator.Vertices[RuleIndex];
+    bool bValidRule = true;
+    switch (Rule.Element) {
+    case EElement::Vertex: bValidRule = Rule.ToWeight == 0.0 && Rule.CenterWeight == 0.0 && Rule.NormalFactor == 0.0; break;
+    case EElement::Edge: bValidRule = Rule.FromWeight == Rule.ToWeight && Rule.CenterWeight == 0.0 && Rule.NormalFactor == 0.0; break;
+    case EElement::Polygon: bValidRule = Rule.FromWeight == 0.0 && Rule.ToWeight == 0.0; break;
+    default: break;
+    }
+    REPORT_ERROR_RETURN_IF(!bValidRule, FPolyhedronMesh(), "Local operator vertex %d weighs what its element does not have", RuleIndex);
+    int32 ElementKind = static_cast<int32>(Rule.Element);
+    ElementVertexRules[ElementKind].Add(RuleIndex);
+    ++ElementVertexCounts[ElementKind];
+    bUsesNormals |= Rule.NormalFactor != 0.0;
+  }
+  for (const FPolyhedronLocalFace& Face : Operator.Faces) {
+    REPORT_ERROR_RETURN_IF(Face.Corners.Num() == 0, FPolyhedronMesh(), "Local operator face has no corners");
+    for (const FPolyhedronLocalCorner& Corner : Face.Corners) {
+      REPORT_ERROR_RETURN_IF(Corner.Index < 0 || Corner.Index >= ElementVertexCounts[static_cast<int32>(Corner.Element)], FPolyhedronMesh(), "Local operator face refers to a missing vertex");
+    }
+  }
+
+  // Number the edges from their half-edges: the half-edge from the lowest vertex owns the edge.
+  FPolyhedronExtendedMesh ExtendedInput = FPolyhedronTools::ComputeEdgeDetails(Input);
+  const TArray<FPolyhedronDirectedHalfEdge>& HalfEdges = ExtendedInput.PolygonHalfEdges;
+  int32 InputVertexCount = Input.Vertices.Num();
+  int32 InputPolygonCount = Input.Polygons.Num();
+  int32 HalfEdgeCount = HalfEdges.Num();
+  TArray<int32> HalfEdgeEdgeIndices, EdgeHalfEdgeIndices, TwinHalfEdgeIndices;
+  HalfEdgeEdgeIndices.SetNumUninitialized(HalfEdgeCount);
+  EdgeHalfEdgeIndices.Reserve(HalfEdgeCount / 2);
+  for (int32 HalfEdgeIndex = 0; HalfEdgeIndex < HalfEdgeCount; ++HalfEdgeIndex) {
+    if (HalfEdges[HalfEdgeIndex].VertexIndexFrom < HalfEdges[HalfEdgeIndex].VertexIndexTo) {
+      HalfEdgeEdgeIndices[HalfEdgeIndex] = EdgeHalfEdgeIndices.Add(HalfEdgeIndex);
+    }
+  }
+  int32 EdgeCount = EdgeHalfEdgeIndices.Num();
+  TwinHalfEdgeIndices.SetNumUninitialized(HalfEdgeCount);
+  ParallelFor(HalfEdgeCount, [&] (int32 HalfEdgeIndex) {
+    int32 TwinHalfEdgeIndex = GetTwinHalfEdgeIndex(ExtendedInput, HalfEdgeIndex);
+    TwinHalfEdgeIndices[HalfEdgeIndex] = TwinHalfEdgeIndex;
+    if (HalfEdges[HalfEdgeIndex].VertexIndexFrom > HalfEdges[HalfEdgeIndex].VertexIndexTo) {
+      HalfEdgeEdgeIndices[HalfEdgeIndex] = HalfEdgeEdgeIndices[TwinHalfEdgeIndex];
+    }
+  });
+
+  auto Walk = [&] (int32 HalfEdgeIndex, EWalk Step) -> int32 {
+    if (Step == EWalk::Twin) return TwinHalfEdgeIndices[HalfEdgeIndex];
+    if (Step == EWalk::Self) return HalfEdgeIndex;
+    int32 PolygonIndex = HalfEdges[HalfEdgeIndex].PolygonIndex;
+    int32 PolygonHalfEdgeOffset = ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex];
+    int32 PolygonHalfEdgeCount = ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex + 1] - PolygonHalfEdgeOffset;
+    int32 PolygonHalfEdgeIndex = HalfEdgeIndex - PolygonHalfEdgeOffset + (Step == EWalk::Next ? 1 : PolygonHalfEdgeCount - 1);
+    return PolygonHalfEdgeOffset + PolygonHalfEdgeIndex % PolygonHalfEdgeCount;
+  };
+
+  // The output vertices: all those of the input vertices first, then those of the edges, the polygons and the half-edges.
+  int32 ElementCounts[ElementKindCount] = { InputVertexCount, EdgeCount, InputPolygonCount, HalfEdgeCount };
+  int32 ElementVertexOffsets[ElementKindCount + 1] = {};
+  for (int32 ElementKind = 0; ElementKind < ElementKindCount; ++ElementKind) {
+    ElementVertexOffsets[ElementKind + 1] = ElementVertexOffsets[ElementKind] + ElementCounts[ElementKind] * ElementVertexCounts[ElementKind];
+  }
+  int32 OutputVertexCount = ElementVertexOffsets[ElementKindCount];
+  auto GetOutputVertexIndex = [&] (int32 HalfEdgeIndex, const FPolyhedronLocalCorner& Corner) -> int32 {
+    int32 CornerHalfEdgeIndex = Walk(HalfEdgeIndex, Corner.Walk);
+    int32 ElementIndex = 0;
+    switch (Corner.Element) {
+    case EElement::Vertex: ElementIndex = HalfEdges[CornerHalfEdgeIndex].VertexIndexFrom; break;
+    case EElement::Edge: ElementIndex = HalfEdgeEdgeIndices[CornerHalfEdgeIndex]; break;
+    case EElement::Polygon: ElementIndex = HalfEdges[CornerHalfEdgeIndex].PolygonIndex; break;
+    case EElement::HalfEdge: ElementIndex = CornerHalfEdgeIndex; break;
+    }
+    int32 ElementKind = static_cast<int32>(Corner.Element);
+    return ElementVertexOffsets[ElementKind] + ElementIndex * ElementVertexCounts[ElementKind] + Corner.Index;
+  };
+
+  TArray<FVector> PolygonCenters = FPolyhedronTools::GetPolygonCenters(Input);
+  TArray<FVector> PolygonNormals = bUsesNormals ? FPolyhedronTools::GetPolygonNormals(Input) : TArray<FVector>();
 
   FPolyhedronMesh Output;
-  Output.Vertices.Reserve(WorkVertexIndices.Num());
+  Output.Vertices.SetNumUninitialized(OutputVertexCount);
+  TArray<FPolyhedronVertexRecipe> Recipes;
+  if (Recorder != nullptr) {
+    Recipes.SetNum(OutputVertexCount);
+  }
+  ParallelFor(OutputVertexCount, [&] (int32 OutputVertexIndex) {
+    int32 ElementKind = 0;
+    while (OutputVertexIndex >= ElementVertexOffsets[ElementKind + 1]) {
+      ++ElementKind;
+    }
+    int32 ElementIndex = (OutputVertexIndex - ElementVertexOffsets[ElementKind]) / ElementVertexCounts[ElementKind];
+    const FPolyhedronLocalVertex& Rule = Operator.Vertices[ElementVertexRules[ElementKind][(OutputVertexIndex - ElementVertexOffsets[ElementKind]) % ElementVertexCounts[ElementKind]]];
+
+    // Find the vertices and the polygon behind the weights.
+    int32 VertexFrom = INDEX_NONE, VertexTo = INDEX_NONE, PolygonIndex = INDEX_NONE;
+    switch (Rule.Element) {
+    case EElement::Vertex: VertexFrom = ElementIndex; break;
+    case EElement::Edge: VertexFrom = HalfEdges[EdgeHalfEdgeIndices[ElementIndex]].VertexIndexFrom; VertexTo = HalfEdges[EdgeHalfEdgeIndices[ElementIndex]].VertexIndexTo; break;
+    case EElement::Polygon: PolygonIndex = ElementIndex; break;
+    case EElement::HalfEdge: VertexFrom = HalfEdges[ElementIndex].VertexIndexFrom; VertexTo = HalfEdges[ElementIndex].VertexIndexTo; PolygonIndex = HalfEdges[ElementIndex].PolygonIndex; break;
+    }
 
-  // Number the vertices.
-  for (TPair<int64, int64>& Iterator : WorkVertexIndices) {
-    Iterator.Get<1>() = Output.Vertices.Num();
-    Output.Vertices.Add(WorkVertexPositions[Iterator.Get<0>()]);
+    // Same evaluation as FPolyhedronParametricMesh::Evaluate().
+    FVector Position = FVector::ZeroVector;
+    Position += Rule.FromWeight != 0.0 ? Rule.FromWeight * Input.Vertices[VertexFrom] : FVector::ZeroVector;
+    Position += Rule.ToWeight != 0.0 ? Rule.ToWeight * Input.Vertices[VertexTo] : FVector::ZeroVector;
+    Position += Rule.CenterWeight != 0.0 ? Rule.CenterWeight * PolygonCenters[PolygonIndex] : FVector::ZeroVector;
+    double ParameterValue = Parameters.GetValue(Rule.Parameter);
+    Position += ParameterValue * Rule.RadialFactor * Position;
+    if (Rule.NormalFactor != 0.0) {
+      Position += ParameterValue * Rule.NormalFactor * PolygonNormals[PolygonIndex];
+    }
+    Output.Vertices[OutputVertexIndex] = Rule.bNormalize ? Position.GetUnsafeNormal() : Position;
+
+    if (Recorder != nullptr) {
+      FPolyhedronVertexRecipe& Recipe = Recipes[OutputVertexIndex];
+      if (Rule.FromWeight != 0.0) Recipe.Terms.Add({ VertexFrom, Rule.FromWeight });
+      if (Rule.ToWeight != 0.0) Recipe.Terms.Add({ VertexTo, Rule.ToWeight });
+      if (Rule.CenterWeight != 0.0) {
+        const TArray<int32>& PolygonVertexIndices = Input.Polygons[PolygonIndex].VertexIndices;
+        for (int32 VertexIndex : PolygonVertexIndices) {
+          Recipe.Terms.Add({ VertexIndex, Rule.CenterWeight / static_cast<double>(PolygonVertexIndices.Num()) });
+        }
+      }
+      Recipe.Parameter = Rule.Parameter;
+      Recipe.RadialFactor = Rule.RadialFactor;
+      Recipe.NormalPolygonIndex = Rule.NormalFactor != 0.0 ? PolygonIndex : INDEX_NONE;
+      Recipe.NormalFactor = Rule.NormalFactor;
+      Recipe.bNormalize = Rule.bNormalize;
+    }
+  });
+  // Every output vertex and face comes from the input element that it repeats on.
+  auto MakeSource = [&] (EElement Element, int32 ElementIndex) -> FPolyhedronProvenance {
+    switch (Element) {
+    case EElement::Vertex: return MakeVertexSource(ExtendedInput, ElementIndex);
+    case EElement::Edge: return MakeHalfEdgeSource(ExtendedInput, EdgeHalfEdgeIndices[ElementIndex], EElement::Edge);
+    case EElement::Polygon: return MakePolygonSource(ElementIndex);
+    default: return MakeHalfEdgeSource(ExtendedInput, ElementIndex);
+    }
+  };
+  FPolyhedronOperationStage* Stage = Recorder != nullptr ? &Recorder->AddStage(Input, bUsesNormals) : nullptr;
+  bool bRecordProvenance = Stage != nullptr && Recorder->bRecordProvenance;
+  if (Stage != nullptr) {
+    for (const FPolyhedronVertexRecipe& Recipe : Recipes) {
+      Stage->AddVertex(Recipe);
+    }
+  }
+  if (bRecordProvenance) {
+    Stage->VertexSources.SetNumUninitialized(OutputVertexCount);
+    ParallelFor(OutputVertexCount, [&] (int32 OutputVertexIndex) {
+      int32 ElementKind = 0;
+      while (OutputVertexIndex >= ElementVertexOffsets[ElementKind + 1]) {
+        ++ElementKind;
+      }
+      int32 ElementIndex = (OutputVertexIndex - ElementVertexOffsets[ElementKind]) / ElementVertexCounts[ElementKind];
+      Stage->VertexSources[OutputVertexIndex] = MakeSource(static_cast<EElement>(ElementKind), ElementIndex);
+    });
+  }
+
+  // The output faces, face rule by face rule.
+  int32 OutputPolygonCount = 0;
+  for (const FPolyhedronLocalFace& Face : Operator.Faces) {
+    OutputPolygonCount += ElementCounts[static_cast<int32>(Face.Element)];
+  }
+  Output.Polygons.SetNum(OutputPolygonCount);
+  if (bRecordProvenance) {
+    Stage->PolygonSources.SetNumUninitialized(OutputPolygonCount);
+  }
+  int32 FacePolygonOffset = 0;
+  for (const FPolyhedronLocalFace& Face : Operator.Faces) {
+    ParallelFor(ElementCounts[static_cast<int32>(Face.Element)], [&] (int32 ElementIndex) {
+      FPolyhedronPolygon& Polygon = Output.Polygons[FacePolygonOffset + ElementIndex];
+      if (bRecordProvenance) {
+        Stage->PolygonSources[FacePolygonOffset + ElementIndex] = MakeSource(Face.Element, ElementIndex);
+      }
+      auto AddCorners = [&] (int32 HalfEdgeIndex) {
+        for (const FPolyhedronLocalCorner& Corner : Face.Corners) {
+          Polygon.VertexIndices.Add(GetOutputVertexIndex(HalfEdgeIndex, Corner));
+        }
+      };
+
+      switch (Face.Element) {
+      case EElement::Vertex: {
+        // Turn around the vertex through its outgoing half-edges.
+        int32 VertexHalfEdgeOffset = ExtendedInput.VertexHalfEdgeOffsets[ElementIndex];
+        int32 VertexHalfEdgeCount = ExtendedInput.VertexHalfEdgeOffsets[ElementIndex + 1] - VertexHalfEdgeOffset;
+        Polygon.VertexIndices.Reserve(VertexHalfEdgeCount * Face.Corners.Num());
+        int32 FirstHalfEdgeIndex = ExtendedInput.VertexHalfEdgeIndices[VertexHalfEdgeOffset].Get<1>();
+        int32 HalfEdgeIndex = FirstHalfEdgeIndex;
+        for (int32 VertexHalfEdgeIndex = 0; VertexHalfEdgeIndex < VertexHalfEdgeCount; ++VertexHalfEdgeIndex) {
+          AddCorners(HalfEdgeIndex);
+          HalfEdgeIndex = TwinHalfEdgeIndices[Walk(HalfEdgeIndex, EWalk::Previous)];
+        }
+        check(HalfEdgeIndex == FirstHalfEdgeIndex); // your mesh is not manifold if this check triggers.
+        break;
+      }
+      case EElement::Edge:
+        Polygon.VertexIndices.Reserve(2 * Face.Corners.Num());
+        AddCorners(EdgeHalfEdgeIndices[ElementIndex]);
+        AddCorners(TwinHalfEdgeIndices[EdgeHalfEdgeIndices[ElementIndex]]);
+        break;
+      case EElement::Polygon: {
+        int32 PolygonHalfEdgeOffset = ExtendedInput.PolygonHalfEdgeOffsets[ElementIndex];
+        int32 PolygonHalfEdgeEnd = ExtendedInput.PolygonHalfEdgeOffsets[ElementIndex + 1];
+        Polygon.VertexIndices.Reserve((PolygonHalfEdgeEnd - PolygonHalfEdgeOffset) * Face.Corners.Num());
+        for (int32 HalfEdgeIndex = PolygonHalfEdgeOffset; HalfEdgeIndex < PolygonHalfEdgeEnd; ++HalfEdgeIndex) {
+          AddCorners(HalfEdgeIndex);
+        }
+        Polygon.MaterialIndex = Input.Polygons[ElementIndex].MaterialIndex;
+        break;
+      }
+      case EElement::HalfEdge:
+        Polygon.VertexIndices.Reserve(Face.Corners.Num());
+        AddCorners(ElementIndex);
+        Polygon.MaterialIndex = Input.Polygons[HalfEdges[ElementIndex].PolygonIndex].MaterialIndex;
+        break;
+      }
+      if (Face.bReverse) {
+        Algo::Reverse(Polygon.VertexIndices);
+      }
+    });
+    FacePolygonOffset += ElementCounts[static_cast<int32>(Face.Element)];
   }
 
-  // Build the faces from the poly-flags.
-  for (TPair<int64, TMap<int64, int64>>& Iterator : WorkPolygonFlags) {
-    TArray<int32> OutputPolygon;
-    TMap<int64, int64>& Face = Iterator.Get<1>();
+  return Output;
+}
+
+FPolyhedronMeshSize FPolyhedronOperations::PredictLocalOperator(const FPolyhedronMeshSize& Input, const FPolyhedronLocalOperator& Operator) {
+  // Every element is reached through as many half-edges as its size: the degree of a vertex, the two halves of an edge,
+  // the sides of a polygon, or the half-edge itself. A face repeats its corners that many times, and a vertex is reached
+  // that many times by each corner that refers to it, once per face around it.
+  constexpr int32 ElementKindCount = 4;
+  int64 HalfEdgeCount = 2 * Input.EdgeCount;
+  int64 ElementCounts[ElementKindCount] = { Input.VertexCount, Input.EdgeCount, Input.PolygonCount, HalfEdgeCount };
+  const TMap<int32, int64> ElementSizeCounts[ElementKindCount] = { Input.VertexDegreeCounts, { { 2, Input.EdgeCount } }, Input.PolygonSideCounts, { { 1, HalfEdgeCount } } };
+  TArray<int32> VertexCornerCounts[ElementKindCount];
+  for (const FPolyhedronLocalVertex& Rule : Operator.Vertices) {
+    VertexCornerCounts[static_cast<int32>(Rule.Element)].Add(0);
+  }
 
-    // Grab any vertex as a starting position.
-    int64 Vertex0 = 0;
-    for (const TPair<int64, int64>& FaceIterator : Face) {
-      Vertex0 = FaceIterator.Get<0>();
-      break;
+  FPolyhedronMeshSize Output;
+  for (const FPolyhedronLocalFace& Face : Operator.Faces) {
+    int32 ElementKind = static_cast<int32>(Face.Element);
+    Output.PolygonCount += ElementCounts[ElementKind];
+    for (const TPair<int32, int64>& SizeCount : ElementSizeCounts[ElementKind]) {
+      Output.PolygonSideCounts.FindOrAdd(Face.Corners.Num() * SizeCount.Key) += SizeCount.Value;
+    }
+    for (const FPolyhedronLocalCorner& Corner : Face.Corners) {
+      TArray<int32>& CornerCounts = VertexCornerCounts[static_cast<int32>(Corner.Element)];
+      REPORT_ERROR_RETURN_IF(!CornerCounts.IsValidIndex(Corner.Index), FPolyhedronMeshSize(), "Local operator face refers to a missing vertex");
+      ++CornerCounts[Corner.Index];
+    }
+  }
+  for (int32 ElementKind = 0; ElementKind < ElementKindCount; ++ElementKind) {
+    for (int32 CornerCount : VertexCornerCounts[ElementKind]) {
+      Output.VertexCount += ElementCounts[ElementKind];
+      for (const TPair<int32, int64>& SizeCount : ElementSizeCounts[ElementKind]) {
+        Output.VertexDegreeCounts.FindOrAdd(CornerCount * SizeCount.Key) += SizeCount.Value;
+      }
     }
+  }
+  Output.EdgeCount = CountEdges(Output.PolygonSideCounts);
+  Output.PeakMemorySize = FMath::Max(Input.PeakMemorySize, PredictOperationMemorySize(Input, Output));
+  return Output;
+}
 
-    // Loop through the flags and record the vertex indices.
-    int64 VertexIterator = Vertex0;
-    OutputPolygon.Add(WorkVertexIndices[VertexIterator]);
-    VertexIterator = Face[VertexIterator];
-    for (int32 BackstopCounter = 0; BackstopCounter < 1000; ++BackstopCounter) {
-      if (VertexIterator == Vertex0) break;
-      OutputPolygon.Add(WorkVertexIndices[VertexIterator]);
-      VertexIterator = Face[VertexIterator];
+FPolyhedronMeshSize FPolyhedronOperations::PredictSubdivide(const FPolyhedronMeshSize& Input, int32 Frequency) {
+  REPORT_ERROR_RETURN_IF(Frequency < 1, FPolyhedronMeshSize(), "Cannot subdivide with a frequency < 1");
+
+  // Same counts as Subdivide(), in 64 bits. Past 2^15, they could overflow even for the polygon counts of int32 indices.
+  const int64 N = FMath::Min(Frequency, 1 << 15);
+  int64 InteriorVertexCount = (N - 1) * (N - 2) / 2;
+  FPolyhedronMeshSize Output;
+  Output.VertexCount = Input.VertexCount + Input.EdgeCount * (N - 1);
+  int64 CenterCount = 0, TriangleCornerCount = 0, FanCornerCount = 0;
+  for (const TPair<int32, int64>& SideCount : Input.PolygonSideCounts) {
+    int64 PolygonVertexCount = SideCount.Key;
+    if (PolygonVertexCount == 3) {
+      Output.VertexCount += SideCount.Value * InteriorVertexCount;
+      Output.PolygonCount += SideCount.Value * N * N;
+      TriangleCornerCount += SideCount.Value * 3;
+      continue;
     }
+    Output.VertexCount += SideCount.Value * (1 + PolygonVertexCount * (N - 1 + InteriorVertexCount));
+    Output.PolygonCount += SideCount.Value * PolygonVertexCount * N * N;
+    FanCornerCount += SideCount.Value * PolygonVertexCount;
+    // The center of the fan keeps one triangle per side.
+    CenterCount += SideCount.Value;
+    Output.VertexDegreeCounts.FindOrAdd(SideCount.Key) += SideCount.Value;
+  }
+  Output.PolygonSideCounts.Add(3, Output.PolygonCount);
+  Output.EdgeCount = CountEdges(Output.PolygonSideCounts);
+
+  // Every other new point lies within the triangular grid, with six triangles around it. An input vertex keeps one
+  // triangle per triangle around it, and two per fan around it; only the overall share of the fan corners is known.
+  Output.VertexDegreeCounts.FindOrAdd(6) += Output.VertexCount - Input.VertexCount - CenterCount;
+  double FanCornerShare = TriangleCornerCount + FanCornerCount > 0 ? static_cast<double>(FanCornerCount) / static_cast<double>(TriangleCornerCount + FanCornerCount) : 0.0;
+  for (const TPair<int32, int64>& DegreeCount : Input.VertexDegreeCounts) {
+    Output.VertexDegreeCounts.FindOrAdd(DegreeCount.Key + FMath::RoundToInt32(DegreeCount.Key * FanCornerShare)) += DegreeCount.Value;
+  }
+  Output.PeakMemorySize = FMath::Max(Input.PeakMemorySize, PredictOperationMemorySize(Input, Output));
+  return Output;
+}
 
-    Output.Polygons.Add(OutputPolygon);
+FPolyhedronMeshSize FPolyhedronOperations::PredictOperation(const FPolyhedronMeshSize& Input, TCHAR Symbol, int32 Argument) {
+  // The same primitive operations as ApplyConwayPolyhedronNotationStep(), in the same order.
+  TArray<const FPolyhedronLocalOperator*, TInlineAllocator<6>> Operators;
+  switch (Symbol) {
+  case 'a': Operators = { &GetAmboOperator() }; break;
+  case 'b': Operators = { &GetAmboOperator(), &GetDualOperator(), &GetKisOperator(), &GetDualOperator() }; break;
+  case 'c': Operators = { &GetChamferOperator() }; break;
+  case 'd': Operators = { &GetDualOperator() }; break;
+  case 'e': Operators = { &GetAmboOperator(), &GetAmboOperator() }; break;
+  case 'g': Operators = { &GetGyroOperator() }; break;
+  case 'j': Operators = { &GetDualOperator(), &GetAmboOperator(), &GetDualOperator() }; break;
+  case 'k': Operators = { &GetKisOperator() }; break;
+  case 'l': Operators = { &GetLoftOperator() }; break;
+  case 'm': Operators = { &GetDualOperator(), &GetAmboOperator(), &GetDualOperator(), &GetKisOperator() }; break;
+  case 'n': Operators = { &GetDualOperator(), &GetKisOperator() }; break;
+  case 'o': Operators = { &GetDualOperator(), &GetAmboOperator(), &GetDualOperator(), &GetDualOperator(), &GetAmboOperator(), &GetDualOperator() }; break;
+  case 'p': Operators = { &GetPropellerOperator() }; break;
+  case 'q': Operators = { &GetQuintoOperator() }; break;
+  case 'r': Operators = { &GetReflectOperator() }; break;
+  case 's': Operators = { &GetDualOperator(), &GetGyroOperator(), &GetDualOperator() }; break;
+  case 't': Operators = { &GetDualOperator(), &GetKisOperator(), &GetDualOperator() }; break;
+  case 'w': Operators = { &GetWhirlOperator() }; break;
+  case 'u': return PredictSubdivide(Input, Argument > 0 ? Argument : 2);
+  // Canonicalization only moves the vertices.
+  case 'K': return Input;
+  default: REPORT_ERROR("Unknown Conway Notation Symbol: %c", Symbol); return FPolyhedronMeshSize();
   }
 
+  FPolyhedronMeshSize Output = Input;
+  for (const FPolyhedronLocalOperator* Operator : Operators) {
+    Output = PredictLocalOperator(Output, *Operator);
+  }
   return Output;
 }
 
-FPolyhedronMesh FPolyhedronOperations::Dual(const FPolyhedronMesh& Input) {
+TBitArray<> FPolyhedronOperations::MakePolygonMask(const FPolyhedronMesh& Input, TFunctionRef<bool(int32 PolygonIndex)> Predicate) {
+  TBitArray<> PolygonMask(false, Input.Polygons.Num());
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+    PolygonMask[PolygonIndex] = Predicate(PolygonIndex);
+  }
+  return PolygonMask;
+}
+
+FPolyhedronMesh FPolyhedronOperations::Dual(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
   // Dual
   // ------------------------------------------------------------------------------------------------
   // The dual of a polyhedron is another mesh wherein:
@@ -93,120 +677,53 @@ FPolyhedronMesh FPolyhedronOperations::Dual(const FPolyhedronMesh& Input) {
   //
   // The new vertex coordinates are convenient to set to the original face centroids.
   //
-  FPolyhedronMesh Output;
-  int32 InputPolygonCount = Input.Polygons.Num(), OutputVertexCount = InputPolygonCount; // Input Polygon Count -> Output Vertex Count.
-  int32 InputVertexCount = Input.Vertices.Num(), OutputPolygonCount = InputVertexCount; // Input Vertex Count -> Output Polygon Count.
-  Output.Vertices.SetNum(OutputVertexCount);
-  Output.Polygons.SetNum(OutputPolygonCount);
-
-  // Compute the polygon centers: these become the vertices of the new mesh.
-  for (int32 InputPolygonIndex = 0; InputPolygonIndex < InputPolygonCount; ++InputPolygonIndex) {
-    FVector PolygonCenter = FPolyhedronTools::GetPolygonCenter(Input, Input.Polygons[InputPolygonIndex]);
-    Output.Vertices[InputPolygonIndex] = PolygonCenter;
-  }
-
-  // Reverse the Extended Mesh' adjacency information to create Output edges.
-  FPolyhedronExtendedMesh ExtendedInput = FPolyhedronTools::ComputeEdgeDetails(Input);
-  int32 HalfEdgeCount = ExtendedInput.PolygonHalfEdges.Num();
-
-  // Process the output edges into output polygons with preserved winding.
-  for (int32 OutputPolygonIndex = 0; OutputPolygonIndex < OutputPolygonCount; ++OutputPolygonIndex) {
-    int32 InputVertexIndex = OutputPolygonIndex;
-    int32 VertexIteratorStart = ExtendedInput.VertexHalfEdgeOffsets[InputVertexIndex];
-    int32 VertexIteratorEnd = ExtendedInput.VertexHalfEdgeOffsets[InputVertexIndex + 1];
-    int32 InputVertexPolygonCount = VertexIteratorEnd - VertexIteratorStart;
-    int32 OutputPolygonVertexCount = InputVertexPolygonCount;
-
-    Output.Polygons[OutputPolygonIndex].VertexIndices.Reserve(OutputPolygonVertexCount);
-
-    // We can start with any of the half-edges.
-    FPolyhedronDirectedHalfEdge& FirstHalfEdge = ExtendedInput.PolygonHalfEdges[ExtendedInput.VertexHalfEdgeIndices[VertexIteratorStart].Get<1>()];
-    int32 OutputVertex1 = FirstHalfEdge.PolygonIndexAcross;
-    int32 OutputVertex2 = FirstHalfEdge.PolygonIndex;
-    Output.Polygons[OutputPolygonIndex].VertexIndices.Add(OutputVertex1);
-    Output.Polygons[OutputPolygonIndex].VertexIndices.Add(OutputVertex2);
-
-    // Loop over the other half-edges, looking for the next vertex.
-    bool bLoopCompleted = false;
-    for (int32 Iterator = VertexIteratorStart + 1; Iterator < VertexIteratorEnd; ++Iterator) {
-      int32 NextVertexIndex = -1;
-      for (int32 EdgeIndex = 1; EdgeIndex < OutputPolygonVertexCount; ++EdgeIndex) {
-        FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[ExtendedInput.VertexHalfEdgeIndices[VertexIteratorStart + EdgeIndex].Get<1>()];
-        if (HalfEdge.PolygonIndexAcross == OutputVertex2) {
-          NextVertexIndex = HalfEdge.PolygonIndex;
-          break;
-        }
-      }
-      check(NextVertexIndex != -1);
-      if (NextVertexIndex == OutputVertex1) {
-        bLoopCompleted = true;
-        break;
-      }
-      Output.Polygons[OutputPolygonIndex].VertexIndices.Add(NextVertexIndex);
-      OutputVertex2 = NextVertexIndex;
-    }
-    // If this check hits, your mesh is not manifold.
-    check(bLoopCompleted);
-  }
+  return ApplyLocalOperator(Input, GetDualOperator(), FPolyhedronOperationParameters(), Recorder);
+}
 
-  return Output;
+FPolyhedronMesh FPolyhedronOperations::Reflect(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
+  return ApplyLocalOperator(Input, GetReflectOperator(), FPolyhedronOperationParameters(), Recorder);
 }
 
-FPolyhedronMesh FPolyhedronOperations::Ambo(const FPolyhedronMesh& Input) {
+FPolyhedronMesh FPolyhedronOperations::Ambo(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
   // Ambo
   // ------------------------------------------------------------------------------------------
   // The best way to think of the ambo operator is as a topological "tween" between a polyhedron
   // and its dual polyhedron.  Thus the ambo of a dual polyhedron is the same as the ambo of the
   // original. Also called "Rectify".
   //
-  FPolyhedronOperationFlagHelper PolyFlag;
-
-  int32 VertexCount = Input.Vertices.Num();
-  int32 DualPolygonOffset = Input.Polygons.Num();
-  auto CalculateMidId = [=] (int32 Vertex1, int32 Vertex2) -> int64 {
-    return Vertex1 < Vertex2 ? (static_cast<int64>(Vertex1) * static_cast<int64>(VertexCount) + static_cast<int64>(Vertex2)) : (static_cast<int64>(Vertex2) * static_cast<int64>(VertexCount) + static_cast<int64>(Vertex1));
-  };
-
-  // For each face f in the original poly
-  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
-    const FPolyhedronPolygon& Polygon = Input.Polygons[PolygonIndex];
-    int32 PolygonVertexCount = Polygon.VertexIndices.Num();
-    if (PolygonVertexCount < 3) continue;
-    int32 Vertex1 = Polygon.VertexIndices[PolygonVertexCount - 2];
-    int32 Vertex2 = Polygon.VertexIndices[PolygonVertexCount - 1];
-    for (int32 Vertex3 : Polygon.VertexIndices) {
-      if (Vertex1 < Vertex2) {
-        FVector MidPosition = (Input.Vertices[Vertex1] + Input.Vertices[Vertex2]) / 2.0;
-        PolyFlag.AddWorkVertex(CalculateMidId(Vertex1, Vertex2), MidPosition);
-      }
-      // Add two new flags: one whose face corresponds to the original face
-      // and another face that corresponds to (the truncated) v2
-      PolyFlag.AddWorkFlag(PolygonIndex, CalculateMidId(Vertex1, Vertex2), CalculateMidId(Vertex2, Vertex3));
-      PolyFlag.AddWorkFlag(DualPolygonOffset + Vertex2, CalculateMidId(Vertex2, Vertex3), CalculateMidId(Vertex1, Vertex2));
-      // Advance to the next edge pair.
-      Vertex1 = Vertex2;
-      Vertex2 = Vertex3;
-    }
-  }
-
-  return PolyFlag.ConvertWorkBuffers();
+  return ApplyLocalOperator(Input, GetAmboOperator(), FPolyhedronOperationParameters(), Recorder);
 }
 
-FPolyhedronMesh FPolyhedronOperations::Join(const FPolyhedronMesh& Input) {
+FPolyhedronMesh FPolyhedronOperations::Join(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
   // Leverage the Ambo operation in dual-space.
-  FPolyhedronMesh Polyhedron1 = Dual(Input);
-  FPolyhedronMesh Polyhedron2 = Ambo(Polyhedron1);
-  return Dual(Polyhedron2);
+  FPolyhedronMesh Polyhedron1 = Dual(Input, Recorder);
+  FPolyhedronMesh Polyhedron2 = Ambo(Polyhedron1, Recorder);
+  return Dual(Polyhedron2, Recorder);
 }
 
 
-FPolyhedronMesh FPolyhedronOperations::Kis(const FPolyhedronMesh& Input, int32 SideFilter, double ApexOffset) {
+FPolyhedronMesh FPolyhedronOperations::Kis(const FPolyhedronMesh& Input, int32 SideFilter, double ApexOffset, FPolyhedronOperationRecorder* Recorder) {
   // Kis(N)
   // ------------------------------------------------------------------------------------------
   // Kis (abbreviated from triakis) transforms an N-sided face into an N-pyramid rooted at the
   // same base vertices.
   // only kis n-sided faces, but n==0 means kis all.
   //
+  if (SideFilter == 0) {
+    FPolyhedronOperationParameters Parameters;
+    Parameters.KisApexOffset = ApexOffset;
+    return ApplyLocalOperator(Input, GetKisOperator(), Parameters, Recorder);
+  }
+
+  TBitArray<> PolygonMask(false, Input.Polygons.Num());
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+    PolygonMask[PolygonIndex] = Input.Polygons[PolygonIndex].VertexIndices.Num() == SideFilter;
+  }
+  return Kis(Input, PolygonMask, ApexOffset, Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Kis(const FPolyhedronMesh& Input, const TBitArray<>& PolygonMask, double ApexOffset, FPolyhedronOperationRecorder* Recorder) {
+  REPORT_ERROR_RETURN_IF(PolygonMask.Num() != Input.Polygons.Num(), FPolyhedronMesh(), "PolygonMask has %d bits for %d polygons", PolygonMask.Num(), Input.Polygons.Num());
 
   // Calculate the apex and added polygon counts.
   int32 InputVertexCount = Input.Vertices.Num();
@@ -215,7 +732,7 @@ FPolyhedronMesh FPolyhedronOperations::Kis(const FPolyhedronMesh& Input, int32 S
   int32 OutputPolygonTotal = 0;
   for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
     const FPolyhedronPolygon& Polygon = Input.Polygons[PolygonIndex];
-    if (SideFilter == 0 || SideFilter == Polygon.VertexIndices.Num()) {
+    if (PolygonMask[PolygonIndex]) {
       ++ApexCount;
       OutputPolygonTotal += Polygon.VertexIndices.Num();
     } else {
@@ -231,58 +748,195 @@ FPolyhedronMesh FPolyhedronOperations::Kis(const FPolyhedronMesh& Input, int32 S
   for (int32 InputVertexIndex = 0; InputVertexIndex < Input.Vertices.Num(); ++InputVertexIndex) {
     Output.Vertices[InputVertexIndex] = Input.Vertices[InputVertexIndex];
   }
+  FPolyhedronOperationStage* Stage = Recorder != nullptr ? &Recorder->AddStage(Input, true) : nullptr;
+  bool bRecordProvenance = Stage != nullptr && Recorder->bRecordProvenance;
+  if (Stage != nullptr) {
+    for (int32 InputVertexIndex = 0; InputVertexIndex < Input.Vertices.Num(); ++InputVertexIndex) {
+      Stage->AddVertex(MakeVertexRecipe(InputVertexIndex));
+    }
+  }
+  if (bRecordProvenance) {
+    // The first polygon around each vertex, found from the last polygon back.
+    Stage->VertexSources.SetNumUninitialized(InputVertexCount + ApexCount);
+    for (int32 InputVertexIndex = 0; InputVertexIndex < InputVertexCount; ++InputVertexIndex) {
+      Stage->VertexSources[InputVertexIndex] = { EElement::Vertex, InputVertexIndex, INDEX_NONE };
+    }
+    for (int32 PolygonIndex = Input.Polygons.Num() - 1; PolygonIndex >= 0; --PolygonIndex) {
+      for (int32 VertexIndex : Input.Polygons[PolygonIndex].VertexIndices) {
+        Stage->VertexSources[VertexIndex].PolygonIndex = PolygonIndex;
+      }
+    }
+    Stage->PolygonSources.Reserve(OutputPolygonTotal);
+  }
 
   int32 NextApexId = ApexStartId;
   int32 NextPolygonId = 0;
+  int32 HalfEdgeOffset = 0;
   for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
     const FPolyhedronPolygon& Polygon = Input.Polygons[PolygonIndex];
-    if (SideFilter == 0 || SideFilter == Polygon.VertexIndices.Num()) {
+    int32 PolygonHalfEdgeOffset = HalfEdgeOffset; // The half-edges are numbered polygon by polygon.
+    HalfEdgeOffset += Polygon.VertexIndices.Num();
+    if (PolygonMask[PolygonIndex]) {
 
       Output.Vertices[NextApexId] = FPolyhedronTools::GetPolygonCenter(Input, Polygon) + ApexOffset * FPolyhedronTools::GetPolygonNormal(Input, Polygon);
+      if (Stage != nullptr) {
+        FPolyhedronVertexRecipe Recipe = MakePolygonCenterRecipe(Polygon);
+        Recipe.Parameter = EPolyhedronOperationParameter::KisApexOffset;
+        Recipe.NormalPolygonIndex = PolygonIndex;
+        Recipe.NormalFactor = 1.0;
+        Stage->AddVertex(Recipe);
+      }
+      if (bRecordProvenance) {
+        Stage->VertexSources[NextApexId] = MakePolygonSource(PolygonIndex);
+      }
 
+      // Each triangle stands on one half-edge of the polygon.
       int64 Vertex1 = Polygon.VertexIndices.Last(); // Start with the last vertex.
-      for (int32 VertexIndex : Polygon.VertexIndices) {
-        int64 Vertex2 = VertexIndex;
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < Polygon.VertexIndices.Num(); ++PolygonVertexIndex) {
+        int64 Vertex2 = Polygon.VertexIndices[PolygonVertexIndex];
+        if (bRecordProvenance) {
+          Stage->PolygonSources.Add({ EElement::HalfEdge, PolygonHalfEdgeOffset + PolygonVertexIndex, PolygonIndex });
+        }
 
         Output.Polygons[NextPolygonId].VertexIndices.Add(Vertex1);
         Output.Polygons[NextPolygonId].VertexIndices.Add(Vertex2);
         Output.Polygons[NextPolygonId].VertexIndices.Add(NextApexId);
+        Output.Polygons[NextPolygonId].MaterialIndex = Polygon.MaterialIndex;
         ++NextPolygonId;
         Vertex1 = Vertex2;
       }
       ++NextApexId;
 
     } else {
-      Output.Polygons[NextPolygonId].VertexIndices = Polygon.VertexIndices;
+      Output.Polygons[NextPolygonId] = Polygon;
       ++NextPolygonId;
+      if (bRecordProvenance) {
+        Stage->PolygonSources.Add(MakePolygonSource(PolygonIndex));
+      }
     }
   }
 
   return Output;
 }
 
-FPolyhedronMesh FPolyhedronOperations::Needle(const FPolyhedronMesh& Input) {
+FPolyhedronMesh FPolyhedronOperations::Needle(const FPolyhedronMesh& Input, double ApexOffset, FPolyhedronOperationRecorder* Recorder) {
   // Leverage the Kis operation.
-  FPolyhedronMesh Polyhedron1 = Dual(Input);
-  return Kis(Polyhedron1, 0, 0.1);
+  FPolyhedronMesh Polyhedron1 = Dual(Input, Recorder);
+  return Kis(Polyhedron1, 0, ApexOffset, Recorder);
 }
 
-FPolyhedronMesh FPolyhedronOperations::Zip(const FPolyhedronMesh& Input) {
+FPolyhedronMesh FPolyhedronOperations::Zip(const FPolyhedronMesh& Input, double ApexOffset, FPolyhedronOperationRecorder* Recorder) {
   // Leverage the Kis operation.
-  FPolyhedronMesh Polyhedron1 = Kis(Input, 0, 0.1);
-  return Dual(Polyhedron1);
+  FPolyhedronMesh Polyhedron1 = Kis(Input, 0, ApexOffset, Recorder);
+  return Dual(Polyhedron1, Recorder);
 }
 
-FPolyhedronMesh FPolyhedronOperations::Truncate(const FPolyhedronMesh& Input) {
+FPolyhedronMesh FPolyhedronOperations::Truncate(const FPolyhedronMesh& Input, double ApexOffset, FPolyhedronOperationRecorder* Recorder) {
   // Leverage the Kis operation.
-  FPolyhedronMesh Polyhedron1 = Dual(Input);
-  FPolyhedronMesh Polyhedron2 = Kis(Polyhedron1, 0, 0.1);
-  FPolyhedronMesh Polyhedron3 = Dual(Polyhedron2);
+  FPolyhedronMesh Polyhedron1 = Dual(Input, Recorder);
+  FPolyhedronMesh Polyhedron2 = Kis(Polyhedron1, 0, ApexOffset, Recorder);
+  FPolyhedronMesh Polyhedron3 = Dual(Polyhedron2, Recorder);
 
   return Polyhedron3;
 }
 
-FPolyhedronMesh FPolyhedronOperations::Chamfer(const FPolyhedronMesh& Input, double Offset) {
+FPolyhedronMesh FPolyhedronOperations::Truncate(const FPolyhedronMesh& Input, const TBitArray<>& PolygonMask, FPolyhedronOperationRecorder* Recorder) {
+  // Truncate(Mask)
+  // ------------------------------------------------------------------------------------------
+  // The dual-kis-dual of Truncate() moves every vertex of the polyhedron; this one cuts the corners of the
+  // masked polygons directly. Each cut corner becomes a polygon, and every polygon around it loses that corner.
+  //
+  REPORT_ERROR_RETURN_IF(PolygonMask.Num() != Input.Polygons.Num(), FPolyhedronMesh(), "PolygonMask has %d bits for %d polygons", PolygonMask.Num(), Input.Polygons.Num());
+  constexpr double CutFraction = 1.0 / 3.0;
+
+  FPolyhedronExtendedMesh ExtendedInput = FPolyhedronTools::ComputeEdgeDetails(Input);
+  int32 InputVertexCount = Input.Vertices.Num();
+  int32 HalfEdgeCount = ExtendedInput.PolygonHalfEdges.Num();
+  TBitArray<> CutVertices(false, InputVertexCount);
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+    if (!PolygonMask[PolygonIndex]) continue;
+    for (int32 VertexIndex : Input.Polygons[PolygonIndex].VertexIndices) {
+      CutVertices[VertexIndex] = true;
+    }
+  }
+
+  // The vertices that are kept come first, then one cut point for each half-edge that leaves a cut vertex.
+  FPolyhedronMesh Output;
+  FPolyhedronOperationStage* Stage = Recorder != nullptr ? &Recorder->AddStage(Input, false) : nullptr;
+  bool bRecordProvenance = Stage != nullptr && Recorder->bRecordProvenance;
+  TArray<int32> OutputVertexIndices, CutVertexIndices;
+  OutputVertexIndices.Init(INDEX_NONE, InputVertexCount);
+  CutVertexIndices.Init(INDEX_NONE, HalfEdgeCount);
+  for (int32 VertexIndex = 0; VertexIndex < InputVertexCount; ++VertexIndex) {
+    if (CutVertices[VertexIndex]) continue;
+    OutputVertexIndices[VertexIndex] = Output.Vertices.Add(Input.Vertices[VertexIndex]);
+    if (Stage != nullptr) {
+      Stage->AddVertex(MakeVertexRecipe(VertexIndex));
+    }
+    if (bRecordProvenance) {
+      Stage->VertexSources.Add(MakeVertexSource(ExtendedInput, VertexIndex));
+    }
+  }
+  for (int32 HalfEdgeIndex = 0; HalfEdgeIndex < HalfEdgeCount; ++HalfEdgeIndex) {
+    const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex];
+    if (!CutVertices[HalfEdge.VertexIndexFrom]) continue;
+    CutVertexIndices[HalfEdgeIndex] = Output.Vertices.Add((1.0 - CutFraction) * Input.Vertices[HalfEdge.VertexIndexFrom] + CutFraction * Input.Vertices[HalfEdge.VertexIndexTo]);
+    if (Stage != nullptr) {
+      FPolyhedronVertexRecipe Recipe;
+      Recipe.Terms.Add({ HalfEdge.VertexIndexFrom, 1.0 - CutFraction });
+      Recipe.Terms.Add({ HalfEdge.VertexIndexTo, CutFraction });
+      Stage->AddVertex(Recipe);
+    }
+    if (bRecordProvenance) {
+      Stage->VertexSources.Add(MakeHalfEdgeSource(ExtendedInput, HalfEdgeIndex));
+    }
+  }
+
+  // Each polygon replaces its cut corners with the two cut points on its sides: half-edge k goes from vertex k - 1 to vertex k.
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+    const FPolyhedronPolygon& Polygon = Input.Polygons[PolygonIndex];
+    int32 PolygonHalfEdgeOffset = ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex];
+    int32 PolygonVertexCount = Polygon.VertexIndices.Num();
+    FPolyhedronPolygon& OutputPolygon = Output.Polygons.AddDefaulted_GetRef();
+    OutputPolygon.MaterialIndex = Polygon.MaterialIndex;
+    if (bRecordProvenance) {
+      Stage->PolygonSources.Add(MakePolygonSource(PolygonIndex));
+    }
+    for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+      int32 VertexIndex = Polygon.VertexIndices[PolygonVertexIndex];
+      if (!CutVertices[VertexIndex]) {
+        OutputPolygon.VertexIndices.Add(OutputVertexIndices[VertexIndex]);
+        continue;
+      }
+      int32 IncomingHalfEdgeIndex = PolygonHalfEdgeOffset + PolygonVertexIndex;
+      int32 OutgoingHalfEdgeIndex = PolygonHalfEdgeOffset + (PolygonVertexIndex + 1) % PolygonVertexCount;
+      OutputPolygon.VertexIndices.Add(CutVertexIndices[GetTwinHalfEdgeIndex(ExtendedInput, IncomingHalfEdgeIndex)]);
+      OutputPolygon.VertexIndices.Add(CutVertexIndices[OutgoingHalfEdgeIndex]);
+    }
+  }
+
+  // Each cut corner turns around its vertex, in the same order as the polygons of Dual().
+  for (int32 VertexIndex = 0; VertexIndex < InputVertexCount; ++VertexIndex) {
+    if (!CutVertices[VertexIndex]) continue;
+    int32 VertexHalfEdgeOffset = ExtendedInput.VertexHalfEdgeOffsets[VertexIndex];
+    int32 VertexHalfEdgeCount = ExtendedInput.VertexHalfEdgeOffsets[VertexIndex + 1] - VertexHalfEdgeOffset;
+    FPolyhedronPolygon& OutputPolygon = Output.Polygons.AddDefaulted_GetRef();
+    if (bRecordProvenance) {
+      Stage->PolygonSources.Add(MakeVertexSource(ExtendedInput, VertexIndex));
+    }
+    int32 FirstHalfEdgeIndex = ExtendedInput.VertexHalfEdgeIndices[VertexHalfEdgeOffset].Get<1>();
+    int32 HalfEdgeIndex = FirstHalfEdgeIndex;
+    for (int32 VertexHalfEdgeIndex = 0; VertexHalfEdgeIndex < VertexHalfEdgeCount; ++VertexHalfEdgeIndex) {
+      OutputPolygon.VertexIndices.Add(CutVertexIndices[HalfEdgeIndex]);
+      HalfEdgeIndex = GetTwinHalfEdgeIndex(ExtendedInput, GetPreviousHalfEdgeIndex(ExtendedInput, HalfEdgeIndex));
+    }
+    check(HalfEdgeIndex == FirstHalfEdgeIndex); // your mesh is not manifold if this check triggers.
+  }
+
+  return Output;
+}
+
+FPolyhedronMesh FPolyhedronOperations::Chamfer(const FPolyhedronMesh& Input, double Offset, FPolyhedronOperationRecorder* Recorder) {
   // Chamfer
   // ----------------------------------------------------------------------------------------
   // A truncation along a polyhedron's edges.
@@ -294,65 +948,124 @@ FPolyhedronMesh FPolyhedronOperations::Chamfer(const FPolyhedronMesh& Input, dou
   // See also http://dmccooey.com/polyhedra/Chamfer.html
   //
 
-  FPolyhedronOperationFlagHelper PolyFlag;
-
-  // For each face f in the original poly
-  int32 InputVertexCount = Input.Vertices.Num();
-  int32 InputPolygonCount = Input.Polygons.Num();
+  FPolyhedronOperationParameters Parameters;
+  Parameters.ChamferOffset = Offset;
+  return ApplyLocalOperator(Input, GetChamferOperator(), Parameters, Recorder);
+}
 
-  auto CalculateChamferedFaceId = [=] (int64 Vertex1, int64 Vertex2) -> int64 {
-    return static_cast<int64>(InputPolygonCount) + (
-      (Vertex1 < Vertex2) ?
-      (Vertex1 * static_cast<int64>(InputVertexCount) + Vertex2) :
-      (Vertex2 * static_cast<int64>(InputVertexCount) + Vertex1)
-    );
-  };
+FPolyhedronMesh FPolyhedronOperations::Chamfer(const FPolyhedronMesh& Input, const TBitArray<>& PolygonMask, double Offset, FPolyhedronOperationRecorder* Recorder) {
+  // Chamfer(Mask)
+  // ------------------------------------------------------------------------------------------
+  // Same vertices and faces as the Chamfer table, where an unmasked polygon keeps its own vertices instead of
+  // pushing copies out along its normal. Its side of the edge hexagons collapses: they become quadrilaterals towards
+  // the masked polygons, and disappear between two unmasked ones. Only the vertices inside the mask move out.
+  //
+  REPORT_ERROR_RETURN_IF(PolygonMask.Num() != Input.Polygons.Num(), FPolyhedronMesh(), "PolygonMask has %d bits for %d polygons", PolygonMask.Num(), Input.Polygons.Num());
 
-  for (int32 PolygonIndex = 0; PolygonIndex < InputPolygonCount; ++PolygonIndex) {
-    const FPolyhedronPolygon& Polygon = Input.Polygons[PolygonIndex];
-    if (Polygon.VertexIndices.Num() < 3) continue;
+  FPolyhedronExtendedMesh ExtendedInput = FPolyhedronTools::ComputeEdgeDetails(Input);
+  int32 InputVertexCount = Input.Vertices.Num();
+  int32 HalfEdgeCount = ExtendedInput.PolygonHalfEdges.Num();
+  TBitArray<> MovedVertices(true, InputVertexCount);
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+    if (PolygonMask[PolygonIndex]) continue;
+    for (int32 VertexIndex : Input.Polygons[PolygonIndex].VertexIndices) {
+      MovedVertices[VertexIndex] = false;
+    }
+  }
 
-    FVector PolygonNormal = FPolyhedronTools::GetPolygonNormal(Input, Polygon);
+  // The input vertices come first, then the copy of the end of each half-edge of the masked polygons.
+  FPolyhedronMesh Output;
+  FPolyhedronOperationStage* Stage = Recorder != nullptr ? &Recorder->AddStage(Input, true) : nullptr;
+  bool bRecordProvenance = Stage != nullptr && Recorder->bRecordProvenance;
+  Output.Vertices.Reserve(InputVertexCount + HalfEdgeCount);
+  for (int32 VertexIndex = 0; VertexIndex < InputVertexCount; ++VertexIndex) {
+    bool bMoved = MovedVertices[VertexIndex];
+    Output.Vertices.Add(Input.Vertices[VertexIndex] * (bMoved ? 1.0 + Offset : 1.0));
+    if (Stage != nullptr) {
+      FPolyhedronVertexRecipe Recipe = MakeVertexRecipe(VertexIndex);
+      Recipe.Parameter = bMoved ? EPolyhedronOperationParameter::ChamferOffset : EPolyhedronOperationParameter::None;
+      Recipe.RadialFactor = bMoved ? 1.0 : 0.0;
+      Stage->AddVertex(Recipe);
+    }
+    if (bRecordProvenance) {
+      Stage->VertexSources.Add(MakeVertexSource(ExtendedInput, VertexIndex));
+    }
+  }
+  TArray<int32> InsetVertexIndices;
+  InsetVertexIndices.Init(INDEX_NONE, HalfEdgeCount);
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+    if (!PolygonMask[PolygonIndex]) continue;
+    FVector Normal = FPolyhedronTools::GetPolygonNormal(Input, Input.Polygons[PolygonIndex]);
+    for (int32 HalfEdgeIndex = ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex]; HalfEdgeIndex < ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex + 1]; ++HalfEdgeIndex) {
+      int32 VertexIndex = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex].VertexIndexTo;
+      InsetVertexIndices[HalfEdgeIndex] = Output.Vertices.Add(Input.Vertices[VertexIndex] + 1.5 * Offset * Normal);
+      if (Stage != nullptr) {
+        FPolyhedronVertexRecipe Recipe = MakeVertexRecipe(VertexIndex);
+        Recipe.Parameter = EPolyhedronOperationParameter::ChamferOffset;
+        Recipe.NormalPolygonIndex = PolygonIndex;
+        Recipe.NormalFactor = 1.5;
+        Stage->AddVertex(Recipe);
+      }
+      if (bRecordProvenance) {
+        Stage->VertexSources.Add(MakeHalfEdgeSource(ExtendedInput, HalfEdgeIndex));
+      }
+    }
+  }
 
-    int32 Vertex1 = Polygon.VertexIndices.Last();
-    int32 Vertex1New = InputVertexCount + (PolygonIndex * InputVertexCount + Vertex1);
+  // The polygons, pushed out or kept.
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+    if (bRecordProvenance) {
+      Stage->PolygonSources.Add(MakePolygonSource(PolygonIndex));
+    }
+    if (!PolygonMask[PolygonIndex]) {
+      Output.Polygons.Add(Input.Polygons[PolygonIndex]);
+      continue;
+    }
+    FPolyhedronPolygon& OutputPolygon = Output.Polygons.AddDefaulted_GetRef();
+    OutputPolygon.MaterialIndex = Input.Polygons[PolygonIndex].MaterialIndex;
+    for (int32 HalfEdgeIndex = ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex]; HalfEdgeIndex < ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex + 1]; ++HalfEdgeIndex) {
+      OutputPolygon.VertexIndices.Add(InsetVertexIndices[HalfEdgeIndex]);
+    }
+  }
 
-    for (int32 Vertex2 : Polygon.VertexIndices) {
-      // Add the original vertex, scaled by the offset slightly (why?)
-      PolyFlag.AddWorkVertex(Vertex2, (1.0 + Offset) * Input.Vertices[Vertex2]); // will produce duplicates.
-      int32 Vertex2New = InputVertexCount + (PolygonIndex * InputVertexCount + Vertex2);
-      PolyFlag.AddWorkVertex(Vertex2New, Input.Vertices[Vertex2] + 1.5 * Offset * PolygonNormal); // magic!
-      
-      // One whose face corresponds to the original face:
-      PolyFlag.AddWorkFlag(PolygonIndex, Vertex1New, Vertex2New);
-      // And three for the edges of the new hexagon:
-      int64 ChamferedFaceId = CalculateChamferedFaceId(Vertex1, Vertex2);
-      PolyFlag.AddWorkFlag(ChamferedFaceId, Vertex2, Vertex2New);
-      PolyFlag.AddWorkFlag(ChamferedFaceId, Vertex2New, Vertex1New);
-      PolyFlag.AddWorkFlag(ChamferedFaceId, Vertex1New, Vertex1);
+  // The edge faces: each side walks from the end of its half-edge back to its start, through the copies of the masked polygon.
+  for (int32 HalfEdgeIndex = 0; HalfEdgeIndex < HalfEdgeCount; ++HalfEdgeIndex) {
+    const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex];
+    if (HalfEdge.VertexIndexFrom > HalfEdge.VertexIndexTo) continue;
+    int32 TwinHalfEdgeIndex = GetTwinHalfEdgeIndex(ExtendedInput, HalfEdgeIndex);
+    if (!PolygonMask[HalfEdge.PolygonIndex] && !PolygonMask[HalfEdge.PolygonIndexAcross]) continue;
 
-      Vertex1 = Vertex2;
-      Vertex1New = Vertex2New;
+    FPolyhedronPolygon& OutputPolygon = Output.Polygons.AddDefaulted_GetRef();
+    if (bRecordProvenance) {
+      Stage->PolygonSources.Add(MakeHalfEdgeSource(ExtendedInput, HalfEdgeIndex, EElement::Edge));
+    }
+    for (int32 SideHalfEdgeIndex : { HalfEdgeIndex, TwinHalfEdgeIndex }) {
+      const FPolyhedronDirectedHalfEdge& SideHalfEdge = ExtendedInput.PolygonHalfEdges[SideHalfEdgeIndex];
+      OutputPolygon.VertexIndices.Add(SideHalfEdge.VertexIndexTo);
+      if (PolygonMask[SideHalfEdge.PolygonIndex]) {
+        OutputPolygon.VertexIndices.Add(InsetVertexIndices[SideHalfEdgeIndex]);
+        OutputPolygon.VertexIndices.Add(InsetVertexIndices[GetPreviousHalfEdgeIndex(ExtendedInput, SideHalfEdgeIndex)]);
+      }
     }
   }
 
-  return PolyFlag.ConvertWorkBuffers();
-};
+  return Output;
+}
 
 
-FPolyhedronMesh FPolyhedronOperations::Expand(const FPolyhedronMesh& Input) {
+FPolyhedronMesh FPolyhedronOperations::Expand(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
   // Expand is a ambo-ambo combo.
-  FPolyhedronMesh Polyhedron1 = Ambo(Input);
-  return Ambo(Polyhedron1);
+  FPolyhedronMesh Polyhedron1 = Ambo(Input, Recorder);
+  return Ambo(Polyhedron1, Recorder);
 }
 
-FPolyhedronMesh FPolyhedronOperations::Ortho(const FPolyhedronMesh& Input) {
+FPolyhedronMesh FPolyhedronOperations::Ortho(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
   // Ortho is a join-join combo.
-  FPolyhedronMesh Polyhedron1 = Join(Input);
-  return Join(Polyhedron1);
+  FPolyhedronMesh Polyhedron1 = Join(Input, Recorder);
+  return Join(Polyhedron1, Recorder);
 }
 
-FPolyhedronMesh FPolyhedronOperations::Gyro(const FPolyhedronMesh& Input) {
+FPolyhedronMesh FPolyhedronOperations::Gyro(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
   // Gyro
   // ----------------------------------------------------------------------------------------------
   // This is the dual operator to "snub", i.e dual*Gyro = Snub.  It is a bit easier to implement
@@ -361,67 +1074,322 @@ FPolyhedronMesh FPolyhedronOperations::Gyro(const FPolyhedronMesh& Input) {
   // Snub creates at each vertex a new face, expands and twists it, and adds two new triangles to
   // replace each edge.
   //
-  FPolyhedronOperationFlagHelper PolyFlag;
+  return ApplyLocalOperator(Input, GetGyroOperator(), FPolyhedronOperationParameters(), Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Snub(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
+  // Leverage the Gyro operation in dual-space.
+  FPolyhedronMesh Polyhedron1 = Dual(Input, Recorder);
+  FPolyhedronMesh Polyhedron2 = Gyro(Polyhedron1, Recorder);
+  return Dual(Polyhedron2, Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Loft(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
+  return ApplyLocalOperator(Input, GetLoftOperator(), FPolyhedronOperationParameters(), Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Propeller(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
+  return ApplyLocalOperator(Input, GetPropellerOperator(), FPolyhedronOperationParameters(), Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Meta(const FPolyhedronMesh& Input, double ApexOffset, FPolyhedronOperationRecorder* Recorder) {
+  // Meta is a join-kis combo.
+  FPolyhedronMesh Polyhedron1 = Join(Input, Recorder);
+  return Kis(Polyhedron1, 0, ApexOffset, Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Bevel(const FPolyhedronMesh& Input, double ApexOffset, FPolyhedronOperationRecorder* Recorder) {
+  // Bevel is a ambo-truncate combo.
+  FPolyhedronMesh Polyhedron1 = Ambo(Input, Recorder);
+  return Truncate(Polyhedron1, ApexOffset, Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Quinto(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
+  return ApplyLocalOperator(Input, GetQuintoOperator(), FPolyhedronOperationParameters(), Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Whirl(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder) {
+  return ApplyLocalOperator(Input, GetWhirlOperator(), FPolyhedronOperationParameters(), Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Subdivide(const FPolyhedronMesh& Input, int32 Frequency, FPolyhedronOperationRecorder* Recorder) {
+  return Subdivide(Input, TBitArray<>(true, Input.Polygons.Num()), Frequency, Recorder);
+}
+
+FPolyhedronMesh FPolyhedronOperations::Subdivide(const FPolyhedronMesh& Input, const TBitArray<>& PolygonMask, int32 Frequency, FPolyhedronOperationRecorder* Recorder) {
+  // Subdivide(N)
+  // ------------------------------------------------------------------------------------------
+  // Class I geodesic subdivision: each triangle is split into N^2 triangles along a triangular grid,
+  // and every new vertex is pushed out onto the sphere interpolated from the radii of its corners.
+  // The polygons that are not triangles are first split into a fan of triangles around their center.
+  // Outside of the mask, the polygons that share an edge with the mask become a fan through the points on that edge.
+  //
+  if (Frequency < 1) {
+    REPORT_ERROR("Cannot subdivide with a frequency < 1");
+    return FPolyhedronMesh();
+  }
+  REPORT_ERROR_RETURN_IF(PolygonMask.Num() != Input.Polygons.Num(), FPolyhedronMesh(), "PolygonMask has %d bits for %d polygons", PolygonMask.Num(), Input.Polygons.Num());
+  const int32 N = Frequency;
+  using FTerms = decltype(FPolyhedronVertexRecipe::Terms);
+
+  // Number the split edges from their half-edges: the half-edge from the lowest vertex owns the edge.
+  // An edge is split when either of its polygons is masked.
+  FPolyhedronExtendedMesh ExtendedInput = FPolyhedronTools::ComputeEdgeDetails(Input);
+  int32 HalfEdgeCount = ExtendedInput.PolygonHalfEdges.Num();
+  TArray<int32> HalfEdgeEdgeIndices;
+  HalfEdgeEdgeIndices.Init(INDEX_NONE, HalfEdgeCount);
+  int32 EdgeCount = 0;
+  for (int32 HalfEdgeIndex = 0; HalfEdgeIndex < HalfEdgeCount; ++HalfEdgeIndex) {
+    const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex];
+    if (HalfEdge.VertexIndexFrom < HalfEdge.VertexIndexTo && (PolygonMask[HalfEdge.PolygonIndex] || PolygonMask[HalfEdge.PolygonIndexAcross])) {
+      HalfEdgeEdgeIndices[HalfEdgeIndex] = EdgeCount++;
+    }
+  }
+  for (int32 HalfEdgeIndex = 0; HalfEdgeIndex < HalfEdgeCount; ++HalfEdgeIndex) {
+    const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex];
+    if (HalfEdge.VertexIndexFrom < HalfEdge.VertexIndexTo) continue;
+    HalfEdgeEdgeIndices[HalfEdgeIndex] = HalfEdgeEdgeIndices[GetTwinHalfEdgeIndex(ExtendedInput, HalfEdgeIndex)];
+  }
 
-  // each old vertex is a new vertex
+  // The input vertices come first, then N - 1 points along each edge, then the points added by each polygon:
+  // a triangle adds its interior points; any other polygon adds its center, N - 1 points along each spoke, and the interior points of its fan.
+  // An unmasked polygon adds its center when some of its edges are split, and nothing otherwise.
   int32 InputVertexCount = Input.Vertices.Num();
-  for (int32 VertexIndex = 0; VertexIndex < InputVertexCount; ++VertexIndex) {
-    PolyFlag.AddWorkVertex(VertexIndex, Input.Vertices[VertexIndex].GetUnsafeNormal());
+  int32 EdgeVertexOffset = InputVertexCount;
+  int32 InteriorVertexCount = (N - 1) * (N - 2) / 2;
+  int32 OutputVertexCount = EdgeVertexOffset + EdgeCount * (N - 1);
+  int32 OutputPolygonCount = 0;
+  TArray<int32> SplitEdgeCounts;
+  SplitEdgeCounts.SetNumZeroed(Input.Polygons.Num());
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+    int32 PolygonVertexCount = Input.Polygons[PolygonIndex].VertexIndices.Num();
+    if (PolygonMask[PolygonIndex]) {
+      OutputVertexCount += PolygonVertexCount == 3 ? InteriorVertexCount : 1 + PolygonVertexCount * (N - 1 + InteriorVertexCount);
+      OutputPolygonCount += PolygonVertexCount == 3 ? N * N : PolygonVertexCount * N * N;
+      continue;
+    }
+    for (int32 HalfEdgeIndex = ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex]; HalfEdgeIndex < ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex + 1]; ++HalfEdgeIndex) {
+      SplitEdgeCounts[PolygonIndex] += HalfEdgeEdgeIndices[HalfEdgeIndex] != INDEX_NONE && N > 1 ? 1 : 0;
+    }
+    OutputVertexCount += SplitEdgeCounts[PolygonIndex] > 0 ? 1 : 0;
+    OutputPolygonCount += SplitEdgeCounts[PolygonIndex] > 0 ? PolygonVertexCount + SplitEdgeCounts[PolygonIndex] * (N - 1) : 1;
   }
 
-  // new vertices in center of each face
-  int32 CenterOffset = InputVertexCount;
-  TArray<FVector> Centers = FPolyhedronTools::GetPolygonCenters(Input);
-  int32 InputPolygonCount = Centers.Num();
-  for (int32 PolygonIndex = 0; PolygonIndex < InputPolygonCount; ++PolygonIndex) {
-    PolyFlag.AddWorkVertex(CenterOffset + PolygonIndex, Centers[PolygonIndex].GetUnsafeNormal());
+  FPolyhedronMesh Output;
+  Output.Vertices.SetNum(OutputVertexCount);
+  Output.Polygons.Reserve(OutputPolygonCount);
+  FPolyhedronOperationStage* Stage = Recorder != nullptr ? &Recorder->AddStage(Input, false) : nullptr;
+  bool bRecordProvenance = Stage != nullptr && Recorder->bRecordProvenance;
+  TArray<FPolyhedronVertexRecipe> Recipes;
+  if (Stage != nullptr) {
+    Recipes.SetNum(OutputVertexCount);
   }
+  // Where the vertices and polygons that each input polygon adds start, for the provenance.
+  TArray<int32> PolygonVertexOffsets, PolygonPolygonOffsets;
+  if (bRecordProvenance) {
+    PolygonVertexOffsets.SetNumUninitialized(Input.Polygons.Num() + 1);
+    PolygonPolygonOffsets.SetNumUninitialized(Input.Polygons.Num() + 1);
+  }
+
+  // Blends the input vertices on the flat polygon, then projects the result onto the sphere interpolated from their radii.
+  auto SetVertex = [&] (int32 OutputVertexIndex, FTerms&& Terms) {
+    FVector Position = FVector::ZeroVector;
+    double Radius = 0.0;
+    for (const TPair<int32, double>& Term : Terms) {
+      Position += Term.Value * Input.Vertices[Term.Key];
+      Radius += Term.Value * Input.Vertices[Term.Key].Size();
+    }
+    Output.Vertices[OutputVertexIndex] = Position.GetSafeNormal() * Radius;
+    if (Stage != nullptr) {
+      Recipes[OutputVertexIndex].Terms = MoveTemp(Terms);
+      Recipes[OutputVertexIndex].bKeepTermRadius = true;
+    }
+  };
 
-  int32 GyroVertexOffset = CenterOffset + InputPolygonCount;
-  auto CalculateGyroVertexId = [=] (int32 Vertex1, int32 Vertex2) -> int64 {
-    return static_cast<int64>(GyroVertexOffset) + static_cast<int64>(Vertex1) * static_cast<int64>(InputVertexCount) + static_cast<int64>(Vertex2);
+  // Weighs the terms of the three corners of a triangle, merging the input vertices they share.
+  auto BlendTerms = [] (const FTerms& TermsA, double WeightA, const FTerms& TermsB, double WeightB, const FTerms& TermsC, double WeightC) -> FTerms {
+    FTerms Output;
+    auto AddTerms = [&Output] (const FTerms& Terms, double Weight) {
+      if (Weight == 0.0) return;
+      for (const TPair<int32, double>& Term : Terms) {
+        TPair<int32, double>* OutputTerm = Output.FindByPredicate([&] (const TPair<int32, double>& Other) { return Other.Key == Term.Key; });
+        if (OutputTerm != nullptr) {
+          OutputTerm->Value += Weight * Term.Value;
+        } else {
+          Output.Add({ Term.Key, Weight * Term.Value });
+        }
+      }
+    };
+    AddTerms(TermsA, WeightA);
+    AddTerms(TermsB, WeightB);
+    AddTerms(TermsC, WeightC);
+    return Output;
   };
 
-  for (int32 PolygonIndex = 0; PolygonIndex < InputPolygonCount; ++PolygonIndex) {
+  for (int32 VertexIndex = 0; VertexIndex < InputVertexCount; ++VertexIndex) {
+    SetVertex(VertexIndex, { { VertexIndex, 1.0 } });
+  }
+  for (int32 HalfEdgeIndex = 0; HalfEdgeIndex < HalfEdgeCount; ++HalfEdgeIndex) {
+    const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex];
+    if (HalfEdge.VertexIndexFrom > HalfEdge.VertexIndexTo || HalfEdgeEdgeIndices[HalfEdgeIndex] == INDEX_NONE) continue;
+    for (int32 Step = 1; Step < N; ++Step) {
+      double Alpha = static_cast<double>(Step) / static_cast<double>(N);
+      SetVertex(EdgeVertexOffset + HalfEdgeEdgeIndices[HalfEdgeIndex] * (N - 1) + Step - 1, { { HalfEdge.VertexIndexFrom, 1.0 - Alpha }, { HalfEdge.VertexIndexTo, Alpha } });
+    }
+  }
+
+  // Finds the vertex that is Step / N along a half-edge; the edge points are stored from the lowest vertex.
+  auto GetEdgeVertexIndex = [&] (int32 HalfEdgeIndex, int32 Step) -> int32 {
+    const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex];
+    if (Step == 0) return HalfEdge.VertexIndexFrom;
+    if (Step == N) return HalfEdge.VertexIndexTo;
+    int32 EdgeStep = HalfEdge.VertexIndexFrom < HalfEdge.VertexIndexTo ? Step : N - Step;
+    return EdgeVertexOffset + HalfEdgeEdgeIndices[HalfEdgeIndex] * (N - 1) + EdgeStep - 1;
+  };
+
+  // Splits the triangle (A, B, C) along its grid; each side returns its vertex Step / N along A->B, B->C and C->A.
+  // Grid point (I, J) sits at A + I/N (B - A) + J/N (C - A), and both orientations of grid triangles keep the winding of (A, B, C).
+  int32 NextVertexIndex = EdgeVertexOffset + EdgeCount * (N - 1);
+  auto SubdivideTriangle = [&] (const FTerms& TermsA, const FTerms& TermsB, const FTerms& TermsC, TFunctionRef<int32(int32)> GetSideAB, TFunctionRef<int32(int32)> GetSideBC, TFunctionRef<int32(int32)> GetSideCA, int32 MaterialIndex) {
+    int32 InteriorVertexOffset = NextVertexIndex;
+    NextVertexIndex += InteriorVertexCount;
+    auto GetGridVertexIndex = [&] (int32 I, int32 J) -> int32 {
+      if (J == 0) return GetSideAB(I);
+      if (I == 0) return GetSideCA(N - J);
+      if (I + J == N) return GetSideBC(J);
+      // Interior rows hold N - 2 points for J = 1, down to one point for J = N - 2.
+      int32 RowOffset = (J - 1) * (N - 2) - (J - 1) * (J - 2) / 2;
+      return InteriorVertexOffset + RowOffset + I - 1;
+    };
+
+    for (int32 J = 1; J < N - 1; ++J) {
+      for (int32 I = 1; I + J < N; ++I) {
+        double AlphaB = static_cast<double>(I) / static_cast<double>(N), AlphaC = static_cast<double>(J) / static_cast<double>(N);
+        SetVertex(GetGridVertexIndex(I, J), BlendTerms(TermsA, 1.0 - AlphaB - AlphaC, TermsB, AlphaB, TermsC, AlphaC));
+      }
+    }
+    for (int32 J = 0; J < N; ++J) {
+      for (int32 I = 0; I + J < N; ++I) {
+        FPolyhedronPolygon& UpTriangle = Output.Polygons.Add_GetRef({ GetGridVertexIndex(I, J), GetGridVertexIndex(I + 1, J), GetGridVertexIndex(I, J + 1) });
+        UpTriangle.MaterialIndex = MaterialIndex;
+        if (I + J + 2 > N) continue;
+        FPolyhedronPolygon& DownTriangle = Output.Polygons.Add_GetRef({ GetGridVertexIndex(I + 1, J), GetGridVertexIndex(I + 1, J + 1), GetGridVertexIndex(I, J + 1) });
+        DownTriangle.MaterialIndex = MaterialIndex;
+      }
+    }
+  };
+
+  for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
     const FPolyhedronPolygon& Polygon = Input.Polygons[PolygonIndex];
+    int32 HalfEdgeOffset = ExtendedInput.PolygonHalfEdgeOffsets[PolygonIndex];
     int32 PolygonVertexCount = Polygon.VertexIndices.Num();
-    if (PolygonVertexCount < 3) continue;
-    
-    int32 Vertex1 = Polygon.VertexIndices[PolygonVertexCount - 2];
-    int32 Vertex2 = Polygon.VertexIndices[PolygonVertexCount - 1];
-    for (int32 Vertex3 : Polygon.VertexIndices) {
-      int64 FaceId = static_cast<int64>(PolygonIndex) * static_cast<int64>(InputPolygonCount) + static_cast<int64>(Vertex1);
-      PolyFlag.AddWorkVertex(CalculateGyroVertexId(Vertex1, Vertex2), FMath::Lerp(Input.Vertices[Vertex1], Input.Vertices[Vertex2], 1.0 / 3.0));
-      PolyFlag.AddWorkFlag(FaceId, CenterOffset + PolygonIndex, CalculateGyroVertexId(Vertex1, Vertex2));
-      PolyFlag.AddWorkFlag(FaceId, CalculateGyroVertexId(Vertex1, Vertex2), CalculateGyroVertexId(Vertex2, Vertex1));
-      PolyFlag.AddWorkFlag(FaceId, CalculateGyroVertexId(Vertex2, Vertex1), Vertex2);
-      PolyFlag.AddWorkFlag(FaceId, Vertex2, CalculateGyroVertexId(Vertex2, Vertex3));
-      PolyFlag.AddWorkFlag(FaceId, CalculateGyroVertexId(Vertex2, Vertex3), CenterOffset + PolygonIndex);
-      
-      // Advance to the next edge pair.
-      Vertex1 = Vertex2;
-      Vertex2 = Vertex3;
-    }
-  }
-  return PolyFlag.ConvertWorkBuffers();
-}
-
-FPolyhedronMesh FPolyhedronOperations::Snub(const FPolyhedronMesh& Input) {
-  // Leverage the Gyro operation in dual-space.
-  FPolyhedronMesh Polyhedron1 = Dual(Input);
-  FPolyhedronMesh Polyhedron2 = Gyro(Polyhedron1);
-  return Dual(Polyhedron2);
-}
+    if (bRecordProvenance) {
+      PolygonVertexOffsets[PolygonIndex] = NextVertexIndex;
+      PolygonPolygonOffsets[PolygonIndex] = Output.Polygons.Num();
+    }
 
-FPolyhedronMesh FPolyhedronOperations::Meta(const FPolyhedronMesh& Input) {
-  // Meta is a join-kis combo.
-  FPolyhedronMesh Polyhedron1 = Join(Input);
-  return Kis(Polyhedron1);
-}
+    // Half-edge k goes from vertex k - 1 to vertex k.
+    if (!PolygonMask[PolygonIndex]) {
+      if (SplitEdgeCounts[PolygonIndex] == 0) {
+        Output.Polygons.Add(Polygon);
+        continue;
+      }
+      // Close the mask with a fan around the center, through every point of the split edges.
+      TArray<int32> BoundaryVertexIndices;
+      BoundaryVertexIndices.Reserve(PolygonVertexCount + SplitEdgeCounts[PolygonIndex] * (N - 1));
+      FTerms CenterTerms;
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+        int32 HalfEdgeIndex = HalfEdgeOffset + PolygonVertexIndex;
+        int32 StepCount = HalfEdgeEdgeIndices[HalfEdgeIndex] != INDEX_NONE ? N : 1;
+        for (int32 Step = 0; Step < StepCount; ++Step) {
+          BoundaryVertexIndices.Add(GetEdgeVertexIndex(HalfEdgeIndex, Step));
+        }
+        CenterTerms.Add({ Polygon.VertexIndices[PolygonVertexIndex], 1.0 / static_cast<double>(PolygonVertexCount) });
+      }
+      int32 CenterVertexIndex = NextVertexIndex++;
+      SetVertex(CenterVertexIndex, MoveTemp(CenterTerms));
+      for (int32 BoundaryIndex = 0; BoundaryIndex < BoundaryVertexIndices.Num(); ++BoundaryIndex) {
+        FPolyhedronPolygon& Triangle = Output.Polygons.Add_GetRef({ BoundaryVertexIndices[BoundaryIndex], BoundaryVertexIndices[(BoundaryIndex + 1) % BoundaryVertexIndices.Num()], CenterVertexIndex });
+        Triangle.MaterialIndex = Polygon.MaterialIndex;
+      }
+      continue;
+    }
 
-FPolyhedronMesh FPolyhedronOperations::Bevel(const FPolyhedronMesh& Input) {
-  // Bevel is a ambo-truncate combo.
-  FPolyhedronMesh Polyhedron1 = Ambo(Input);
-  return Truncate(Polyhedron1);
-}
+    if (PolygonVertexCount == 3) {
+      FTerms TermsA = { { Polygon.VertexIndices[0], 1.0 } }, TermsB = { { Polygon.VertexIndices[1], 1.0 } }, TermsC = { { Polygon.VertexIndices[2], 1.0 } };
+      SubdivideTriangle(TermsA, TermsB, TermsC,
+        [&] (int32 Step) { return GetEdgeVertexIndex(HalfEdgeOffset + 1, Step); },
+        [&] (int32 Step) { return GetEdgeVertexIndex(HalfEdgeOffset + 2, Step); },
+        [&] (int32 Step) { return GetEdgeVertexIndex(HalfEdgeOffset, Step); },
+        Polygon.MaterialIndex);
+      continue;
+    }
+
+    // The fan shares the center and the spokes that run from the center to each vertex.
+    FTerms CenterTerms;
+    for (int32 VertexIndex : Polygon.VertexIndices) {
+      CenterTerms.Add({ VertexIndex, 1.0 / static_cast<double>(PolygonVertexCount) });
+    }
+    int32 CenterVertexIndex = NextVertexIndex++;
+    SetVertex(CenterVertexIndex, FTerms(CenterTerms));
+    int32 SpokeVertexOffset = NextVertexIndex;
+    NextVertexIndex += PolygonVertexCount * (N - 1);
+    for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+      FTerms VertexTerms = { { Polygon.VertexIndices[PolygonVertexIndex], 1.0 } };
+      for (int32 Step = 1; Step < N; ++Step) {
+        double Alpha = static_cast<double>(Step) / static_cast<double>(N);
+        SetVertex(SpokeVertexOffset + PolygonVertexIndex * (N - 1) + Step - 1, BlendTerms(CenterTerms, 1.0 - Alpha, VertexTerms, Alpha, FTerms(), 0.0));
+      }
+    }
+    auto GetSpokeVertexIndex = [&] (int32 PolygonVertexIndex, int32 StepFromCenter) -> int32 {
+      if (StepFromCenter == 0) return CenterVertexIndex;
+      if (StepFromCenter == N) return Polygon.VertexIndices[PolygonVertexIndex];
+      return SpokeVertexOffset + PolygonVertexIndex * (N - 1) + StepFromCenter - 1;
+    };
+
+    // Each fan triangle is (vertex k - 1, vertex k, center).
+    for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < PolygonVertexCount; ++PolygonVertexIndex) {
+      int32 PreviousPolygonVertexIndex = (PolygonVertexIndex + PolygonVertexCount - 1) % PolygonVertexCount;
+      FTerms TermsA = { { Polygon.VertexIndices[PreviousPolygonVertexIndex], 1.0 } }, TermsB = { { Polygon.VertexIndices[PolygonVertexIndex], 1.0 } };
+      SubdivideTriangle(TermsA, TermsB, CenterTerms,
+        [&] (int32 Step) { return GetEdgeVertexIndex(HalfEdgeOffset + PolygonVertexIndex, Step); },
+        [&] (int32 Step) { return GetSpokeVertexIndex(PolygonVertexIndex, N - Step); },
+        [&] (int32 Step) { return GetSpokeVertexIndex(PreviousPolygonVertexIndex, Step); },
+        Polygon.MaterialIndex);
+    }
+  }
+  check(NextVertexIndex == OutputVertexCount);
+  check(Output.Polygons.Num() == OutputPolygonCount);
 
+  if (Stage != nullptr) {
+    for (const FPolyhedronVertexRecipe& Recipe : Recipes) {
+      Stage->AddVertex(Recipe);
+    }
+  }
+  if (bRecordProvenance) {
+    // The input vertices, the edge points, then whatever each polygon adds.
+    PolygonVertexOffsets.Last() = NextVertexIndex;
+    PolygonPolygonOffsets.Last() = Output.Polygons.Num();
+    Stage->VertexSources.SetNumUninitialized(OutputVertexCount);
+    Stage->PolygonSources.SetNumUninitialized(OutputPolygonCount);
+    for (int32 VertexIndex = 0; VertexIndex < InputVertexCount; ++VertexIndex) {
+      Stage->VertexSources[VertexIndex] = MakeVertexSource(ExtendedInput, VertexIndex);
+    }
+    for (int32 HalfEdgeIndex = 0; HalfEdgeIndex < HalfEdgeCount; ++HalfEdgeIndex) {
+      const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex];
+      if (HalfEdge.VertexIndexFrom > HalfEdge.VertexIndexTo || HalfEdgeEdgeIndices[HalfEdgeIndex] == INDEX_NONE) continue;
+      for (int32 Step = 1; Step < N; ++Step) {
+        Stage->VertexSources[EdgeVertexOffset + HalfEdgeEdgeIndices[HalfEdgeIndex] * (N - 1) + Step - 1] = MakeHalfEdgeSource(ExtendedInput, HalfEdgeIndex, EElement::Edge);
+      }
+    }
+    for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+      for (int32 VertexIndex = PolygonVertexOffsets[PolygonIndex]; VertexIndex < PolygonVertexOffsets[PolygonIndex + 1]; ++VertexIndex) {
+        Stage->VertexSources[VertexIndex] = MakePolygonSource(PolygonIndex);
+      }
+      for (int32 OutputPolygonIndex = PolygonPolygonOffsets[PolygonIndex]; OutputPolygonIndex < PolygonPolygonOffsets[PolygonIndex + 1]; ++OutputPolygonIndex) {
+        Stage->PolygonSources[OutputPolygonIndex] = MakePolygonSource(PolygonIndex);
+      }
+    }
+  }
+  return Output;
+}
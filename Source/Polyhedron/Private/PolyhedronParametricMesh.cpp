@@ -0,0 +1,113 @@
+// Copyright 2024 TabbyCoder
+
+#include "PolyhedronParametricMesh.h"
+#include "Async/ParallelFor.h"
+#include "Helpers.h"
+#include "PolyhedronTools.h"
+
+bool FPolyhedronParametricMesh::Build(const FString& InConwayPolyhedronNotation, float Scale, const FPolyhedronOperationParameters& Parameters) {
+  ConwayPolyhedronNotation = InConwayPolyhedronNotation;
+  SeedVertices.Reset();
+  Recorder.Stages.Reset();
+  Polyhedron = FPolyhedronMesh();
+
+  TArray<FPolyhedronNotationStep> Steps;
+  if (!FPolyhedronTools::ParseConwayPolyhedronNotation(ConwayPolyhedronNotation, Steps)) return false;
+  // Canonicalization moves the vertices iteratively, it has no vertex recipes to replay.
+  if (Steps.ContainsByPredicate([] (const FPolyhedronNotationStep& Step) { return Step.Symbol == 'K'; })) return false;
+  FPolyhedronMeshSize PredictedSize;
+  if (FPolyhedronTools::PredictConwayPolyhedronNotation(Steps, PredictedSize) && !FPolyhedronTools::CheckMemoryBudget(PredictedSize)) return false;
+
+  // The seed has no input: its vertices are constant. Every operation after it records its vertex recipes.
+  FPolyhedronMesh Output = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Steps[0], FPolyhedronMesh());
+  SeedVertices = Output.Vertices;
+  for (int32 StepIndex = 1; StepIndex < Steps.Num(); ++StepIndex) {
+    Output = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Steps[StepIndex], Output, Parameters, &Recorder);
+  }
+  REPORT_ERROR_RETURN_IF(Output.Polygons.Num() == 0, false, "ConwayPolyhedronNotation makes no Polyhedron");
+
+  Polyhedron = FPolyhedronTools::ScaleToSphere(Output, Scale);
+  return true;
+}
+
+void FPolyhedronParametricMesh::Evaluate(const FPolyhedronOperationParameters& Parameters, float Scale, bool bSinglePrecision) {
+  if (!IsValid()) return;
+
+  // Only keep the work buffers of one precision.
+  if (bSinglePrecision) {
+    DoubleWorkBuffers = TWorkBuffers<double>();
+    Evaluate(Parameters, Scale, FloatWorkBuffers);
+  } else {
+    FloatWorkBuffers = TWorkBuffers<float>();
+    Evaluate(Parameters, Scale, DoubleWorkBuffers);
+  }
+}
+
+template <typename FReal>
+void FPolyhedronParametricMesh::Evaluate(const FPolyhedronOperationParameters& Parameters, float Scale, TWorkBuffers<FReal>& WorkBuffers) {
+  using FRealVector = UE::Math::TVector<FReal>;
+  TArray<FRealVector>& InputVertices = WorkBuffers.InputVertices;
+  TArray<FRealVector>& OutputVertices = WorkBuffers.OutputVertices;
+  TArray<FRealVector>& InputPolygonNormals = WorkBuffers.InputPolygonNormals;
+
+  InputVertices.SetNumUninitialized(SeedVertices.Num(), EAllowShrinking::No);
+  for (int32 VertexIndex = 0; VertexIndex < SeedVertices.Num(); ++VertexIndex) {
+    InputVertices[VertexIndex] = FRealVector(SeedVertices[VertexIndex]);
+  }
+  for (const FPolyhedronOperationStage& Stage : Recorder.Stages) {
+    check(Stage.InputVertexCount == InputVertices.Num());
+
+    // The normals are shared by several recipes, compute them first.
+    // Same as FPolyhedronTools::GetPolygonNormal(), summed in doubles.
+    InputPolygonNormals.SetNumUninitialized(Stage.InputPolygons.Num(), EAllowShrinking::No);
+    ParallelFor(Stage.InputPolygons.Num(), [&] (int32 PolygonIndex) {
+      const TArray<int32>& PolygonVertexIndices = Stage.InputPolygons[PolygonIndex].VertexIndices;
+      FVector Normal = FVector::ZeroVector;
+      if (PolygonVertexIndices.Num() < 3) {
+        InputPolygonNormals[PolygonIndex] = FRealVector::ZeroVector;
+        return;
+      }
+      FVector Previous(InputVertices[PolygonVertexIndices.Last()]);
+      for (int32 VertexIndex : PolygonVertexIndices) {
+        FVector Current(InputVertices[VertexIndex]);
+        Normal += FVector::CrossProduct(Current, Previous);
+        Previous = Current;
+      }
+      InputPolygonNormals[PolygonIndex] = FRealVector(Normal.GetSafeNormal(1e-24));
+    });
+
+    OutputVertices.SetNumUninitialized(Stage.Vertices.Num(), EAllowShrinking::No);
+    ParallelFor(Stage.Vertices.Num(), [&] (int32 VertexIndex) {
+      const FPolyhedronOperationStage::FVertex& Recipe = Stage.Vertices[VertexIndex];
+      FRealVector Position = FRealVector::ZeroVector;
+      double TermRadius = 0.0;
+      for (int32 TermIndex = Recipe.TermOffset; TermIndex < Recipe.TermOffset + Recipe.TermCount; ++TermIndex) {
+        const FRealVector& TermVertex = InputVertices[Stage.Terms[TermIndex].Key];
+        Position += FReal(Stage.Terms[TermIndex].Value) * TermVertex;
+        TermRadius += Recipe.bKeepTermRadius ? Stage.Terms[TermIndex].Value * TermVertex.Size() : 0.0;
+      }
+      if (Recipe.bKeepTermRadius) {
+        Position = Position.GetSafeNormal() * FReal(TermRadius);
+      }
+      FReal ParameterValue = FReal(Parameters.GetValue(Recipe.Parameter));
+      Position += ParameterValue * FReal(Recipe.RadialFactor) * Position;
+      if (Recipe.NormalPolygonIndex != INDEX_NONE) {
+        Position += ParameterValue * FReal(Recipe.NormalFactor) * InputPolygonNormals[Recipe.NormalPolygonIndex];
+      }
+      OutputVertices[VertexIndex] = Recipe.bNormalize ? Position.GetUnsafeNormal() : Position;
+    });
+    Swap(InputVertices, OutputVertices);
+  }
+
+  // Same as FPolyhedronTools::ScaleToSphere().
+  double FurthestVertexDistanceSquared = 0.0;
+  for (const FRealVector& VertexPosition : InputVertices) {
+    FurthestVertexDistanceSquared = FMath::Max(FurthestVertexDistanceSquared, FVector(VertexPosition).SquaredLength());
+  }
+  float ScaleFactor = Scale / FMath::Sqrt(FurthestVertexDistanceSquared);
+
+  check(InputVertices.Num() == Polyhedron.Vertices.Num());
+  ParallelFor(InputVertices.Num(), [&] (int32 VertexIndex) {
+    Polyhedron.Vertices[VertexIndex] = FVector(InputVertices[VertexIndex]) * ScaleFactor;
+  });
+}
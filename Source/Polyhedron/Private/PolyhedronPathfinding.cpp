@@ -0,0 +1,210 @@
+// Copyright 2024 TabbyCoder
+
+#include "PolyhedronPathfinding.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Helpers.h"
+
+namespace {
+  // A polygon of a partition is reached by the smallest (distance, region) pair, packed in one word so that one atomic
+  // compare-and-swap updates both. The bits of a positive float keep its order.
+  uint64 PackDistanceRegion(float Distance, int32 RegionIndex) {
+    return (static_cast<uint64>(FMath::AsUInt(Distance)) << 32) | static_cast<uint64>(static_cast<uint32>(RegionIndex));
+  }
+  constexpr uint64 UnreachedKey = MAX_uint64;
+}
+
+FPolyhedronPathfinder::FPolyhedronPathfinder(const FPolyhedronPolygonGraph& InGraph, TArrayView<const float> InPolygonCosts)
+  : Graph(InGraph)
+  , PolygonCosts(InPolygonCosts) {
+  int32 PolygonCount = Graph.GetPolygonCount();
+  if (PolygonCosts.Num() != 0 && PolygonCosts.Num() != PolygonCount) {
+    REPORT_ERROR("PolygonCosts has %d costs for %d polygons, they are ignored", PolygonCosts.Num(), PolygonCount);
+    PolygonCosts = TArrayView<const float>();
+  }
+  for (float PolygonCost : PolygonCosts) {
+    if (PolygonCost >= 0.0f) {
+      HeuristicScale = FMath::Min(HeuristicScale, PolygonCost);
+    }
+  }
+  Stamps.SetNumZeroed(PolygonCount);
+  Costs.SetNumUninitialized(PolygonCount);
+  Parents.SetNumUninitialized(PolygonCount);
+}
+
+bool FPolyhedronPathfinder::FindPath(int32 StartPolygonIndex, int32 GoalPolygonIndex, FPolyhedronPath& OutPath) {
+  OutPath = FPolyhedronPath();
+  REPORT_ERROR_RETURN_IF(!Graph.Centers.IsValidIndex(StartPolygonIndex) || !Graph.Centers.IsValidIndex(GoalPolygonIndex), false, "Cannot find a path from polygon %d to polygon %d", StartPolygonIndex, GoalPolygonIndex);
+  Search(MakeArrayView(&StartPolygonIndex, 1), GoalPolygonIndex, TNumericLimits<float>::Max());
+  return GetPath(GoalPolygonIndex, OutPath);
+}
+
+TArray<FPolyhedronPath> FPolyhedronPathfinder::FindPaths(const FPolyhedronPolygonGraph& Graph, TArrayView<const FPolyhedronPathQuery> Queries, TArrayView<const float> PolygonCosts) {
+  TArray<FPolyhedronPath> Paths;
+  Paths.SetNum(Queries.Num());
+
+  // Each batch takes every BatchCount-th query, which spreads the long searches over the batches.
+  int32 BatchCount = FMath::Min(Queries.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+  ParallelFor(BatchCount, [&] (int32 BatchIndex) {
+    FPolyhedronPathfinder Pathfinder(Graph, PolygonCosts);
+    for (int32 QueryIndex = BatchIndex; QueryIndex < Queries.Num(); QueryIndex += BatchCount) {
+      Pathfinder.FindPath(Queries[QueryIndex].StartPolygonIndex, Queries[QueryIndex].GoalPolygonIndex, Paths[QueryIndex]);
+    }
+  });
+  return Paths;
+}
+
+void FPolyhedronPathfinder::ComputeCosts(TArrayView<const int32> SourcePolygonIndices, float MaxCost) {
+  for (int32 SourcePolygonIndex : SourcePolygonIndices) {
+    REPORT_ERROR_IF(!Graph.Centers.IsValidIndex(SourcePolygonIndex), "Cannot search from polygon %d", SourcePolygonIndex);
+  }
+  Search(SourcePolygonIndices, INDEX_NONE, MaxCost);
+}
+
+float FPolyhedronPathfinder::GetCost(int32 PolygonIndex) const {
+  return IsReached(PolygonIndex) ? Costs[PolygonIndex] : TNumericLimits<float>::Max();
+}
+
+bool FPolyhedronPathfinder::GetPath(int32 PolygonIndex, FPolyhedronPath& OutPath) const {
+  OutPath = FPolyhedronPath();
+  if (!IsReached(PolygonIndex)) return false;
+  OutPath.Cost = Costs[PolygonIndex];
+  for (int32 PathPolygonIndex = PolygonIndex; PathPolygonIndex != INDEX_NONE; PathPolygonIndex = Parents[PathPolygonIndex]) {
+    OutPath.PolygonIndices.Add(PathPolygonIndex);
+  }
+  Algo::Reverse(OutPath.PolygonIndices);
+  return true;
+}
+
+void FPolyhedronPathfinder::Search(TArrayView<const int32> SourcePolygonIndices, int32 GoalPolygonIndex, float MaxCost) {
+  // Start a new search; on the rare wrap-around of the stamps, every polygon is cleared for real.
+  if (++Stamp == 0) {
+    FMemory::Memzero(Stamps.GetData(), Stamps.Num() * sizeof(uint32));
+    Stamp = 1;
+  }
+  OpenPolygons.Reset();
+
+  // The open polygons are a binary heap, where a polygon is pushed again whenever its cost improves:
+  // the stale entries are skipped when they come out.
+  auto IsCheaper = [] (const FOpenPolygon& A, const FOpenPolygon& B) { return A.Priority < B.Priority; };
+  auto GetPolygonCost = [&] (int32 PolygonIndex) { return PolygonCosts.Num() > 0 ? PolygonCosts[PolygonIndex] : 1.0f; };
+  auto GetHeuristic = [&] (int32 PolygonIndex) {
+    return GoalPolygonIndex != INDEX_NONE ? HeuristicScale * static_cast<float>(FVector::Dist(Graph.Centers[PolygonIndex], Graph.Centers[GoalPolygonIndex])) : 0.0f;
+  };
+  for (int32 SourcePolygonIndex : SourcePolygonIndices) {
+    if (GetPolygonCost(SourcePolygonIndex) < 0.0f || IsReached(SourcePolygonIndex)) continue;
+    Stamps[SourcePolygonIndex] = Stamp;
+    Costs[SourcePolygonIndex] = 0.0f;
+    Parents[SourcePolygonIndex] = INDEX_NONE;
+    OpenPolygons.HeapPush({ GetHeuristic(SourcePolygonIndex), 0.0f, SourcePolygonIndex }, IsCheaper);
+  }
+
+  while (OpenPolygons.Num() > 0) {
+    FOpenPolygon OpenPolygon;
+    OpenPolygons.HeapPop(OpenPolygon, IsCheaper, EAllowShrinking::No);
+    int32 PolygonIndex = OpenPolygon.PolygonIndex;
+    if (OpenPolygon.Cost > Costs[PolygonIndex]) continue;
+    if (PolygonIndex == GoalPolygonIndex) break;
+
+    float PolygonCost = GetPolygonCost(PolygonIndex);
+    TArrayView<const int32> Neighbors = Graph.GetNeighbors(PolygonIndex);
+    TArrayView<const float> NeighborDistances = Graph.GetNeighborDistances(PolygonIndex);
+    for (int32 NeighborIndex = 0; NeighborIndex < Neighbors.Num(); ++NeighborIndex) {
+      int32 Neighbor = Neighbors[NeighborIndex];
+      float NeighborCost = GetPolygonCost(Neighbor);
+      if (NeighborCost < 0.0f) continue;
+      float Cost = OpenPolygon.Cost + 0.5f * NeighborDistances[NeighborIndex] * (PolygonCost + NeighborCost);
+      if (Cost > MaxCost || (IsReached(Neighbor) && Cost >= Costs[Neighbor])) continue;
+      Stamps[Neighbor] = Stamp;
+      Costs[Neighbor] = Cost;
+      Parents[Neighbor] = PolygonIndex;
+      OpenPolygons.HeapPush({ Cost + GetHeuristic(Neighbor), Cost, Neighbor }, IsCheaper);
+    }
+  }
+}
+
+void FPolyhedronPartition::AssignMaterialIndices(FPolyhedronMesh& Polyhedron, TArrayView<const int32> RegionMaterialIndices) const {
+  REPORT_ERROR_IF(RegionIndices.Num() != Polyhedron.Polygons.Num(), "The partition has %d polygons, the polyhedron %d", RegionIndices.Num(), Polyhedron.Polygons.Num());
+  int32 RegionCount = 0;
+  for (int32 RegionIndex : RegionIndices) {
+    RegionCount = FMath::Max(RegionCount, RegionIndex + 1);
+  }
+  REPORT_ERROR_IF(RegionMaterialIndices.Num() > 0 && RegionMaterialIndices.Num() < RegionCount, "%d material indices for %d regions", RegionMaterialIndices.Num(), RegionCount);
+  for (int32 PolygonIndex = 0; PolygonIndex < RegionIndices.Num(); ++PolygonIndex) {
+    int32 RegionIndex = RegionIndices[PolygonIndex];
+    if (RegionIndex == INDEX_NONE) continue;
+    Polyhedron.Polygons[PolygonIndex].MaterialIndex = RegionMaterialIndices.Num() > 0 ? RegionMaterialIndices[RegionIndex] : RegionIndex;
+  }
+}
+
+FPolyhedronPartition FPolyhedronPathfinder::Partition(const FPolyhedronPolygonGraph& Graph, TArrayView<const int32> SeedPolygonIndices, const FPolyhedronPartitionSettings& Settings) {
+  int32 PolygonCount = Graph.GetPolygonCount();
+  FPolyhedronPartition Partition;
+  REPORT_ERROR_RETURN_IF(Settings.PolygonCosts.Num() != 0 && Settings.PolygonCosts.Num() != PolygonCount, Partition, "PolygonCosts has %d costs for %d polygons", Settings.PolygonCosts.Num(), PolygonCount);
+  auto GetPolygonCost = [&] (int32 PolygonIndex) { return Settings.PolygonCosts.Num() > 0 ? Settings.PolygonCosts[PolygonIndex] : 1.0f; };
+
+  // The seeds make the first frontier.
+  TArray<uint64> Keys;
+  Keys.Init(UnreachedKey, PolygonCount);
+  TArray<int32> Frontier, NextFrontier;
+  for (int32 RegionIndex = 0; RegionIndex < SeedPolygonIndices.Num(); ++RegionIndex) {
+    int32 SeedPolygonIndex = SeedPolygonIndices[RegionIndex];
+    REPORT_ERROR_RETURN_IF(!Graph.Centers.IsValidIndex(SeedPolygonIndex), Partition, "Cannot grow a region from polygon %d", SeedPolygonIndex);
+    if (GetPolygonCost(SeedPolygonIndex) < 0.0f || Keys[SeedPolygonIndex] != UnreachedKey) continue;
+    Keys[SeedPolygonIndex] = PackDistanceRegion(0.0f, RegionIndex);
+    Frontier.Add(SeedPolygonIndex);
+  }
+
+  // Each round relaxes the neighbors of the frontier, and the polygons that improve make the next frontier, once each.
+  // A polygon may improve again in a later round; the rounds stop once every distance is the shortest one.
+  TArray<int32> FrontierRounds;
+  FrontierRounds.Init(0, PolygonCount);
+  NextFrontier.SetNumUninitialized(PolygonCount);
+  for (int32 Round = 1; Frontier.Num() > 0; ++Round) {
+    int32 NextFrontierCount = 0;
+    ParallelFor(Frontier.Num(), [&] (int32 FrontierIndex) {
+      int32 PolygonIndex = Frontier[FrontierIndex];
+      uint64 Key = static_cast<uint64>(FPlatformAtomics::AtomicRead(reinterpret_cast<volatile const int64*>(&Keys[PolygonIndex])));
+      float Distance = FMath::AsFloat(static_cast<uint32>(Key >> 32));
+      int32 RegionIndex = static_cast<int32>(Key & MAX_uint32);
+      float PolygonCost = GetPolygonCost(PolygonIndex);
+      TArrayView<const int32> Neighbors = Graph.GetNeighbors(PolygonIndex);
+      TArrayView<const float> NeighborDistances = Graph.GetNeighborDistances(PolygonIndex);
+      for (int32 NeighborIndex = 0; NeighborIndex < Neighbors.Num(); ++NeighborIndex) {
+        int32 Neighbor = Neighbors[NeighborIndex];
+        float NeighborCost = GetPolygonCost(Neighbor);
+        if (NeighborCost < 0.0f) continue;
+        float NeighborDistance = Distance + 0.5f * (Settings.bCountSteps ? 1.0f : NeighborDistances[NeighborIndex]) * (PolygonCost + NeighborCost);
+        if (NeighborDistance > Settings.MaxDistance) continue;
+
+        uint64 NeighborKey = PackDistanceRegion(NeighborDistance, RegionIndex);
+        volatile int64* NeighborKeyAddress = reinterpret_cast<volatile int64*>(&Keys[Neighbor]);
+        uint64 OldKey = static_cast<uint64>(FPlatformAtomics::AtomicRead(NeighborKeyAddress));
+        bool bImproved = false;
+        while (NeighborKey < OldKey) {
+          uint64 PreviousKey = static_cast<uint64>(FPlatformAtomics::InterlockedCompareExchange(NeighborKeyAddress, static_cast<int64>(NeighborKey), static_cast<int64>(OldKey)));
+          if (PreviousKey == OldKey) {
+            bImproved = true;
+            break;
+          }
+          OldKey = PreviousKey;
+        }
+        if (bImproved && FPlatformAtomics::InterlockedExchange(&FrontierRounds[Neighbor], Round) != Round) {
+          NextFrontier[FPlatformAtomics::InterlockedIncrement(&NextFrontierCount) - 1] = Neighbor;
+        }
+      }
+    }, Frontier.Num() < 256 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+    Frontier.Reset();
+    Frontier.Append(NextFrontier.GetData(), NextFrontierCount);
+  }
+
+  Partition.RegionIndices.SetNumUninitialized(PolygonCount);
+  Partition.Distances.SetNumUninitialized(PolygonCount);
+  ParallelFor(PolygonCount, [&] (int32 PolygonIndex) {
+    uint64 Key = Keys[PolygonIndex];
+    Partition.RegionIndices[PolygonIndex] = Key != UnreachedKey ? static_cast<int32>(Key & MAX_uint32) : INDEX_NONE;
+    Partition.Distances[PolygonIndex] = Key != UnreachedKey ? FMath::AsFloat(static_cast<uint32>(Key >> 32)) : TNumericLimits<float>::Max();
+  });
+  return Partition;
+}
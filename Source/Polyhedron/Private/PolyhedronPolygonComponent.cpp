@@ -2,6 +2,7 @@
 
 #include "PolyhedronPolygonComponent.h"
 #include "Helpers.h"
+#include "PolyhedronComponent.h"
 
 UPolyhedronPolygonComponent::UPolyhedronPolygonComponent(const FObjectInitializer& ObjectInitializer)
   : UProceduralMeshComponent(ObjectInitializer) {}
@@ -40,6 +41,7 @@ void UPolyhedronPolygonComponent::SetPolyhedronPolygon(int32 ComponentIndex, con
   TArray<FVector> MeshPositions; MeshPositions.Reserve(VertexTotal);
   TArray<FVector> MeshNormals; MeshNormals.Reserve(VertexTotal);
   TArray<FVector2D> MeshUVs; MeshUVs.Reserve(VertexTotal);
+  TArray<FProcMeshTangent> MeshTangents; MeshTangents.Reserve(VertexTotal);
   TArray<int32> MeshTriangles; MeshTriangles.Reserve(TriangleTotal * 3);
 
   // Fill the vertex arrays.
@@ -51,11 +53,14 @@ void UPolyhedronPolygonComponent::SetPolyhedronPolygon(int32 ComponentIndex, con
     FVector PolygonNormal = FPolyhedronTools::GetPolygonNormal(PolyhedronMesh, Polygon);
 
     // Copy the vertex data into the final mesh arrays.
+    // The texture coordinates have the same basis as the Cellular ones, and so the same tangent.
     int32 PolygonVertexOffset = MeshPositions.Num();
+    FProcMeshTangent PolygonTangent = FPolyhedronSectionBuilder::GetPolygonTangent(PolyhedronMesh, Polygon, PolygonNormal, EPolyhedronUVGeneration::Cellular);
     for (const int32& VertexIndex : Polygon.VertexIndices) {
       // Offset the positions slightly to avoid Z-fighting.
       MeshPositions.Add(PolyhedronMesh.Vertices[VertexIndex] + PolygonNormal * Offset);
       MeshNormals.Add(PolygonNormal);
+      MeshTangents.Add(PolygonTangent);
     }
 
     // Calculate the offset for each vertex position away from the center's normal.
@@ -96,5 +101,5 @@ void UPolyhedronPolygonComponent::SetPolyhedronPolygon(int32 ComponentIndex, con
   REPORT_ERROR_IF(MeshUVs.Num() != VertexTotal, "Broken Algorithm -- Mismatched MeshUVs.Num()");
   REPORT_ERROR_IF(MeshTriangles.Num() != 3 * TriangleTotal, "Broken Algorithm -- Mismatched MeshTriangles.Num()");
 
-  CreateMeshSection_LinearColor(ComponentIndex, MeshPositions, MeshTriangles, MeshNormals, MeshUVs, TArray<FLinearColor>(), TArray<FProcMeshTangent>(), /*bCreateCollision=*/false, /*bSRGBConversion=*/false);
+  CreateMeshSection_LinearColor(ComponentIndex, MeshPositions, MeshTriangles, MeshNormals, MeshUVs, TArray<FLinearColor>(), MeshTangents, /*bCreateCollision=*/false, /*bSRGBConversion=*/false);
 }
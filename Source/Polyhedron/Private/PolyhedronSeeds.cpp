@@ -3,113 +3,163 @@
 // Based on earlier work from George W. Hart.  http://www.georgehart.com/
 
 #include "PolyhedronSeeds.h"
+#include "Helpers.h"
+#include "PolyhedronOperations.h"
+
+namespace {
+  // Builds a seed from constant tables, pre-sized: the polygons all have the same number of vertices.
+  template <int32 VertexCount, int32 PolygonCount, int32 PolygonVertexCount>
+  FPolyhedronMesh MakeSeed(const double (&Vertices)[VertexCount][3], const int32 (&Polygons)[PolygonCount][PolygonVertexCount]) {
+    FPolyhedronMesh Output;
+    Output.Vertices.SetNumUninitialized(VertexCount);
+    for (int32 VertexIndex = 0; VertexIndex < VertexCount; ++VertexIndex) {
+      Output.Vertices[VertexIndex] = FVector(Vertices[VertexIndex][0], Vertices[VertexIndex][1], Vertices[VertexIndex][2]);
+    }
+    Output.Polygons.SetNum(PolygonCount);
+    for (int32 PolygonIndex = 0; PolygonIndex < PolygonCount; ++PolygonIndex) {
+      Output.Polygons[PolygonIndex].VertexIndices.Append(Polygons[PolygonIndex], PolygonVertexCount);
+    }
+    return Output;
+  }
 
-FPolyhedronMesh FPolyhedronSeeds::Icosahedron() {
   // Icosahedron from https://github.com/levskaya/polyhedronisme/blob/master/polyhedron.js
+  constexpr double IcosahedronVertices[][3] = {
+    { 0, 0, 1.176 },
+    { 1.051, 0, 0.526 },
+    { 0.324, 1.0, 0.525 },
+    { -0.851, 0.618, 0.526 },
+    { -0.851, -0.618, 0.526 },
+    { 0.325, -1.0, 0.526 },
+    { 0.851, 0.618, -0.526 },
+    { 0.851, -0.618, -0.526 },
+    { -0.325, 1.0, -0.526 },
+    { -1.051, 0, -0.526 },
+    { -0.325, -1.0, -0.526 },
+    { 0, 0, -1.176 },
+  };
+  constexpr int32 IcosahedronPolygons[][3] = {
+    { 0, 2, 1 },
+    { 0, 3, 2 },
+    { 0, 4, 3 },
+    { 0, 5, 4 },
+    { 0, 1, 5 },
+    { 1, 7, 5 },
+    { 1, 6, 7 },
+    { 1, 2, 6 },
+    { 2, 8, 6 },
+    { 2, 3, 8 },
+    { 3, 9, 8 },
+    { 3, 4, 9 },
+    { 4, 10, 9 },
+    { 4, 5, 10 },
+    { 5, 7, 10 },
+    { 6, 11, 7 },
+    { 6, 8, 11 },
+    { 7, 11, 10 },
+    { 8, 9, 11 },
+    { 9, 10, 11 },
+  };
+
+  constexpr double OctahedronVertices[][3] = {
+    { 0, 0, 1.414 },
+    { 1.414, 0, 0 },
+    { 0, 1.414, 0 },
+    { -1.414, 0, 0 },
+    { 0, -1.414, 0 },
+    { 0, 0, -1.414 },
+  };
+  constexpr int32 OctahedronPolygons[][3] = {
+    { 0, 2, 1 },
+    { 0, 3, 2 },
+    { 0, 4, 3 },
+    { 0, 1, 4 },
+    { 1, 5, 4 },
+    { 1, 2, 5 },
+    { 2, 3, 5 },
+    { 3, 4, 5 },
+  };
 
-  FPolyhedronMesh Output;
-  Output.Vertices.Reserve(12);
-  Output.Vertices.Add({ 0, 0, 1.176 });
-  Output.Vertices.Add({ 1.051, 0, 0.526 });
-  Output.Vertices.Add({ 0.324, 1.0, 0.525 });
-  Output.Vertices.Add({ -0.851, 0.618, 0.526 });
-  Output.Vertices.Add({ -0.851, -0.618, 0.526 });
-  Output.Vertices.Add({ 0.325, -1.0, 0.526 });
-  Output.Vertices.Add({ 0.851, 0.618, -0.526 });
-  Output.Vertices.Add({ 0.851, -0.618, -0.526 });
-  Output.Vertices.Add({ -0.325, 1.0, -0.526 });
-  Output.Vertices.Add({ -1.051, 0, -0.526 });
-  Output.Vertices.Add({ -0.325, -1.0, -0.526 });
-  Output.Vertices.Add({ 0, 0, -1.176 });
-
-  Output.Polygons.Reserve(20);
-  Output.Polygons.Add({ 0, 2, 1 });
-  Output.Polygons.Add({ 0, 3, 2 });
-  Output.Polygons.Add({ 0, 4, 3 });
-  Output.Polygons.Add({ 0, 5, 4 });
-  Output.Polygons.Add({ 0, 1, 5 });
-  Output.Polygons.Add({ 1, 7, 5 });
-  Output.Polygons.Add({ 1, 6, 7 });
-  Output.Polygons.Add({ 1, 2, 6 });
-  Output.Polygons.Add({ 2, 8, 6 });
-  Output.Polygons.Add({ 2, 3, 8 });
-  Output.Polygons.Add({ 3, 9, 8 });
-  Output.Polygons.Add({ 3, 4, 9 });
-  Output.Polygons.Add({ 4, 10, 9 });
-  Output.Polygons.Add({ 4, 5, 10 });
-  Output.Polygons.Add({ 5, 7, 10 });
-  Output.Polygons.Add({ 6, 11, 7 });
-  Output.Polygons.Add({ 6, 8, 11 });
-  Output.Polygons.Add({ 7, 11, 10 });
-  Output.Polygons.Add({ 8, 9, 11 });
-  Output.Polygons.Add({ 9, 10, 11 });
+  // Dodecahedron from https://github.com/levskaya/polyhedronisme/blob/master/polyhedron.js
+  constexpr double DodecahedronVertices[][3] = {
+    { 0, 0, 1.07047 },
+    { 0.713644, 0, 0.797878 },
+    { -0.356822, 0.618, 0.797878 },
+    { -0.356822, -0.618, 0.797878 },
+    { 0.797878, 0.618034, 0.356822 },
+    { 0.797878, -0.618, 0.356822 },
+    { -0.934172, 0.381966, 0.356822 },
+    { 0.136294, 1.0, 0.356822 },
+    { 0.136294, -1.0, 0.356822 },
+    { -0.934172, -0.381966, 0.356822 },
+    { 0.934172, 0.381966, -0.356822 },
+    { 0.934172, -0.381966, -0.356822 },
+    { -0.797878, 0.618, -0.356822 },
+    { -0.136294, 1.0, -0.356822 },
+    { -0.136294, -1.0, -0.356822 },
+    { -0.797878, -0.618034, -0.356822 },
+    { 0.356822, 0.618, -0.797878 },
+    { 0.356822, -0.618, -0.797878 },
+    { -0.713644, 0, -0.797878 },
+    { 0, 0, -1.07047 },
+  };
+  constexpr int32 DodecahedronPolygons[][5] = {
+    { 0, 2, 7, 4, 1 },
+    { 0, 3, 9, 6, 2 },
+    { 0, 1, 5, 8, 3 },
+    { 1, 4, 10, 11, 5 },
+    { 2, 6, 12, 13, 7 },
+    { 3, 8, 14, 15, 9 },
+    { 4, 7, 13, 16, 10 },
+    { 5, 11, 17, 14, 8 },
+    { 6, 9, 15, 18, 12 },
+    { 10, 16, 19, 17, 11 },
+    { 12, 18, 19, 16, 13 },
+    { 14, 17, 19, 18, 15 },
+  };
+
+  constexpr double TetrahedronVertices[][3] = {
+    { 1.0, 1.0, 1.0 },
+    { 1.0, -1.0, -1.0 },
+    { -1.0, 1.0, -1.0 },
+    { -1.0, -1.0, 1.0 },
+  };
+  constexpr int32 TetrahedronPolygons[][3] = {
+    { 0, 2, 1 },
+    { 0, 3, 2 },
+    { 0, 1, 3 },
+    { 1, 2, 3 },
+  };
+
+  constexpr double CubeVertices[][3] = {
+    { 0.707, 0.707, 0.707 },
+    { -0.707, 0.707, 0.707 },
+    { -0.707, -0.707, 0.707 },
+    { 0.707, -0.707, 0.707 },
+    { 0.707, -0.707, -0.707 },
+    { 0.707, 0.707, -0.707 },
+    { -0.707, 0.707, -0.707 },
+    { -0.707, -0.707, -0.707 },
+  };
+  constexpr int32 CubePolygons[][4] = {
+    { 3, 2, 1, 0 },
+    { 3, 0, 5, 4 },
+    { 0, 1, 6, 5 },
+    { 1, 2, 7, 6 },
+    { 2, 3, 4, 7 },
+    { 5, 6, 7, 4 },
+  };
+}
 
-  return Output;
+FPolyhedronMesh FPolyhedronSeeds::Icosahedron() {
+  return MakeSeed(IcosahedronVertices, IcosahedronPolygons);
 }
 
 FPolyhedronMesh FPolyhedronSeeds::Octahedron() {
-  FPolyhedronMesh Output;
-  Output.Vertices.Reserve(6);
-  Output.Vertices.Add({ 0, 0, 1.414 });
-  Output.Vertices.Add({ 1.414, 0, 0 });
-  Output.Vertices.Add({ 0, 1.414, 0 });
-  Output.Vertices.Add({ -1.414, 0, 0 });
-  Output.Vertices.Add({ 0, -1.414, 0 });
-  Output.Vertices.Add({ 0, 0, -1.414 });
-
-  Output.Polygons.Reserve(8);
-  Output.Polygons.Add({ 0, 2, 1 });
-  Output.Polygons.Add({ 0, 3, 2 });
-  Output.Polygons.Add({ 0, 4, 3 });
-  Output.Polygons.Add({ 0, 1, 4 });
-  Output.Polygons.Add({ 1, 5, 4 });
-  Output.Polygons.Add({ 1, 2, 5 });
-  Output.Polygons.Add({ 2, 3, 5 });
-  Output.Polygons.Add({ 3, 4, 5 });
-  return Output;
+  return MakeSeed(OctahedronVertices, OctahedronPolygons);
 }
 
 FPolyhedronMesh FPolyhedronSeeds::Dodecahedron() {
-  // Dodecahedron from https://github.com/levskaya/polyhedronisme/blob/master/polyhedron.js
-
-  FPolyhedronMesh Output;
-  Output.Vertices.Reserve(20);
-  Output.Vertices.Add({ 0, 0, 1.07047 });
-  Output.Vertices.Add({ 0.713644, 0, 0.797878 });
-  Output.Vertices.Add({ -0.356822, 0.618, 0.797878 });
-  Output.Vertices.Add({ -0.356822, -0.618, 0.797878 });
-  Output.Vertices.Add({ 0.797878, 0.618034, 0.356822 });
-  Output.Vertices.Add({ 0.797878, -0.618, 0.356822 });
-  Output.Vertices.Add({ -0.934172, 0.381966, 0.356822 });
-  Output.Vertices.Add({ 0.136294, 1.0, 0.356822 });
-  Output.Vertices.Add({ 0.136294, -1.0, 0.356822 });
-  Output.Vertices.Add({ -0.934172, -0.381966, 0.356822 });
-  Output.Vertices.Add({ 0.934172, 0.381966, -0.356822 });
-  Output.Vertices.Add({ 0.934172, -0.381966, -0.356822 });
-  Output.Vertices.Add({ -0.797878, 0.618, -0.356822 });
-  Output.Vertices.Add({ -0.136294, 1.0, -0.356822 });
-  Output.Vertices.Add({ -0.136294, -1.0, -0.356822 });
-  Output.Vertices.Add({ -0.797878, -0.618034, -0.356822 });
-  Output.Vertices.Add({ 0.356822, 0.618, -0.797878 });
-  Output.Vertices.Add({ 0.356822, -0.618, -0.797878 });
-  Output.Vertices.Add({ -0.713644, 0, -0.797878 });
-  Output.Vertices.Add({ 0, 0, -1.07047 });
-
-  Output.Polygons.Reserve(12);
-  Output.Polygons.Add({ 0, 2, 7, 4, 1 });
-  Output.Polygons.Add({ 0, 3, 9, 6, 2 });
-  Output.Polygons.Add({ 0, 1, 5, 8, 3 });
-  Output.Polygons.Add({ 1, 4, 10, 11, 5 });
-  Output.Polygons.Add({ 2, 6, 12, 13, 7 });
-  Output.Polygons.Add({ 3, 8, 14, 15, 9 });
-  Output.Polygons.Add({ 4, 7, 13, 16, 10 });
-  Output.Polygons.Add({ 5, 11, 17, 14, 8 });
-  Output.Polygons.Add({ 6, 9, 15, 18, 12 });
-  Output.Polygons.Add({ 10, 16, 19, 17, 11 });
-  Output.Polygons.Add({ 12, 18, 19, 16, 13 });
-  Output.Polygons.Add({ 14, 17, 19, 18, 15 });
-
-  return Output;
+  return MakeSeed(DodecahedronVertices, DodecahedronPolygons);
 }
 
 FPolyhedronMesh FPolyhedronSeeds::Prism(int32 Sides) {
@@ -222,40 +272,218 @@ FPolyhedronMesh FPolyhedronSeeds::Pyramid(int32 Sides) {
 }
 
 FPolyhedronMesh FPolyhedronSeeds::Tetrahedron() {
-  FPolyhedronMesh Output;
-  Output.Vertices.Reserve(4);
-  Output.Vertices.Add({ 1.0, 1.0, 1.0 });
-  Output.Vertices.Add({ 1.0, -1.0, -1.0 });
-  Output.Vertices.Add({ -1.0, 1.0, -1.0 });
-  Output.Vertices.Add({ -1.0, -1.0, 1.0 });
-
-  Output.Polygons.Reserve(4);
-  Output.Polygons.Add({0, 2, 1});
-  Output.Polygons.Add({0, 3, 2});
-  Output.Polygons.Add({0, 1, 3});
-  Output.Polygons.Add({1, 2, 3});
-  
-  return Output;
+  return MakeSeed(TetrahedronVertices, TetrahedronPolygons);
 }
 
 FPolyhedronMesh FPolyhedronSeeds::Cube() {
-  FPolyhedronMesh Output;
-  Output.Vertices.Reserve(8);
-  Output.Vertices.Add({ 0.707, 0.707, 0.707 });
-  Output.Vertices.Add({ -0.707, 0.707, 0.707 });
-  Output.Vertices.Add({ -0.707, -0.707, 0.707 });
-  Output.Vertices.Add({ 0.707, -0.707, 0.707 });
-  Output.Vertices.Add({ 0.707, -0.707, -0.707 });
-  Output.Vertices.Add({ 0.707, 0.707, -0.707 });
-  Output.Vertices.Add({ -0.707, 0.707, -0.707 });
-  Output.Vertices.Add({ -0.707, -0.707, -0.707 });
-  
-  Output.Polygons.Reserve(6);
-  Output.Polygons.Add({ 3, 2, 1, 0 });
-  Output.Polygons.Add({ 3, 0, 5, 4 });
-  Output.Polygons.Add({ 0, 1, 6, 5 });
-  Output.Polygons.Add({ 1, 2, 7, 6 });
-  Output.Polygons.Add({ 2, 3, 4, 7 });
-  Output.Polygons.Add({ 5, 6, 7, 4 });
-  return Output;
+  return MakeSeed(CubeVertices, CubePolygons);
+}
+
+namespace {
+  // Points of the triangular lattice, in axial coordinates: (A, B) stands for A * (1, 0) + B * (1/2, sqrt(3)/2).
+  using FLatticePoint = FInt64Point;
+
+  FLatticePoint RotateLattice60(const FLatticePoint& Point, int32 Turns) {
+    FLatticePoint Output = Point;
+    for (int32 Turn = 0; Turn < (Turns % 6 + 6) % 6; ++Turn) {
+      Output = FLatticePoint(-Output.Y, Output.X + Output.Y);
+    }
+    return Output;
+  }
+
+  int64 LatticeDeterminant(const FLatticePoint& Vector1, const FLatticePoint& Vector2) {
+    return Vector1.X * Vector2.Y - Vector1.Y * Vector2.X;
+  }
+
+  // The barycentric coordinates of a point in a lattice triangle, scaled to add up to twice its area.
+  void GetLatticeBarycentrics(const FLatticePoint (&Corners)[3], const FLatticePoint& Point, int64 (&OutBarycentrics)[3]) {
+    for (int32 Corner = 0; Corner < 3; ++Corner) {
+      OutBarycentrics[Corner] = LatticeDeterminant(Corners[(Corner + 1) % 3] - Point, Corners[(Corner + 2) % 3] - Point);
+    }
+  }
+
+  // Builds the geodesic polyhedron of class (M, N): each face of the icosahedron is laid on the triangular lattice, with corners at
+  // (0, 0), (M, N) and (M, N) rotated by 60 degrees. Lattice triangles that straddle the icosahedron edges are stitched by unfolding
+  // the neighboring face across the edge. Every lattice point and triangle is visited a bounded number of times.
+  FPolyhedronMesh Geodesic(int32 M, int32 N) {
+    FPolyhedronMesh Icosahedron = FPolyhedronSeeds::Icosahedron();
+    const int32 IcosahedronVertexCount = Icosahedron.Vertices.Num();
+    const int32 IcosahedronFaceCount = Icosahedron.Polygons.Num();
+
+    // Each face uses the same lattice frame.
+    const FLatticePoint Corners[3] = { FLatticePoint(0, 0), FLatticePoint(M, N), RotateLattice60(FLatticePoint(M, N), 1) };
+    const int64 Triangulation = LatticeDeterminant(Corners[1], Corners[2]); // T = M^2 + MN + N^2
+    const int32 EdgeDivisions = FMath::GreatestCommonDivisor(M, N); // Lattice points split each icosahedron edge into this many segments.
+    const int64 EdgeStep = Triangulation / EdgeDivisions;
+
+    // Number the icosahedron edges and find the two faces along each of them.
+    TArray<int32> EdgeIndices;
+    EdgeIndices.Init(INDEX_NONE, IcosahedronVertexCount * IcosahedronVertexCount);
+    TArray<TPair<int32, int32>> EdgeFaces;
+    for (int32 FaceIndex = 0; FaceIndex < IcosahedronFaceCount; ++FaceIndex) {
+      const TArray<int32>& FaceVertices = Icosahedron.Polygons[FaceIndex].VertexIndices;
+      for (int32 Corner = 0; Corner < 3; ++Corner) {
+        int32 Vertex1 = FaceVertices[Corner], Vertex2 = FaceVertices[(Corner + 1) % 3];
+        int32& EdgeIndex = EdgeIndices[FMath::Min(Vertex1, Vertex2) * IcosahedronVertexCount + FMath::Max(Vertex1, Vertex2)];
+        if (EdgeIndex == INDEX_NONE) {
+          EdgeIndex = EdgeFaces.Add({ FaceIndex, INDEX_NONE });
+        } else {
+          EdgeFaces[EdgeIndex].Value = FaceIndex;
+        }
+      }
+    }
+    auto GetEdgeIndex = [&] (int32 Vertex1, int32 Vertex2) { return EdgeIndices[FMath::Min(Vertex1, Vertex2) * IcosahedronVertexCount + FMath::Max(Vertex1, Vertex2)]; };
+
+    // Number the lattice points strictly inside a face; this numbering is the same for every face.
+    const FLatticePoint BoxMin(-N, 0), BoxMax(M, M + N);
+    const int64 BoxWidth = BoxMax.X - BoxMin.X + 1;
+    auto GetBoxIndex = [&] (const FLatticePoint& Point) { return static_cast<int32>((Point.X - BoxMin.X) + (Point.Y - BoxMin.Y) * BoxWidth); };
+    TArray<int32> InteriorIndices;
+    InteriorIndices.Init(INDEX_NONE, static_cast<int32>(BoxWidth * (BoxMax.Y - BoxMin.Y + 1)));
+    TArray<FLatticePoint> InteriorPoints;
+    for (int64 B = BoxMin.Y; B <= BoxMax.Y; ++B) {
+      for (int64 A = BoxMin.X; A <= BoxMax.X; ++A) {
+        int64 Barycentrics[3];
+        GetLatticeBarycentrics(Corners, FLatticePoint(A, B), Barycentrics);
+        if (Barycentrics[0] > 0 && Barycentrics[1] > 0 && Barycentrics[2] > 0) {
+          InteriorIndices[GetBoxIndex(FLatticePoint(A, B))] = InteriorPoints.Add(FLatticePoint(A, B));
+        }
+      }
+    }
+
+    // The corners come first, then the points along the edges, then the points inside the faces.
+    const int32 EdgeVertexOffset = IcosahedronVertexCount;
+    const int32 FaceVertexOffset = EdgeVertexOffset + EdgeFaces.Num() * (EdgeDivisions - 1);
+    FPolyhedronMesh Output;
+    Output.Vertices.SetNum(FaceVertexOffset + IcosahedronFaceCount * InteriorPoints.Num());
+    check(Output.Vertices.Num() == 10 * Triangulation + 2);
+
+    for (int32 VertexIndex = 0; VertexIndex < IcosahedronVertexCount; ++VertexIndex) {
+      Output.Vertices[VertexIndex] = Icosahedron.Vertices[VertexIndex].GetSafeNormal();
+    }
+    for (int32 Vertex1 = 0; Vertex1 < IcosahedronVertexCount; ++Vertex1) {
+      for (int32 Vertex2 = Vertex1 + 1; Vertex2 < IcosahedronVertexCount; ++Vertex2) {
+        int32 EdgeIndex = GetEdgeIndex(Vertex1, Vertex2);
+        if (EdgeIndex == INDEX_NONE) continue;
+        for (int32 Division = 1; Division < EdgeDivisions; ++Division) {
+          double Alpha = static_cast<double>(Division) / static_cast<double>(EdgeDivisions);
+          Output.Vertices[EdgeVertexOffset + EdgeIndex * (EdgeDivisions - 1) + Division - 1] = FMath::Lerp(Icosahedron.Vertices[Vertex1], Icosahedron.Vertices[Vertex2], Alpha).GetSafeNormal();
+        }
+      }
+    }
+    for (int32 FaceIndex = 0; FaceIndex < IcosahedronFaceCount; ++FaceIndex) {
+      const TArray<int32>& FaceVertices = Icosahedron.Polygons[FaceIndex].VertexIndices;
+      for (int32 InteriorIndex = 0; InteriorIndex < InteriorPoints.Num(); ++InteriorIndex) {
+        int64 Barycentrics[3];
+        GetLatticeBarycentrics(Corners, InteriorPoints[InteriorIndex], Barycentrics);
+        FVector Position = FVector::ZeroVector;
+        for (int32 Corner = 0; Corner < 3; ++Corner) {
+          Position += static_cast<double>(Barycentrics[Corner]) * Icosahedron.Vertices[FaceVertices[Corner]];
+        }
+        Output.Vertices[FaceVertexOffset + FaceIndex * InteriorPoints.Num() + InteriorIndex] = Position.GetSafeNormal();
+      }
+    }
+
+    // Finds the vertex of a lattice point inside a face, or on its boundary.
+    auto GetVertexIndex = [&] (int32 FaceIndex, const FLatticePoint& Point) -> int32 {
+      const TArray<int32>& FaceVertices = Icosahedron.Polygons[FaceIndex].VertexIndices;
+      int64 Barycentrics[3];
+      GetLatticeBarycentrics(Corners, Point, Barycentrics);
+      check(Barycentrics[0] >= 0 && Barycentrics[1] >= 0 && Barycentrics[2] >= 0);
+      for (int32 Corner = 0; Corner < 3; ++Corner) {
+        if (Barycentrics[Corner] == Triangulation) return FaceVertices[Corner];
+      }
+      for (int32 Corner = 0; Corner < 3; ++Corner) {
+        if (Barycentrics[Corner] != 0) continue;
+        // On the edge across this corner, numbered from its lowest icosahedron vertex.
+        int32 Corner1 = (Corner + 1) % 3, Corner2 = (Corner + 2) % 3;
+        int32 HighCorner = FaceVertices[Corner1] > FaceVertices[Corner2] ? Corner1 : Corner2;
+        int32 Division = static_cast<int32>(Barycentrics[HighCorner] / EdgeStep);
+        return EdgeVertexOffset + GetEdgeIndex(FaceVertices[Corner1], FaceVertices[Corner2]) * (EdgeDivisions - 1) + Division - 1;
+      }
+      int32 InteriorIndex = InteriorIndices[GetBoxIndex(Point)];
+      return FaceVertexOffset + FaceIndex * InteriorPoints.Num() + InteriorIndex;
+    };
+
+    // Across each edge of each face, the neighbor face is unfolded into the plane of the face: a rotation and a translation of the lattice.
+    struct FNeighborFrame {
+      int32 FaceIndex;
+      int32 Turns;
+      FLatticePoint Origin, NeighborOrigin;
+    };
+    TArray<FNeighborFrame> NeighborFrames;
+    NeighborFrames.SetNum(IcosahedronFaceCount * 3);
+    for (int32 FaceIndex = 0; FaceIndex < IcosahedronFaceCount; ++FaceIndex) {
+      const TArray<int32>& FaceVertices = Icosahedron.Polygons[FaceIndex].VertexIndices;
+      for (int32 Corner = 0; Corner < 3; ++Corner) {
+        int32 Corner1 = (Corner + 1) % 3, Corner2 = (Corner + 2) % 3;
+        const TPair<int32, int32>& Faces = EdgeFaces[GetEdgeIndex(FaceVertices[Corner1], FaceVertices[Corner2])];
+        int32 NeighborFaceIndex = Faces.Key == FaceIndex ? Faces.Value : Faces.Key;
+        const TArray<int32>& NeighborVertices = Icosahedron.Polygons[NeighborFaceIndex].VertexIndices;
+        int32 NeighborCorner1 = NeighborVertices.IndexOfByKey(FaceVertices[Corner1]);
+        int32 NeighborCorner2 = NeighborVertices.IndexOfByKey(FaceVertices[Corner2]);
+
+        FNeighborFrame& Frame = NeighborFrames[FaceIndex * 3 + Corner];
+        Frame.FaceIndex = NeighborFaceIndex;
+        Frame.Turns = INDEX_NONE;
+        Frame.Origin = Corners[Corner1];
+        Frame.NeighborOrigin = Corners[NeighborCorner1];
+        for (int32 Turns = 0; Turns < 6; ++Turns) {
+          if (RotateLattice60(Corners[NeighborCorner2] - Corners[NeighborCorner1], Turns) == Corners[Corner2] - Corners[Corner1]) {
+            Frame.Turns = Turns;
+            break;
+          }
+        }
+        check(Frame.Turns != INDEX_NONE); // The icosahedron faces are not consistently wound if this check triggers.
+      }
+    }
+
+    // Each lattice triangle belongs to the face that contains its centroid. The triangles centered on an edge go to the face with the lowest index.
+    Output.Polygons.Reserve(static_cast<int32>(20 * Triangulation));
+    for (int32 FaceIndex = 0; FaceIndex < IcosahedronFaceCount; ++FaceIndex) {
+      auto GetTriangleVertexIndex = [&] (const FLatticePoint& Point) -> int32 {
+        int64 Barycentrics[3];
+        GetLatticeBarycentrics(Corners, Point, Barycentrics);
+        for (int32 Corner = 0; Corner < 3; ++Corner) {
+          if (Barycentrics[Corner] >= 0) continue;
+          const FNeighborFrame& Frame = NeighborFrames[FaceIndex * 3 + Corner];
+          return GetVertexIndex(Frame.FaceIndex, RotateLattice60(Point - Frame.Origin, 6 - Frame.Turns) + Frame.NeighborOrigin);
+        }
+        return GetVertexIndex(FaceIndex, Point);
+      };
+
+      auto AddTriangle = [&] (const FLatticePoint& Point1, const FLatticePoint& Point2, const FLatticePoint& Point3) {
+        // Test the centroid, in lattice coordinates scaled by 3.
+        const FLatticePoint ScaledCorners[3] = { Corners[0] * 3, Corners[1] * 3, Corners[2] * 3 };
+        int64 Barycentrics[3];
+        GetLatticeBarycentrics(ScaledCorners, Point1 + Point2 + Point3, Barycentrics);
+        for (int32 Corner = 0; Corner < 3; ++Corner) {
+          if (Barycentrics[Corner] < 0) return;
+          if (Barycentrics[Corner] == 0 && NeighborFrames[FaceIndex * 3 + Corner].FaceIndex < FaceIndex) return;
+        }
+        Output.Polygons.Add({ GetTriangleVertexIndex(Point1), GetTriangleVertexIndex(Point2), GetTriangleVertexIndex(Point3) });
+      };
+
+      // Both orientations of lattice triangles keep the winding of the face.
+      for (int64 B = BoxMin.Y - 1; B <= BoxMax.Y; ++B) {
+        for (int64 A = BoxMin.X - 1; A <= BoxMax.X; ++A) {
+          AddTriangle(FLatticePoint(A, B), FLatticePoint(A + 1, B), FLatticePoint(A, B + 1));
+          AddTriangle(FLatticePoint(A + 1, B), FLatticePoint(A + 1, B + 1), FLatticePoint(A, B + 1));
+        }
+      }
+    }
+    check(Output.Polygons.Num() == 20 * Triangulation);
+
+    return Output;
+  }
+}
+
+FPolyhedronMesh FPolyhedronSeeds::Goldberg(int32 M, int32 N) {
+  if (M < 0 || N < 0 || M + N < 1) {
+    REPORT_ERROR("Cannot build a Goldberg polyhedron of class (%d, %d)", M, N);
+    return FPolyhedronMesh();
+  }
+
+  // The Goldberg polyhedron GP(M, N) is the dual of the geodesic polyhedron of the same class.
+  return FPolyhedronOperations::Dual(Geodesic(M, N));
 }
@@ -0,0 +1,494 @@
+// Copyright 2024 TabbyCoder
+
+#include "PolyhedronStreaming.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Helpers.h"
+#include "PolyhedronTools.h"
+#include <atomic>
+
+namespace {
+  TAutoConsoleVariable<int32> CVarPolyhedronStreamingMaxJobs(
+    TEXT("Polyhedron.Streaming.MaxJobs"),
+    4,
+    TEXT("Number of tiles that each streamed polyhedron generates concurrently, on worker threads."),
+    ECVF_Default);
+
+  uint64 MakeHalfEdgeKey(int32 VertexFrom, int32 VertexTo) {
+    return (static_cast<uint64>(static_cast<uint32>(VertexFrom)) << 32) | static_cast<uint64>(static_cast<uint32>(VertexTo));
+  }
+
+  double GetAngle(const FVector& Direction1, const FVector& Direction2) {
+    return FMath::Acos(FMath::Clamp(Direction1.GetSafeNormal().Dot(Direction2.GetSafeNormal()), -1.0, 1.0));
+  }
+
+  // The largest angle that a polygon of the polyhedron spans: twice the largest angle between a polygon center and its vertices.
+  double GetPolygonAngle(const FPolyhedronMesh& Polyhedron) {
+    TArray<FVector> PolygonCenters = FPolyhedronTools::GetPolygonCenters(Polyhedron);
+    double PolygonAngle = 0.0;
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.Polygons.Num(); ++PolygonIndex) {
+      for (int32 VertexIndex : Polyhedron.Polygons[PolygonIndex].VertexIndices) {
+        PolygonAngle = FMath::Max(PolygonAngle, 2.0 * GetAngle(PolygonCenters[PolygonIndex], Polyhedron.Vertices[VertexIndex]));
+      }
+    }
+    return PolygonAngle;
+  }
+
+  // Predicts the angle that a polygon spans at each depth, which shrinks with the square root of the polygon count, and
+  // how far each step spreads the influence of a cap: about one ring of polygons per primitive operation, see
+  // FPolyhedronTools::GetPrimitiveOperationCount(), at the larger of the step's input and output polygons.
+  void PredictStepSpreads(const FPolyhedronMesh& Polyhedron, TArrayView<const FPolyhedronNotationStep> Steps, TArray<double>& OutDepthPolygonAngles, TArray<double>& OutStepSpreads) {
+    FPolyhedronMeshSize Size = FPolyhedronMeshSize::Measure(Polyhedron);
+    double BasePolygonCount = static_cast<double>(FMath::Max<int64>(Size.PolygonCount, 1));
+    double BasePolygonAngle = GetPolygonAngle(Polyhedron);
+    OutDepthPolygonAngles.Reset(Steps.Num() + 1);
+    OutStepSpreads.Reset(Steps.Num());
+    OutDepthPolygonAngles.Add(BasePolygonAngle);
+    for (const FPolyhedronNotationStep& Step : Steps) {
+      Size = FPolyhedronOperations::PredictOperation(Size, Step.Symbol, Step.Argument);
+      double PolygonAngle = BasePolygonAngle * FMath::Sqrt(BasePolygonCount / static_cast<double>(FMath::Max<int64>(Size.PolygonCount, 1)));
+      OutStepSpreads.Add(FMath::Max(OutDepthPolygonAngles.Last(), PolygonAngle) * FPolyhedronTools::GetPrimitiveOperationCount(Step.Symbol));
+      OutDepthPolygonAngles.Add(PolygonAngle);
+    }
+  }
+
+  int64 GetTileAllocatedSize(const FPolyhedronStreamingTile& Tile) {
+    int64 Size = Tile.Polyhedron.Vertices.GetAllocatedSize() + Tile.Polyhedron.Polygons.GetAllocatedSize();
+    for (const FPolyhedronPolygon& Polygon : Tile.Polyhedron.Polygons) {
+      Size += Polygon.VertexIndices.GetAllocatedSize();
+    }
+    const FPolyhedronSection& Section = Tile.Section;
+    return Size + Section.Positions.GetAllocatedSize() + Section.Normals.GetAllocatedSize() + Section.UVs.GetAllocatedSize() + Section.Triangles.GetAllocatedSize();
+  }
+}
+
+/**
+ * Everything that the tile generation needs, shared with the worker threads and never modified once built.
+ */
+struct FPolyhedronStreamer::FBase {
+  TArray<FPolyhedronNotationStep> RefinementSteps;
+  FPolyhedronOperationParameters Parameters;
+  EPolyhedronUVGeneration UVGeneration = EPolyhedronUVGeneration::Spherical;
+  double Scale = 100.0;
+  // The base level, as the operations left it, then scaled.
+  FPolyhedronMesh Polyhedron;
+  FPolyhedronMesh ScaledPolyhedron;
+  // Per tile: the direction of its center, the largest angle between its center and its vertices, and the polygons
+  // within two rings of it, the only ones that may compete for its polygons.
+  TArray<FVector> TileDirections;
+  TArray<double> TileAngles;
+  TArray<TArray<int32>> TileNeighbors;
+  // Per depth, the angle that a polygon spans at most, and per refinement step, how far it spreads the influence of a cap.
+  TArray<double> DepthPolygonAngles;
+  TArray<double> StepSpreads;
+  // Per depth: the factor that scales the full polyhedron to its sphere, and the estimated size of a tile.
+  TArray<double> DepthScaleFactors;
+  TArray<int64> DepthTileSizes;
+  TArray<TSharedPtr<const FPolyhedronStreamingTile, ESPMode::ThreadSafe>> DepthZeroTiles;
+
+  int32 GetMaxDepth() const { return RefinementSteps.Num(); }
+
+  // A polygon belongs to the tile whose center is the closest to it; ties go to the lowest tile index.
+  bool IsOwnedBy(int32 TileIndex, const FVector& Position) const {
+    FVector Direction = Position.GetSafeNormal();
+    double TileDot = Direction.Dot(TileDirections[TileIndex]);
+    for (int32 NeighborIndex : TileNeighbors[TileIndex]) {
+      double NeighborDot = Direction.Dot(TileDirections[NeighborIndex]);
+      if (NeighborDot > TileDot || (NeighborDot == TileDot && NeighborIndex < TileIndex)) return false;
+    }
+    return true;
+  }
+
+  // The angle around the tile within which a patch at PatchDepth keeps every polygon that the tile owns at Depth.
+  double GetMargin(int32 TileIndex, int32 PatchDepth, int32 Depth) const {
+    double Margin = TileAngles[TileIndex] + DepthPolygonAngles[PatchDepth];
+    for (int32 StepIndex = PatchDepth; StepIndex < Depth; ++StepIndex) {
+      Margin += StepSpreads[StepIndex];
+    }
+    return Margin;
+  }
+
+  // Cuts the untainted polygons of Input within the margin of the tile. Fails when they make up more than half of Input.
+  bool TrimPatch(int32 TileIndex, int32 PatchDepth, int32 Depth, const FPolyhedronMesh& Input, const TBitArray<>& Tainted, FPolyhedronMesh& OutPatch, TBitArray<>& OutTainted) const {
+    double Margin = GetMargin(TileIndex, PatchDepth, Depth);
+    TArray<FVector> PolygonCenters = FPolyhedronTools::GetPolygonCenters(Input);
+    TBitArray<> Selection(false, Input.Polygons.Num());
+    for (int32 PolygonIndex = 0; PolygonIndex < Input.Polygons.Num(); ++PolygonIndex) {
+      if (Input.Polygons[PolygonIndex].VertexIndices.ContainsByPredicate([&] (int32 VertexIndex) { return Tainted[VertexIndex]; })) continue;
+      Selection[PolygonIndex] = GetAngle(TileDirections[TileIndex], PolygonCenters[PolygonIndex]) <= Margin;
+    }
+    return Selection.CountSetBits() * 2 <= Input.Polygons.Num() && FPolyhedronTools::CutPatch(Input, MoveTemp(Selection), OutPatch, OutTainted);
+  }
+
+  // Applies the first Depth refinement steps on a patch around the tile, calling OnDepth after each one and on the
+  // patch itself. The polygons without tainted vertices are exactly the ones that the full polyhedron has.
+  // Each depth is refined from the patch of the previous one, trimmed to the margin that the remaining steps need, and
+  // the whole polyhedron is never refined: fails when the base level cannot be cut around the tile.
+  bool RefinePatch(int32 TileIndex, int32 Depth, const std::atomic<bool>* bCancelled, TFunctionRef<void(int32 PatchDepth, const FPolyhedronMesh& Patch, const TBitArray<>& Tainted)> OnDepth) const {
+    FPolyhedronMesh Patch;
+    TBitArray<> Tainted;
+    if (!TrimPatch(TileIndex, 0, Depth, Polyhedron, TBitArray<>(false, Polyhedron.Vertices.Num()), Patch, Tainted)) return false;
+
+    OnDepth(0, Patch, Tainted);
+    for (int32 StepIndex = 0; StepIndex < Depth; ++StepIndex) {
+      if (bCancelled != nullptr && bCancelled->load(std::memory_order_relaxed)) return false;
+      FPolyhedronOperationRecorder Recorder;
+      FPolyhedronMesh Refined = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(RefinementSteps[StepIndex], Patch, Parameters, &Recorder);
+      TBitArray<> RefinedTainted = FPolyhedronTools::PropagateTaint(MoveTemp(Tainted), Recorder);
+      OnDepth(StepIndex + 1, Refined, RefinedTainted);
+
+      // A trimmed patch that fails to cut is still within the margin of the coarser depth.
+      if (StepIndex + 1 == Depth || !TrimPatch(TileIndex, StepIndex + 1, Depth, Refined, RefinedTainted, Patch, Tainted)) {
+        Patch = MoveTemp(Refined);
+        Tainted = MoveTemp(RefinedTainted);
+      }
+    }
+    return true;
+  }
+
+  // Keeps the untainted polygons of the patch that the tile owns, then hangs the skirt from their rim.
+  FPolyhedronStreamingTile MakeTile(int32 TileIndex, int32 Depth, const FPolyhedronMesh& Patch, const TBitArray<>& Tainted) const {
+    FPolyhedronStreamingTile Tile;
+    Tile.TileIndex = TileIndex;
+    Tile.Depth = Depth;
+    Tile.PatchPolygonCount = Patch.Polygons.Num();
+
+    double ScaleFactor = DepthScaleFactors[Depth];
+    TArray<int32> TileVertexIndices;
+    TileVertexIndices.Init(INDEX_NONE, Patch.Vertices.Num());
+    for (const FPolyhedronPolygon& Polygon : Patch.Polygons) {
+      if (Polygon.VertexIndices.ContainsByPredicate([&] (int32 VertexIndex) { return Tainted[VertexIndex]; })) continue;
+      if (!IsOwnedBy(TileIndex, FPolyhedronTools::GetPolygonCenter(Patch, Polygon))) continue;
+
+      FPolyhedronPolygon& TilePolygon = Tile.Polyhedron.Polygons.AddDefaulted_GetRef();
+      TilePolygon.VertexIndices.Reserve(Polygon.VertexIndices.Num());
+      for (int32 VertexIndex : Polygon.VertexIndices) {
+        if (TileVertexIndices[VertexIndex] == INDEX_NONE) {
+          TileVertexIndices[VertexIndex] = Tile.Polyhedron.Vertices.Add(Patch.Vertices[VertexIndex] * ScaleFactor);
+        }
+        TilePolygon.VertexIndices.Add(TileVertexIndices[VertexIndex]);
+      }
+    }
+
+    // The neighbor tiles may be at other depths, where the rims do not match: a skirt as deep as the longest edge,
+    // hanging towards the center of the polyhedron, hides the cracks in between.
+    TSet<uint64> HalfEdges;
+    double LongestEdge = 0.0;
+    for (const FPolyhedronPolygon& Polygon : Tile.Polyhedron.Polygons) {
+      int32 VertexFrom = Polygon.VertexIndices.Last();
+      for (int32 VertexTo : Polygon.VertexIndices) {
+        HalfEdges.Add(MakeHalfEdgeKey(VertexFrom, VertexTo));
+        LongestEdge = FMath::Max(LongestEdge, FVector::Dist(Tile.Polyhedron.Vertices[VertexFrom], Tile.Polyhedron.Vertices[VertexTo]));
+        VertexFrom = VertexTo;
+      }
+    }
+    FPolyhedronMesh Skirted = Tile.Polyhedron;
+    TMap<int32, int32> SkirtVertexIndices;
+    auto GetSkirtVertexIndex = [&] (int32 VertexIndex) -> int32 {
+      if (const int32* SkirtVertexIndex = SkirtVertexIndices.Find(VertexIndex)) return *SkirtVertexIndex;
+      FVector SkirtVertex = Skirted.Vertices[VertexIndex] - LongestEdge * Skirted.Vertices[VertexIndex].GetSafeNormal();
+      return SkirtVertexIndices.Add(VertexIndex, Skirted.Vertices.Add(SkirtVertex));
+    };
+    for (const FPolyhedronPolygon& Polygon : Tile.Polyhedron.Polygons) {
+      int32 VertexFrom = Polygon.VertexIndices.Last();
+      for (int32 VertexTo : Polygon.VertexIndices) {
+        if (!HalfEdges.Contains(MakeHalfEdgeKey(VertexTo, VertexFrom))) {
+          // Runs against the rim half-edge, like a neighbor polygon would.
+          Skirted.Polygons.Add(FPolyhedronPolygon({ VertexTo, VertexFrom, GetSkirtVertexIndex(VertexFrom), GetSkirtVertexIndex(VertexTo) }));
+        }
+        VertexFrom = VertexTo;
+      }
+    }
+
+    FPolyhedronSectionBuilder SectionBuilder(Skirted, UVGeneration);
+    SectionBuilder.Build();
+    if (SectionBuilder.GetSections().Num() > 0) {
+      Tile.Section = MoveTemp(SectionBuilder.GetSections()[0]);
+    }
+    Tile.AllocatedSize = GetTileAllocatedSize(Tile);
+    return Tile;
+  }
+
+  // Returns a tile without TileIndex when no patch around the tile is small enough for that depth.
+  FPolyhedronStreamingTile GenerateTile(int32 TileIndex, int32 Depth, const std::atomic<bool>* bCancelled = nullptr) const {
+    // The base level of a tile is its own polygon.
+    if (Depth == 0) {
+      const FPolyhedronPolygon& Polygon = Polyhedron.Polygons[TileIndex];
+      FPolyhedronMesh Patch;
+      FPolyhedronPolygon& PatchPolygon = Patch.Polygons.AddDefaulted_GetRef();
+      PatchPolygon.MaterialIndex = Polygon.MaterialIndex;
+      for (int32 VertexIndex : Polygon.VertexIndices) {
+        PatchPolygon.VertexIndices.Add(Patch.Vertices.Add(Polyhedron.Vertices[VertexIndex]));
+      }
+      return MakeTile(TileIndex, 0, Patch, TBitArray<>(false, Patch.Vertices.Num()));
+    }
+
+    FPolyhedronStreamingTile Tile;
+    RefinePatch(TileIndex, Depth, bCancelled, [&] (int32 PatchDepth, const FPolyhedronMesh& Patch, const TBitArray<>& Tainted) {
+      if (PatchDepth == Depth) {
+        Tile = MakeTile(TileIndex, Depth, Patch, Tainted);
+      }
+    });
+    return Tile;
+  }
+};
+
+/**
+ * One tile generated on a worker thread. The worker only writes Tile before raising bDone.
+ */
+struct FPolyhedronStreamer::FJob {
+  int32 TileIndex = INDEX_NONE;
+  int32 Depth = 0;
+  std::atomic<bool> bCancelled = false;
+  std::atomic<bool> bDone = false;
+  TSharedPtr<const FPolyhedronStreamingTile, ESPMode::ThreadSafe> Tile;
+};
+
+FPolyhedronStreamer::FPolyhedronStreamer(const FString& ConwayPolyhedronNotation, float Scale, EPolyhedronUVGeneration UVGeneration, const FPolyhedronOperationParameters& OperationParameters, int32 BasePolygonCount) {
+  TArray<FPolyhedronNotationStep> Steps;
+  if (!FPolyhedronTools::ParseConwayPolyhedronNotation(ConwayPolyhedronNotation, Steps)) return;
+
+  // Apply the base steps on the full polyhedron. Canonicalization and reflection move every vertex of the polyhedron,
+  // so a patch never spans them. The patch that refines a tile to the full depth must also stay within a third of the
+  // polyhedron, far from the half where CutPatch() fails: too coarse a base level takes more steps.
+  TSharedRef<FBase, ESPMode::ThreadSafe> NewBase = MakeShared<FBase, ESPMode::ThreadSafe>();
+  int32 LastGlobalStepIndex = Steps.FindLastByPredicate([] (const FPolyhedronNotationStep& Step) { return Step.Symbol == 'K' || Step.Symbol == 'r'; });
+  FPolyhedronMesh Polyhedron = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Steps[0], FPolyhedronMesh(), OperationParameters);
+  const double MaxMargin = FMath::Acos(1.0 / 3.0);
+  // Only the base steps run on the full polyhedron: they alone must fit in the memory budget.
+  FPolyhedronMeshSize PredictedSize;
+  bool bPredicted = FPolyhedronTools::PredictConwayPolyhedronNotation(MakeArrayView(Steps).Left(1), PredictedSize);
+  int32 StepIndex = 1;
+  for (; StepIndex < Steps.Num(); ++StepIndex) {
+    if (StepIndex > LastGlobalStepIndex && Polyhedron.Polygons.Num() >= BasePolygonCount) {
+      TArray<double> DepthPolygonAngles, StepSpreads;
+      PredictStepSpreads(Polyhedron, MakeArrayView(Steps).RightChop(StepIndex), DepthPolygonAngles, StepSpreads);
+      // The largest tile spans half of the polygon angle from its center, see FBase::GetMargin().
+      double Margin = 1.5 * DepthPolygonAngles[0];
+      for (double StepSpread : StepSpreads) {
+        Margin += StepSpread;
+      }
+      if (Margin <= MaxMargin) break;
+    }
+    if (bPredicted) {
+      PredictedSize = FPolyhedronOperations::PredictOperation(PredictedSize, Steps[StepIndex].Symbol, Steps[StepIndex].Argument);
+      if (!FPolyhedronTools::CheckMemoryBudget(PredictedSize)) return;
+    }
+    Polyhedron = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Steps[StepIndex], Polyhedron, OperationParameters);
+  }
+  REPORT_ERROR_IF(Polyhedron.Polygons.Num() == 0, "ConwayPolyhedronNotation makes no Polyhedron");
+  PredictStepSpreads(Polyhedron, MakeArrayView(Steps).RightChop(StepIndex), NewBase->DepthPolygonAngles, NewBase->StepSpreads);
+
+  NewBase->RefinementSteps = TArray<FPolyhedronNotationStep>(Steps.GetData() + StepIndex, Steps.Num() - StepIndex);
+  NewBase->Parameters = OperationParameters;
+  NewBase->UVGeneration = UVGeneration;
+  NewBase->Scale = Scale;
+  NewBase->Polyhedron = MoveTemp(Polyhedron);
+
+  // Measure the tiles, and find their neighbors through the vertices they share.
+  const FPolyhedronMesh& BasePolyhedron = NewBase->Polyhedron;
+  int32 TileCount = BasePolyhedron.Polygons.Num();
+  TArray<TArray<int32>> VertexPolygons;
+  VertexPolygons.SetNum(BasePolyhedron.Vertices.Num());
+  NewBase->TileDirections = FPolyhedronTools::GetPolygonCenters(BasePolyhedron);
+  NewBase->TileAngles.Init(0.0, TileCount);
+  for (int32 TileIndex = 0; TileIndex < TileCount; ++TileIndex) {
+    NewBase->TileDirections[TileIndex].Normalize();
+    for (int32 VertexIndex : BasePolyhedron.Polygons[TileIndex].VertexIndices) {
+      NewBase->TileAngles[TileIndex] = FMath::Max(NewBase->TileAngles[TileIndex], GetAngle(NewBase->TileDirections[TileIndex], BasePolyhedron.Vertices[VertexIndex]));
+      VertexPolygons[VertexIndex].Add(TileIndex);
+    }
+  }
+  NewBase->TileNeighbors.SetNum(TileCount);
+  for (int32 TileIndex = 0; TileIndex < TileCount; ++TileIndex) {
+    TArray<int32>& Neighbors = NewBase->TileNeighbors[TileIndex];
+    for (int32 Ring = 0; Ring < 2; ++Ring) {
+      TArray<int32> RingTiles = Ring == 0 ? TArray<int32>({ TileIndex }) : Neighbors;
+      for (int32 RingTileIndex : RingTiles) {
+        for (int32 VertexIndex : BasePolyhedron.Polygons[RingTileIndex].VertexIndices) {
+          for (int32 NeighborIndex : VertexPolygons[VertexIndex]) {
+            if (NeighborIndex != TileIndex) Neighbors.AddUnique(NeighborIndex);
+          }
+        }
+      }
+    }
+  }
+
+  // The base level scales like the full polyhedron would.
+  double FurthestVertexDistance = 0.0;
+  for (const FVector& Vertex : BasePolyhedron.Vertices) {
+    FurthestVertexDistance = FMath::Max(FurthestVertexDistance, Vertex.Size());
+  }
+  REPORT_ERROR_IF(FurthestVertexDistance <= 0.0, "ConwayPolyhedronNotation makes a degenerate Polyhedron");
+  int32 MaxDepth = NewBase->GetMaxDepth();
+  NewBase->DepthScaleFactors.Init(Scale / FurthestVertexDistance, MaxDepth + 1);
+  NewBase->DepthTileSizes.Init(0, MaxDepth + 1);
+  NewBase->ScaledPolyhedron = BasePolyhedron;
+  for (FVector& Vertex : NewBase->ScaledPolyhedron.Vertices) {
+    Vertex *= NewBase->DepthScaleFactors[0];
+  }
+
+  // Calibrate the finer depths on the first tile: the radius of its untainted vertices gives the scale of each depth,
+  // and its size the estimated size of every tile at that depth. Without finer depths, there is no patch to cut.
+  if (MaxDepth == 0) {
+    NewBase->DepthTileSizes[0] = NewBase->GenerateTile(0, 0).AllocatedSize;
+  } else {
+    bool bCalibrated = NewBase->RefinePatch(0, MaxDepth, nullptr, [&] (int32 Depth, const FPolyhedronMesh& Patch, const TBitArray<>& Tainted) {
+      if (Depth > 0) {
+        double UntaintedVertexDistance = 0.0;
+        for (int32 VertexIndex = 0; VertexIndex < Patch.Vertices.Num(); ++VertexIndex) {
+          if (!Tainted[VertexIndex]) UntaintedVertexDistance = FMath::Max(UntaintedVertexDistance, Patch.Vertices[VertexIndex].Size());
+        }
+        if (UntaintedVertexDistance > 0.0) NewBase->DepthScaleFactors[Depth] = Scale / UntaintedVertexDistance;
+      }
+      NewBase->DepthTileSizes[Depth] = NewBase->MakeTile(0, Depth, Patch, Tainted).AllocatedSize;
+    });
+    REPORT_ERROR_IF(!bCalibrated, "Cannot cut a patch around the first tile of the Polyhedron");
+  }
+
+  // The base level of every tile stays at hand, for the tiles far from any viewer.
+  NewBase->DepthZeroTiles.SetNum(TileCount);
+  ParallelFor(TileCount, [&] (int32 TileIndex) {
+    NewBase->DepthZeroTiles[TileIndex] = MakeShared<const FPolyhedronStreamingTile, ESPMode::ThreadSafe>(NewBase->GenerateTile(TileIndex, 0));
+  });
+
+  Base = NewBase;
+  ResidentTiles = Base->DepthZeroTiles;
+  TargetDepths.Init(0, TileCount);
+  TileMaxDepths.Init(Base->GetMaxDepth(), TileCount);
+  for (const TSharedPtr<const FPolyhedronStreamingTile, ESPMode::ThreadSafe>& Tile : ResidentTiles) {
+    ResidentSize += Tile->AllocatedSize;
+  }
+}
+
+FPolyhedronStreamer::~FPolyhedronStreamer() {
+  // The workers hold on to their job and to the base; they only need to stop early.
+  for (const TSharedPtr<FJob, ESPMode::ThreadSafe>& Job : Jobs) {
+    Job->bCancelled = true;
+  }
+}
+
+const FPolyhedronMesh& FPolyhedronStreamer::GetBasePolyhedron() const {
+  return Base->ScaledPolyhedron;
+}
+
+int32 FPolyhedronStreamer::GetTileCount() const {
+  return IsValid() ? Base->Polyhedron.Polygons.Num() : 0;
+}
+
+int32 FPolyhedronStreamer::GetMaxDepth() const {
+  return IsValid() ? Base->GetMaxDepth() : 0;
+}
+
+FPolyhedronStreamingTile FPolyhedronStreamer::GenerateTile(int32 TileIndex, int32 Depth) const {
+  REPORT_ERROR_RETURN_IF(!IsValid(), FPolyhedronStreamingTile(), "Invalid FPolyhedronStreamer");
+  REPORT_ERROR_RETURN_IF(TileIndex < 0 || TileIndex >= GetTileCount() || Depth < 0 || Depth > GetMaxDepth(), FPolyhedronStreamingTile(), "No tile %d at depth %d", TileIndex, Depth);
+  FPolyhedronStreamingTile Tile = Base->GenerateTile(TileIndex, Depth);
+  if (Tile.TileIndex == INDEX_NONE) REPORT_ERROR("No patch around tile %d is small enough for depth %d", TileIndex, Depth);
+  return Tile;
+}
+
+TArray<int32> FPolyhedronStreamer::Update(TArrayView<const FVector> ViewLocations, const FSettings& Settings) {
+  TArray<int32> ChangedTileIndices;
+  if (!IsValid()) return ChangedTileIndices;
+  int32 TileCount = GetTileCount(), MaxDepth = GetMaxDepth();
+
+  // Measure each tile against the closest viewer: every doubling of the distance past DetailDistance drops one depth.
+  TArray<double> Distances;
+  Distances.Init(TNumericLimits<double>::Max(), TileCount);
+  for (int32 TileIndex = 0; TileIndex < TileCount; ++TileIndex) {
+    FVector TileCenter = Base->TileDirections[TileIndex] * Base->Scale;
+    double TileRadius = Base->TileAngles[TileIndex] * Base->Scale;
+    for (const FVector& ViewLocation : ViewLocations) {
+      Distances[TileIndex] = FMath::Min(Distances[TileIndex], FMath::Max(0.0, FVector::Dist(ViewLocation, TileCenter) - TileRadius));
+    }
+    int32& TargetDepth = TargetDepths[TileIndex];
+    if (ViewLocations.Num() == 0) {
+      TargetDepth = 0;
+    } else if (Distances[TileIndex] <= Settings.DetailDistance) {
+      TargetDepth = MaxDepth;
+    } else {
+      double Doublings = FMath::Log2(Distances[TileIndex] / FMath::Max(Settings.DetailDistance, UE_DOUBLE_KINDA_SMALL_NUMBER));
+      TargetDepth = FMath::Max(0, MaxDepth - static_cast<int32>(FMath::Min(FMath::CeilToDouble(Doublings), static_cast<double>(MaxDepth))));
+    }
+    TargetDepth = FMath::Min(TargetDepth, TileMaxDepths[TileIndex]);
+  }
+
+  // The closest tiles take their share of the memory budget first; the base level of every tile is always resident.
+  TArray<int32> SortedTileIndices;
+  SortedTileIndices.Reserve(TileCount);
+  for (int32 TileIndex = 0; TileIndex < TileCount; ++TileIndex) {
+    SortedTileIndices.Add(TileIndex);
+  }
+  SortedTileIndices.Sort([&] (int32 TileIndex1, int32 TileIndex2) { return Distances[TileIndex1] < Distances[TileIndex2]; });
+  const TArray<int64>& DepthTileSizes = Base->DepthTileSizes;
+  int64 RemainingBudget = Settings.MemoryBudgetBytes - DepthTileSizes[0] * TileCount;
+  for (int32 TileIndex : SortedTileIndices) {
+    int32& TargetDepth = TargetDepths[TileIndex];
+    while (TargetDepth > 0 && DepthTileSizes[TargetDepth] - DepthTileSizes[0] > RemainingBudget) {
+      --TargetDepth;
+    }
+    RemainingBudget -= DepthTileSizes[TargetDepth] - DepthTileSizes[0];
+  }
+
+  auto SetResidentTile = [&] (int32 TileIndex, TSharedPtr<const FPolyhedronStreamingTile, ESPMode::ThreadSafe> Tile) {
+    TSharedPtr<const FPolyhedronStreamingTile, ESPMode::ThreadSafe> EvictedTile = MoveTemp(ResidentTiles[TileIndex]);
+    ResidentSize += Tile->AllocatedSize - EvictedTile->AllocatedSize;
+    ResidentTiles[TileIndex] = MoveTemp(Tile);
+    ChangedTileIndices.Add(TileIndex);
+
+    // Freeing a large tile takes time too: leave it to a worker thread.
+    if (EvictedTile->Depth > 0) {
+      Async(EAsyncExecution::ThreadPool, [EvictedTile = MoveTemp(EvictedTile)] () mutable { EvictedTile.Reset(); });
+    }
+  };
+
+  // Collect the finished tiles that are still wanted, and cancel the jobs that no longer are.
+  for (int32 JobIndex = Jobs.Num() - 1; JobIndex >= 0; --JobIndex) {
+    FJob& Job = *Jobs[JobIndex];
+    bool bWanted = Job.Depth == TargetDepths[Job.TileIndex];
+    if (Job.bDone.load(std::memory_order_acquire)) {
+      if (Job.Tile.IsValid() && Job.Tile->TileIndex == INDEX_NONE) {
+        // No patch was small enough: the tile stays coarser than that depth from now on.
+        TileMaxDepths[Job.TileIndex] = FMath::Min(TileMaxDepths[Job.TileIndex], Job.Depth - 1);
+      } else if (bWanted && Job.Tile.IsValid() && Job.Tile->Depth == Job.Depth) {
+        SetResidentTile(Job.TileIndex, Job.Tile);
+      }
+      Jobs.RemoveAtSwap(JobIndex);
+    } else if (!bWanted) {
+      Job.bCancelled = true;
+      Jobs.RemoveAtSwap(JobIndex);
+    }
+  }
+
+  // The base level needs no job.
+  for (int32 TileIndex = 0; TileIndex < TileCount; ++TileIndex) {
+    if (TargetDepths[TileIndex] == 0 && ResidentTiles[TileIndex]->Depth != 0) {
+      SetResidentTile(TileIndex, Base->DepthZeroTiles[TileIndex]);
+    }
+  }
+
+  // Start the jobs of the closest tiles first; the current tile stays resident until its replacement is done.
+  int32 MaxJobs = FMath::Max(1, CVarPolyhedronStreamingMaxJobs.GetValueOnAnyThread());
+  for (int32 TileIndex : SortedTileIndices) {
+    if (Jobs.Num() >= MaxJobs) break;
+    if (ResidentTiles[TileIndex]->Depth == TargetDepths[TileIndex]) continue;
+    if (Jobs.ContainsByPredicate([TileIndex] (const TSharedPtr<FJob, ESPMode::ThreadSafe>& Job) { return Job->TileIndex == TileIndex; })) continue;
+
+    TSharedPtr<FJob, ESPMode::ThreadSafe> Job = MakeShared<FJob, ESPMode::ThreadSafe>();
+    Job->TileIndex = TileIndex;
+    Job->Depth = TargetDepths[TileIndex];
+    Jobs.Add(Job);
+    Async(EAsyncExecution::ThreadPool, [Job, JobBase = Base] () {
+      if (!Job->bCancelled) {
+        FPolyhedronStreamingTile Tile = JobBase->GenerateTile(Job->TileIndex, Job->Depth, &Job->bCancelled);
+        if (!Job->bCancelled) {
+          Job->Tile = MakeShared<const FPolyhedronStreamingTile, ESPMode::ThreadSafe>(MoveTemp(Tile));
+        }
+      }
+      Job->bDone.store(true, std::memory_order_release);
+    });
+  }
+  return ChangedTileIndices;
+}
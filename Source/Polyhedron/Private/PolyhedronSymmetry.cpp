@@ -0,0 +1,369 @@
+// Copyright 2024 TabbyCoder
+
+#include "PolyhedronSymmetry.h"
+#include "Async/ParallelFor.h"
+#include "Helpers.h"
+#include "PolyhedronTools.h"
+
+namespace {
+  uint64 MakeHalfEdgeKey(int32 VertexFrom, int32 VertexTo) {
+    return (static_cast<uint64>(static_cast<uint32>(VertexFrom)) << 32) | static_cast<uint64>(static_cast<uint32>(VertexTo));
+  }
+
+  FVector Rotate(const FMatrix& Rotation, const FVector& Vector) {
+    return FVector(Rotation.TransformVector(Vector));
+  }
+
+  // Finds the vertices closer than a tolerance, through a grid of cells as large as the tolerance.
+  class FVertexWelder {
+  public:
+    FVertexWelder(TArray<FVector>& InVertices, double InTolerance) : Vertices(InVertices), Tolerance(InTolerance) {}
+
+    int32 Find(const FVector& Position) const {
+      FIntVector Cell = GetCell(Position);
+      for (int32 Z = -1; Z <= 1; ++Z) {
+        for (int32 Y = -1; Y <= 1; ++Y) {
+          for (int32 X = -1; X <= 1; ++X) {
+            const TArray<int32, TInlineAllocator<2>>* CellVertices = Cells.Find(Cell + FIntVector(X, Y, Z));
+            if (CellVertices == nullptr) continue;
+            for (int32 VertexIndex : *CellVertices) {
+              if (FVector::DistSquared(Vertices[VertexIndex], Position) <= Tolerance * Tolerance) return VertexIndex;
+            }
+          }
+        }
+      }
+      return INDEX_NONE;
+    }
+
+    void Add(int32 VertexIndex) {
+      Cells.FindOrAdd(GetCell(Vertices[VertexIndex])).Add(VertexIndex);
+    }
+
+    int32 FindOrAdd(const FVector& Position) {
+      int32 VertexIndex = Find(Position);
+      if (VertexIndex == INDEX_NONE) {
+        VertexIndex = Vertices.Add(Position);
+        Add(VertexIndex);
+      }
+      return VertexIndex;
+    }
+
+  private:
+    FIntVector GetCell(const FVector& Position) const {
+      return FIntVector(static_cast<int32>(FMath::FloorToDouble(Position.X / Tolerance)), static_cast<int32>(FMath::FloorToDouble(Position.Y / Tolerance)), static_cast<int32>(FMath::FloorToDouble(Position.Z / Tolerance)));
+    }
+
+    TArray<FVector>& Vertices;
+    double Tolerance;
+    TMap<FIntVector, TArray<int32, TInlineAllocator<2>>> Cells;
+  };
+
+  // The Dirichlet domain of a point that no rotation fixes: the directions that are closer to the point than to any of
+  // its rotated copies. The rotated domains tile the sphere; each one is bounded by the bisectors of the point and its copies.
+  struct FSymmetryDomain {
+    bool Initialize(const FPolyhedronMesh& Seed) {
+      Rotations = FPolyhedronSymmetry::FindRotations(Seed);
+      if (Rotations.Num() < 2 || Seed.Polygons.Num() == 0) return false;
+
+      // Any point inside a polygon, away from its center and its vertices, is off the rotation axes.
+      const FPolyhedronPolygon& Polygon = Seed.Polygons[0];
+      FVector Center = FPolyhedronTools::GetPolygonCenter(Seed, Polygon);
+      FVector Corner1 = Seed.Vertices[Polygon.VertexIndices[0]] - Center, Corner2 = Seed.Vertices[Polygon.VertexIndices[1]] - Center;
+      for (double Blend : { 0.3, 0.2, 0.1, 0.4 }) {
+        FVector Point = (Center + Blend * Corner1 + 0.5 * Blend * Corner2).GetSafeNormal();
+        BisectorNormals.Reset();
+        for (int32 RotationIndex = 1; RotationIndex < Rotations.Num(); ++RotationIndex) {
+          FVector Bisector = Point - Rotate(Rotations[RotationIndex], Point);
+          if (Bisector.Size() < 1e-2) break;
+          BisectorNormals.Add(Bisector.GetUnsafeNormal());
+        }
+        if (BisectorNormals.Num() == Rotations.Num() - 1) return true;
+      }
+      return false;
+    }
+
+    // Slack widens the domain by about that angle, in radians.
+    bool Contains(const FVector& Position, double Slack) const {
+      FVector Direction = Position.GetSafeNormal();
+      if (Direction.IsZero()) return false;
+      double SlackSine = FMath::Sin(FMath::Min(Slack, UE_DOUBLE_HALF_PI));
+      for (const FVector& BisectorNormal : BisectorNormals) {
+        // Also rejects the NaN directions.
+        if (!(BisectorNormal.Dot(Direction) >= -SlackSine)) return false;
+      }
+      return true;
+    }
+
+    TArray<FMatrix> Rotations;
+    TArray<FVector> BisectorNormals;
+  };
+
+  double GetAngle(const FVector& Direction1, const FVector& Direction2) {
+    return FMath::Acos(FMath::Clamp(Direction1.GetSafeNormal().Dot(Direction2.GetSafeNormal()), -1.0, 1.0));
+  }
+
+  // Every half-edge has a twin, every vertex is used, and the Euler characteristic is the one of a sphere.
+  bool IsClosedSphere(const FPolyhedronMesh& Polyhedron) {
+    TSet<uint64> HalfEdges;
+    TBitArray<> UsedVertices(false, Polyhedron.Vertices.Num());
+    for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+      const TArray<int32>& VertexIndices = Polygon.VertexIndices;
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < VertexIndices.Num(); ++PolygonVertexIndex) {
+        bool bAlreadyInSet = false;
+        HalfEdges.Add(MakeHalfEdgeKey(VertexIndices[(PolygonVertexIndex + VertexIndices.Num() - 1) % VertexIndices.Num()], VertexIndices[PolygonVertexIndex]), &bAlreadyInSet);
+        if (bAlreadyInSet) return false;
+        UsedVertices[VertexIndices[PolygonVertexIndex]] = true;
+      }
+    }
+    for (uint64 HalfEdge : HalfEdges) {
+      if (!HalfEdges.Contains((HalfEdge << 32) | (HalfEdge >> 32))) return false;
+    }
+    return UsedVertices.CountSetBits() == Polyhedron.Vertices.Num() && Polyhedron.Vertices.Num() - HalfEdges.Num() / 2 + Polyhedron.Polygons.Num() == 2;
+  }
+
+  // Runs the remaining steps on a patch around the domain, then replicates the domain with the rotations.
+  bool GenerateFromDomain(const FSymmetryDomain& Domain, const FPolyhedronMesh& Polyhedron, TArrayView<const FPolyhedronNotationStep> Steps, const FPolyhedronOperationParameters& Parameters, FPolyhedronMesh& OutPolyhedron) {
+    int32 PolygonCount = Polyhedron.Polygons.Num();
+    int32 PrimitiveOperationCount = 0;
+    for (const FPolyhedronNotationStep& Step : Steps) {
+      PrimitiveOperationCount += FPolyhedronTools::GetPrimitiveOperationCount(Step.Symbol);
+    }
+
+    // Each primitive operation spreads the cap's influence by about one ring of polygons, which are never larger than the current ones.
+    TArray<FVector> PolygonCenters = FPolyhedronTools::GetPolygonCenters(Polyhedron);
+    double PolygonAngle = 0.0;
+    for (int32 PolygonIndex = 0; PolygonIndex < PolygonCount; ++PolygonIndex) {
+      for (int32 VertexIndex : Polyhedron.Polygons[PolygonIndex].VertexIndices) {
+        PolygonAngle = FMath::Max(PolygonAngle, 2.0 * GetAngle(PolygonCenters[PolygonIndex], Polyhedron.Vertices[VertexIndex]));
+      }
+    }
+
+    for (double MarginFactor : { 1.0, 2.0 }) {
+      TBitArray<> Selection(false, PolygonCount);
+      double Margin = MarginFactor * PolygonAngle * static_cast<double>(PrimitiveOperationCount + 1);
+      for (int32 PolygonIndex = 0; PolygonIndex < PolygonCount; ++PolygonIndex) {
+        Selection[PolygonIndex] = Domain.Contains(PolygonCenters[PolygonIndex], Margin);
+      }
+      if (Selection.CountSetBits() * 2 > PolygonCount) return false;
+
+      FPolyhedronMesh Patch;
+      TBitArray<> Tainted;
+      if (!FPolyhedronTools::CutPatch(Polyhedron, MoveTemp(Selection), Patch, Tainted)) return false;
+      FPolyhedronOperationRecorder Recorder;
+      for (const FPolyhedronNotationStep& Step : Steps) {
+        Patch = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Step, Patch, Parameters, &Recorder);
+      }
+      Tainted = FPolyhedronTools::PropagateTaint(MoveTemp(Tainted), Recorder);
+
+      // Keep the untainted polygons of the domain. Overlapping a little is fine, the duplicates are removed below.
+      TArray<int32> CleanPolygonIndices;
+      double ShortestEdge = TNumericLimits<double>::Max(), LargestRadius = 0.0;
+      for (int32 PolygonIndex = 0; PolygonIndex < Patch.Polygons.Num(); ++PolygonIndex) {
+        const TArray<int32>& VertexIndices = Patch.Polygons[PolygonIndex].VertexIndices;
+        if (VertexIndices.ContainsByPredicate([&] (int32 VertexIndex) { return Tainted[VertexIndex]; })) continue;
+        CleanPolygonIndices.Add(PolygonIndex);
+        for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < VertexIndices.Num(); ++PolygonVertexIndex) {
+          const FVector& Vertex = Patch.Vertices[VertexIndices[PolygonVertexIndex]];
+          ShortestEdge = FMath::Min(ShortestEdge, FVector::Dist(Vertex, Patch.Vertices[VertexIndices[(PolygonVertexIndex + 1) % VertexIndices.Num()]]));
+          LargestRadius = FMath::Max(LargestRadius, Vertex.Size());
+        }
+      }
+      if (CleanPolygonIndices.Num() == 0 || ShortestEdge <= 0.0) continue;
+
+      // The seeds are only symmetric up to the precision of their coordinates: be generous with the tolerances.
+      TArray<int32> DomainVertexIndices;
+      DomainVertexIndices.Init(INDEX_NONE, Patch.Vertices.Num());
+      TArray<FVector> DomainVertices;
+      TArray<FPolyhedronPolygon> DomainPolygons;
+      for (int32 PolygonIndex : CleanPolygonIndices) {
+        const FPolyhedronPolygon& Polygon = Patch.Polygons[PolygonIndex];
+        if (!Domain.Contains(FPolyhedronTools::GetPolygonCenter(Patch, Polygon), 0.25 * ShortestEdge / LargestRadius)) continue;
+        FPolyhedronPolygon& DomainPolygon = DomainPolygons.Add_GetRef(Polygon);
+        for (int32& VertexIndex : DomainPolygon.VertexIndices) {
+          if (DomainVertexIndices[VertexIndex] == INDEX_NONE) {
+            DomainVertexIndices[VertexIndex] = DomainVertices.Add(Patch.Vertices[VertexIndex]);
+          }
+          VertexIndex = DomainVertexIndices[VertexIndex];
+        }
+      }
+
+      // Replicate the domain, in parallel, then weld the copies together.
+      int32 RotationCount = Domain.Rotations.Num(), DomainVertexCount = DomainVertices.Num();
+      TArray<FVector> RotatedVertices;
+      RotatedVertices.SetNumUninitialized(RotationCount * DomainVertexCount);
+      ParallelFor(RotationCount, [&] (int32 RotationIndex) {
+        for (int32 VertexIndex = 0; VertexIndex < DomainVertexCount; ++VertexIndex) {
+          RotatedVertices[RotationIndex * DomainVertexCount + VertexIndex] = Rotate(Domain.Rotations[RotationIndex], DomainVertices[VertexIndex]);
+        }
+      });
+
+      FPolyhedronMesh Output;
+      Output.Vertices.Reserve(RotationCount * DomainVertexCount);
+      Output.Polygons.Reserve(RotationCount * DomainPolygons.Num());
+      FVertexWelder Welder(Output.Vertices, 0.25 * ShortestEdge);
+      TArray<int32> WeldedVertexIndices;
+      WeldedVertexIndices.SetNumUninitialized(RotatedVertices.Num());
+      for (int32 VertexIndex = 0; VertexIndex < RotatedVertices.Num(); ++VertexIndex) {
+        WeldedVertexIndices[VertexIndex] = Welder.FindOrAdd(RotatedVertices[VertexIndex]);
+      }
+
+      // In a manifold mesh, a polygon is identified by any of its half-edges: use the one leaving its lowest vertex.
+      TSet<uint64> PolygonKeys;
+      for (int32 RotationIndex = 0; RotationIndex < RotationCount; ++RotationIndex) {
+        for (const FPolyhedronPolygon& DomainPolygon : DomainPolygons) {
+          FPolyhedronPolygon Polygon;
+          Polygon.MaterialIndex = DomainPolygon.MaterialIndex;
+          Polygon.VertexIndices.Reserve(DomainPolygon.VertexIndices.Num());
+          for (int32 VertexIndex : DomainPolygon.VertexIndices) {
+            Polygon.VertexIndices.Add(WeldedVertexIndices[RotationIndex * DomainVertexCount + VertexIndex]);
+          }
+          int32 LowestPolygonVertexIndex = 0;
+          for (int32 PolygonVertexIndex = 1; PolygonVertexIndex < Polygon.VertexIndices.Num(); ++PolygonVertexIndex) {
+            if (Polygon.VertexIndices[PolygonVertexIndex] < Polygon.VertexIndices[LowestPolygonVertexIndex]) LowestPolygonVertexIndex = PolygonVertexIndex;
+          }
+          bool bAlreadyInSet = false;
+          PolygonKeys.Add(MakeHalfEdgeKey(Polygon.VertexIndices[LowestPolygonVertexIndex], Polygon.VertexIndices[(LowestPolygonVertexIndex + 1) % Polygon.VertexIndices.Num()]), &bAlreadyInSet);
+          if (!bAlreadyInSet) {
+            Output.Polygons.Add(MoveTemp(Polygon));
+          }
+        }
+      }
+
+      // A margin too thin leaves holes, which a wider one may fill.
+      if (IsClosedSphere(Output)) {
+        OutPolyhedron = MoveTemp(Output);
+        return true;
+      }
+    }
+    return false;
+  }
+}
+
+FPolyhedronMesh FPolyhedronSymmetry::GenerateFromConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, float Scale, const FPolyhedronOperationParameters& Parameters) {
+  TArray<FPolyhedronNotationStep> Steps;
+  if (!FPolyhedronTools::ParseConwayPolyhedronNotation(ConwayPolyhedronNotation, Steps)) return FPolyhedronMesh();
+  FPolyhedronMeshSize PredictedSize;
+  if (FPolyhedronTools::PredictConwayPolyhedronNotation(Steps, PredictedSize) && !FPolyhedronTools::CheckMemoryBudget(PredictedSize)) return FPolyhedronMesh();
+
+  FPolyhedronMesh Polyhedron = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Steps[0], FPolyhedronMesh(), Parameters);
+  FSymmetryDomain Domain;
+  bool bSymmetric = Domain.Initialize(Polyhedron);
+
+  // Apply the steps on the full polyhedron until a patch around the domain is small enough to pay off.
+  // Canonicalization and reflection move every vertex of the polyhedron, so a patch never spans them.
+  for (int32 StepIndex = 1; StepIndex < Steps.Num(); ++StepIndex) {
+    int32 DomainStepEnd = StepIndex;
+    while (DomainStepEnd < Steps.Num() && Steps[DomainStepEnd].Symbol != 'K' && Steps[DomainStepEnd].Symbol != 'r') {
+      ++DomainStepEnd;
+    }
+    FPolyhedronMesh Replicated;
+    if (bSymmetric && DomainStepEnd > StepIndex && GenerateFromDomain(Domain, Polyhedron, TArrayView<const FPolyhedronNotationStep>(Steps).Slice(StepIndex, DomainStepEnd - StepIndex), Parameters, Replicated)) {
+      Polyhedron = MoveTemp(Replicated);
+      StepIndex = DomainStepEnd - 1;
+      continue;
+    }
+    Polyhedron = FPolyhedronTools::ApplyConwayPolyhedronNotationStep(Steps[StepIndex], Polyhedron, Parameters);
+  }
+
+  return FPolyhedronTools::ScaleToSphere(Polyhedron, Scale);
+}
+
+TArray<FMatrix> FPolyhedronSymmetry::FindRotations(const FPolyhedronMesh& Polyhedron) {
+  TArray<FMatrix> Rotations = { FMatrix::Identity };
+  int32 VertexCount = Polyhedron.Vertices.Num();
+  if (VertexCount < 2) return Rotations;
+
+  TArray<TPair<int32, int32>> HalfEdges;
+  TSet<uint64> HalfEdgeKeys;
+  TArray<int32> VertexDegrees;
+  VertexDegrees.Init(0, VertexCount);
+  double ShortestEdge = TNumericLimits<double>::Max(), LargestRadius = 0.0;
+  for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+    int32 VertexFrom = Polygon.VertexIndices.Last();
+    for (int32 VertexTo : Polygon.VertexIndices) {
+      HalfEdges.Add({ VertexFrom, VertexTo });
+      HalfEdgeKeys.Add(MakeHalfEdgeKey(VertexFrom, VertexTo));
+      ++VertexDegrees[VertexFrom];
+      ShortestEdge = FMath::Min(ShortestEdge, FVector::Dist(Polyhedron.Vertices[VertexFrom], Polyhedron.Vertices[VertexTo]));
+      VertexFrom = VertexTo;
+    }
+  }
+  for (const FVector& Vertex : Polyhedron.Vertices) {
+    LargestRadius = FMath::Max(LargestRadius, Vertex.Size());
+  }
+  if (HalfEdges.Num() == 0 || ShortestEdge <= 0.0) return Rotations;
+
+  // The seed coordinates are rounded: match the vertices within a tenth of an edge.
+  double Tolerance = 0.1 * ShortestEdge;
+  TArray<FVector> Vertices = Polyhedron.Vertices;
+  FVertexWelder VertexGrid(Vertices, Tolerance);
+  for (int32 VertexIndex = 0; VertexIndex < VertexCount; ++VertexIndex) {
+    VertexGrid.Add(VertexIndex);
+  }
+
+  // A rotation maps a vertex onto one of the same degree and radius: start from the rarest kind of vertex, for the fewest candidates.
+  auto GetVertexKind = [&] (int32 VertexIndex) { return TPair<int32, int64>(VertexDegrees[VertexIndex], static_cast<int64>(FMath::RoundToDouble(Vertices[VertexIndex].Size() / (1e-2 * LargestRadius)))); };
+  TMap<TPair<int32, int64>, int32> VertexKindCounts;
+  for (int32 VertexIndex = 0; VertexIndex < VertexCount; ++VertexIndex) {
+    ++VertexKindCounts.FindOrAdd(GetVertexKind(VertexIndex));
+  }
+  int32 ReferenceVertex = 0;
+  for (int32 VertexIndex = 1; VertexIndex < VertexCount; ++VertexIndex) {
+    if (VertexKindCounts[GetVertexKind(VertexIndex)] < VertexKindCounts[GetVertexKind(ReferenceVertex)]) ReferenceVertex = VertexIndex;
+  }
+
+  // An orthonormal frame built from a vertex and one of its neighbors.
+  auto MakeFrame = [] (const FVector& Vertex1, const FVector& Vertex2, FVector (&OutAxes)[3]) -> bool {
+    OutAxes[0] = Vertex1.GetSafeNormal();
+    OutAxes[1] = Vertex2 - Vertex2.Dot(OutAxes[0]) * OutAxes[0];
+    if (OutAxes[0].IsZero() || OutAxes[1].SizeSquared() < 1e-12 * Vertex2.SizeSquared()) return false;
+    OutAxes[1].Normalize();
+    OutAxes[2] = OutAxes[0].Cross(OutAxes[1]);
+    return true;
+  };
+  FVector ReferenceAxes[3];
+  int32 ReferenceNeighbor = INDEX_NONE;
+  for (const TPair<int32, int32>& HalfEdge : HalfEdges) {
+    if (HalfEdge.Key == ReferenceVertex && MakeFrame(Vertices[HalfEdge.Key], Vertices[HalfEdge.Value], ReferenceAxes)) {
+      ReferenceNeighbor = HalfEdge.Value;
+      break;
+    }
+  }
+  if (ReferenceNeighbor == INDEX_NONE) return Rotations;
+
+  // Each half-edge that looks like the reference one defines a candidate rotation: keep those that map the whole mesh onto itself.
+  double ReferenceRadius = Vertices[ReferenceVertex].Size(), ReferenceNeighborRadius = Vertices[ReferenceNeighbor].Size();
+  double ReferenceLength = FVector::Dist(Vertices[ReferenceVertex], Vertices[ReferenceNeighbor]);
+  TArray<int32> RotatedVertexIndices;
+  RotatedVertexIndices.SetNumUninitialized(VertexCount);
+  for (const TPair<int32, int32>& HalfEdge : HalfEdges) {
+    const FVector& Vertex1 = Vertices[HalfEdge.Key];
+    const FVector& Vertex2 = Vertices[HalfEdge.Value];
+    if (VertexDegrees[HalfEdge.Key] != VertexDegrees[ReferenceVertex]) continue;
+    if (FMath::Abs(Vertex1.Size() - ReferenceRadius) > Tolerance || FMath::Abs(Vertex2.Size() - ReferenceNeighborRadius) > Tolerance) continue;
+    if (FMath::Abs(FVector::Dist(Vertex1, Vertex2) - ReferenceLength) > Tolerance) continue;
+    FVector Axes[3];
+    if (!MakeFrame(Vertex1, Vertex2, Axes)) continue;
+
+    // Maps each reference axis onto the matching candidate axis; TransformVector() weighs the rows by the coordinates.
+    FVector Rows[3];
+    for (int32 Row = 0; Row < 3; ++Row) {
+      Rows[Row] = ReferenceAxes[0][Row] * Axes[0] + ReferenceAxes[1][Row] * Axes[1] + ReferenceAxes[2][Row] * Axes[2];
+    }
+    FMatrix Rotation(Rows[0], Rows[1], Rows[2], FVector::ZeroVector);
+    if (Rotation.Equals(FMatrix::Identity, 1e-6)) continue;
+
+    bool bSymmetry = true;
+    for (int32 VertexIndex = 0; VertexIndex < VertexCount && bSymmetry; ++VertexIndex) {
+      RotatedVertexIndices[VertexIndex] = VertexGrid.Find(Rotate(Rotation, Vertices[VertexIndex]));
+      bSymmetry = RotatedVertexIndices[VertexIndex] != INDEX_NONE;
+    }
+    for (int32 HalfEdgeIndex = 0; HalfEdgeIndex < HalfEdges.Num() && bSymmetry; ++HalfEdgeIndex) {
+      bSymmetry = HalfEdgeKeys.Contains(MakeHalfEdgeKey(RotatedVertexIndices[HalfEdges[HalfEdgeIndex].Key], RotatedVertexIndices[HalfEdges[HalfEdgeIndex].Value]));
+    }
+    if (bSymmetry) {
+      Rotations.Add(Rotation);
+    }
+  }
+  return Rotations;
+}
@@ -0,0 +1,224 @@
+// Copyright 2024 TabbyCoder
+
+#include "PolyhedronTerrain.h"
+#include "Async/ParallelFor.h"
+#include "Helpers.h"
+#include "PolyhedronPathfinding.h"
+#include "PolyhedronTools.h"
+
+FPolyhedronTerrain::FPolyhedronTerrain(const FPolyhedronMesh& InPolyhedron, const FPolyhedronTerrainSettings& Settings)
+  : Polyhedron(InPolyhedron) {
+  int32 PolygonCount = Polyhedron.Polygons.Num();
+  Graph = FPolyhedronTools::ComputePolygonGraph(Polyhedron);
+  Heights.SetNumZeroed(PolygonCount);
+  VertexDirections.SetNumUninitialized(Polyhedron.Vertices.Num());
+  for (int32 VertexIndex = 0; VertexIndex < Polyhedron.Vertices.Num(); ++VertexIndex) {
+    VertexDirections[VertexIndex] = Polyhedron.Vertices[VertexIndex].GetSafeNormal();
+  }
+  if (PolygonCount == 0) return;
+
+  // The chunks grow by steps from seeds spread evenly over the surface, so that they stay compact and about the same size:
+  // one seed per cell of an equal-angle cube map around the center, at the polygon closest to the center of the cell.
+  int32 ChunkPolygonCount = FMath::Max(Settings.ChunkPolygonCount, 1);
+  int32 CellsPerSide = FMath::Max(1, FMath::RoundToInt(FMath::Sqrt(PolygonCount / (6.0 * ChunkPolygonCount))));
+  TArray<int32> PolygonCells, CellSeeds;
+  TArray<double> CellSeedDistances;
+  PolygonCells.SetNumUninitialized(PolygonCount);
+  CellSeeds.Init(INDEX_NONE, 6 * CellsPerSide * CellsPerSide);
+  CellSeedDistances.Init(TNumericLimits<double>::Max(), CellSeeds.Num());
+  for (int32 PolygonIndex = 0; PolygonIndex < PolygonCount; ++PolygonIndex) {
+    FVector Direction = Graph.Centers[PolygonIndex];
+    int32 Axis = FMath::Abs(Direction.X) >= FMath::Max(FMath::Abs(Direction.Y), FMath::Abs(Direction.Z)) ? 0 : (FMath::Abs(Direction.Y) >= FMath::Abs(Direction.Z) ? 1 : 2);
+    double AxisLength = FMath::Max(FMath::Abs(Direction[Axis]), UE_DOUBLE_SMALL_NUMBER);
+    int32 Cell = (Axis * 2 + (Direction[Axis] < 0.0 ? 1 : 0)) * CellsPerSide * CellsPerSide;
+    double SquaredDistance = 0.0;
+    for (int32 Side = 1; Side <= 2; ++Side) {
+      double Coordinate = (FMath::Atan(Direction[(Axis + Side) % 3] / AxisLength) / UE_DOUBLE_HALF_PI + 0.5) * CellsPerSide;
+      int32 CellCoordinate = FMath::Clamp(FMath::FloorToInt32(Coordinate), 0, CellsPerSide - 1);
+      Cell += CellCoordinate * (Side == 1 ? CellsPerSide : 1);
+      SquaredDistance += FMath::Square(Coordinate - CellCoordinate - 0.5);
+    }
+    PolygonCells[PolygonIndex] = Cell;
+    if (SquaredDistance < CellSeedDistances[Cell]) {
+      CellSeeds[Cell] = PolygonIndex;
+      CellSeedDistances[Cell] = SquaredDistance;
+    }
+  }
+  TArray<int32> Seeds, CellRegions;
+  CellRegions.Init(INDEX_NONE, CellSeeds.Num());
+  for (int32 Cell = 0; Cell < CellSeeds.Num(); ++Cell) {
+    if (CellSeeds[Cell] != INDEX_NONE) CellRegions[Cell] = Seeds.Add(CellSeeds[Cell]);
+  }
+  FPolyhedronPartitionSettings PartitionSettings;
+  PartitionSettings.bCountSteps = true;
+  TArray<int32> RegionIndices = FPolyhedronPathfinder::Partition(Graph, Seeds, PartitionSettings).RegionIndices;
+
+  // A chunk never mixes materials: each region splits into one chunk per material of its cells. The material indices of
+  // the polyhedron stay as they are; the section builder gets the chunk indices as materials instead, so that it lays out
+  // the caps of each chunk.
+  FPolyhedronMesh ChunkedPolyhedron = Polyhedron;
+  TMap<uint64, int32> RegionMaterialChunks;
+  TArray<int32> CapVertexOffsets, ChunkVertexTotals;
+  PolygonChunkIndices.SetNumUninitialized(PolygonCount);
+  CapVertexOffsets.SetNumUninitialized(PolygonCount);
+  for (int32 PolygonIndex = 0; PolygonIndex < PolygonCount; ++PolygonIndex) {
+    // The polygons of a polyhedron in pieces may be out of reach of every seed.
+    int32 RegionIndex = RegionIndices[PolygonIndex] != INDEX_NONE ? RegionIndices[PolygonIndex] : CellRegions[PolygonCells[PolygonIndex]];
+    const FPolyhedronPolygon& Polygon = Polyhedron.Polygons[PolygonIndex];
+    uint64 RegionMaterialKey = (static_cast<uint64>(static_cast<uint32>(RegionIndex)) << 32) | static_cast<uint64>(static_cast<uint32>(Polygon.MaterialIndex));
+    int32 ChunkIndex = PolygonChunkIndices[PolygonIndex] = RegionMaterialChunks.FindOrAdd(RegionMaterialKey, Chunks.Num());
+    if (ChunkIndex == Chunks.Num()) {
+      Chunks.AddDefaulted_GetRef().MaterialIndex = Polygon.MaterialIndex;
+      ChunkVertexTotals.Add(0);
+    }
+    ChunkedPolyhedron.Polygons[PolygonIndex].MaterialIndex = ChunkIndex;
+    CapVertexOffsets[PolygonIndex] = ChunkVertexTotals[ChunkIndex];
+    if (Polygon.VertexIndices.Num() < 3) continue;
+    Chunks[ChunkIndex].PolygonIndices.Add(PolygonIndex);
+    ChunkVertexTotals[ChunkIndex] += Polygon.VertexIndices.Num();
+  }
+  EPolyhedronUVGeneration UVGeneration = Settings.UVGeneration == EPolyhedronUVGeneration::CellularArray ? EPolyhedronUVGeneration::Cellular : Settings.UVGeneration;
+  FPolyhedronSectionBuilder SectionBuilder(ChunkedPolyhedron, UVGeneration);
+  SectionBuilder.Build();
+  TArray<FPolyhedronSection>& Sections = SectionBuilder.GetSections();
+  for (int32 ChunkIndex = 0; ChunkIndex < Sections.Num(); ++ChunkIndex) {
+    Chunks[ChunkIndex].Section = MoveTemp(Sections[ChunkIndex]);
+  }
+
+  // Gather the walls of each chunk; each side of a wall takes the texture coordinates of the rim of its cap.
+  auto GetCapUV = [&] (int32 PolygonIndex, int32 VertexIndex) {
+    const FPolyhedronSection& Section = Chunks[PolygonChunkIndices[PolygonIndex]].Section;
+    return Section.UVs[CapVertexOffsets[PolygonIndex] + Polyhedron.Polygons[PolygonIndex].VertexIndices.Find(VertexIndex)];
+  };
+  bool bHasUVs = UVGeneration != EPolyhedronUVGeneration::None;
+  TArray<TArray<FVector2D>> ChunkWallUVs;
+  ChunkWallUVs.SetNum(Chunks.Num());
+  ParallelFor(Chunks.Num(), [&] (int32 ChunkIndex) {
+    FChunk& Chunk = Chunks[ChunkIndex];
+    for (int32 PolygonIndex : Chunk.PolygonIndices) {
+      const TArray<int32>& VertexIndices = Polyhedron.Polygons[PolygonIndex].VertexIndices;
+      TArrayView<const int32> Neighbors = Graph.GetNeighbors(PolygonIndex);
+      for (int32 NeighborIndex = 0; NeighborIndex < Neighbors.Num(); ++NeighborIndex) {
+        if (Neighbors[NeighborIndex] < PolygonIndex) continue;
+        // The k-th half-edge of a polygon goes from its (k-1)-th vertex to its k-th vertex.
+        FWall Wall = { PolygonIndex, Neighbors[NeighborIndex], VertexIndices[(NeighborIndex + VertexIndices.Num() - 1) % VertexIndices.Num()], VertexIndices[NeighborIndex] };
+        Chunk.Walls.Add(Wall);
+        if (!bHasUVs) continue;
+        ChunkWallUVs[ChunkIndex].Add(GetCapUV(Wall.PolygonIndex, Wall.VertexIndexTo));
+        ChunkWallUVs[ChunkIndex].Add(GetCapUV(Wall.PolygonIndex, Wall.VertexIndexFrom));
+        ChunkWallUVs[ChunkIndex].Add(GetCapUV(Wall.PolygonIndexAcross, Wall.VertexIndexFrom));
+        ChunkWallUVs[ChunkIndex].Add(GetCapUV(Wall.PolygonIndexAcross, Wall.VertexIndexTo));
+      }
+    }
+  });
+
+  // Append the walls after the caps, as quads that Update() fills in.
+  ParallelFor(Chunks.Num(), [&] (int32 ChunkIndex) {
+    FChunk& Chunk = Chunks[ChunkIndex];
+    FPolyhedronSection& Section = Chunk.Section;
+    Section.MaterialIndex = Chunk.MaterialIndex;
+    int32 WallVertexOffset = Section.Positions.Num();
+    Section.Positions.AddZeroed(Chunk.Walls.Num() * 4);
+    Section.Normals.AddZeroed(Chunk.Walls.Num() * 4);
+    Section.UVs.Append(ChunkWallUVs[ChunkIndex]);
+    Section.Triangles.Reserve(Section.Triangles.Num() + Chunk.Walls.Num() * 6);
+    bool bHasTangents = Section.Tangents.Num() > 0;
+    for (int32 WallIndex = 0; WallIndex < Chunk.Walls.Num(); ++WallIndex) {
+      int32 QuadVertexOffset = WallVertexOffset + WallIndex * 4;
+      Section.Triangles.Append({ QuadVertexOffset, QuadVertexOffset + 1, QuadVertexOffset + 2 });
+      Section.Triangles.Append({ QuadVertexOffset, QuadVertexOffset + 2, QuadVertexOffset + 3 });
+      if (!bHasTangents) continue;
+      // The texture coordinates of a wall run along the rims of the caps: U grows along the rim as on the cap of its
+      // polygon, and the bitangent follows the V of that cap, folded over the rim. The wall faces away from its polygon,
+      // as it does when that polygon is the higher one.
+      const FWall& Wall = Chunk.Walls[WallIndex];
+      const FPolyhedronPolygon& Polygon = Polyhedron.Polygons[Wall.PolygonIndex];
+      FVector CapNormal = FPolyhedronTools::GetPolygonNormal(Polyhedron, Polygon);
+      FProcMeshTangent CapTangent = FPolyhedronSectionBuilder::GetPolygonTangent(Polyhedron, Polygon, CapNormal, UVGeneration);
+      FVector CapBitangent = CapNormal.Cross(CapTangent.TangentX) * (CapTangent.bFlipTangentY ? -1.0 : 1.0);
+      FVector RimDirection = (Polyhedron.Vertices[Wall.VertexIndexFrom] - Polyhedron.Vertices[Wall.VertexIndexTo]).GetSafeNormal();
+      FVector TangentX = RimDirection * (CapTangent.TangentX.Dot(RimDirection) < 0.0 ? -1.0 : 1.0);
+      FVector WallNormal = FPolyhedronTools::CalculateNormal(GetDisplacedVertex(Wall.VertexIndexTo, 1.0f), GetDisplacedVertex(Wall.VertexIndexFrom, 1.0f), Polyhedron.Vertices[Wall.VertexIndexFrom]);
+      FProcMeshTangent WallTangent(TangentX, WallNormal.Cross(TangentX).Dot(CapBitangent) < 0.0);
+      Section.Tangents.Append({ WallTangent, WallTangent, WallTangent, WallTangent });
+    }
+  });
+
+  DirtyChunks.Init(true, Chunks.Num());
+  Update();
+}
+
+void FPolyhedronTerrain::SetHeight(int32 PolygonIndex, float Height) {
+  REPORT_ERROR_IF(!Heights.IsValidIndex(PolygonIndex), "Cannot set the height of polygon %d", PolygonIndex);
+  if (Heights[PolygonIndex] == Height) return;
+  Heights[PolygonIndex] = Height;
+  DirtyChunks[PolygonChunkIndices[PolygonIndex]] = true;
+
+  // The walls towards the lower polygon indices belong to the chunks of these polygons.
+  for (int32 Neighbor : Graph.GetNeighbors(PolygonIndex)) {
+    if (Neighbor < PolygonIndex) {
+      DirtyChunks[PolygonChunkIndices[Neighbor]] = true;
+    }
+  }
+}
+
+void FPolyhedronTerrain::SetHeights(TArrayView<const float> InHeights) {
+  REPORT_ERROR_IF(InHeights.Num() != Heights.Num(), "%d heights for %d polygons", InHeights.Num(), Heights.Num());
+  for (int32 PolygonIndex = 0; PolygonIndex < InHeights.Num(); ++PolygonIndex) {
+    SetHeight(PolygonIndex, InHeights[PolygonIndex]);
+  }
+}
+
+TArray<int32> FPolyhedronTerrain::Update() {
+  TArray<int32> ChunkIndices;
+  for (TConstSetBitIterator<> It(DirtyChunks); It; ++It) {
+    ChunkIndices.Add(It.GetIndex());
+  }
+  ParallelFor(ChunkIndices.Num(), [&] (int32 Index) {
+    DisplaceChunk(Chunks[ChunkIndices[Index]]);
+  });
+  for (int32 ChunkIndex : ChunkIndices) {
+    DirtyChunks[ChunkIndex] = false;
+  }
+  return ChunkIndices;
+}
+
+void FPolyhedronTerrain::DisplaceChunk(FChunk& Chunk) const {
+  TArray<FVector>& Positions = Chunk.Section.Positions;
+  TArray<FVector>& Normals = Chunk.Section.Normals;
+
+  // The caps keep the fan-triangulation of FPolyhedronSectionBuilder, and so their normals.
+  int32 VertexOffset = 0;
+  for (int32 PolygonIndex : Chunk.PolygonIndices) {
+    const TArray<int32>& VertexIndices = Polyhedron.Polygons[PolygonIndex].VertexIndices;
+    FVector* CapPositions = Positions.GetData() + VertexOffset;
+    for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < VertexIndices.Num(); ++PolygonVertexIndex) {
+      CapPositions[PolygonVertexIndex] = GetDisplacedVertex(VertexIndices[PolygonVertexIndex], Heights[PolygonIndex]);
+    }
+    FVector CapNormal = FVector::ZeroVector;
+    for (int32 PolygonVertexIndex = 2; PolygonVertexIndex < VertexIndices.Num(); ++PolygonVertexIndex) {
+      CapNormal += FPolyhedronTools::CalculateNormal(CapPositions[0], CapPositions[PolygonVertexIndex - 1], CapPositions[PolygonVertexIndex]);
+    }
+    CapNormal = CapNormal.GetSafeNormal();
+    for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < VertexIndices.Num(); ++PolygonVertexIndex) {
+      Normals[VertexOffset + PolygonVertexIndex] = CapNormal;
+    }
+    VertexOffset += VertexIndices.Num();
+  }
+
+  // A wall runs backwards along the half-edge of its polygon, down (or up) to the polygon across it. When the polygon
+  // across is higher, the quad flips over and faces the other way, towards the lower polygon again.
+  for (const FWall& Wall : Chunk.Walls) {
+    FVector* WallPositions = Positions.GetData() + VertexOffset;
+    WallPositions[0] = GetDisplacedVertex(Wall.VertexIndexTo, Heights[Wall.PolygonIndex]);
+    WallPositions[1] = GetDisplacedVertex(Wall.VertexIndexFrom, Heights[Wall.PolygonIndex]);
+    WallPositions[2] = GetDisplacedVertex(Wall.VertexIndexFrom, Heights[Wall.PolygonIndexAcross]);
+    WallPositions[3] = GetDisplacedVertex(Wall.VertexIndexTo, Heights[Wall.PolygonIndexAcross]);
+    FVector WallNormal = FPolyhedronTools::CalculateNormal(WallPositions[0], WallPositions[1], WallPositions[2]) + FPolyhedronTools::CalculateNormal(WallPositions[0], WallPositions[2], WallPositions[3]);
+    WallNormal = WallNormal.GetSafeNormal(); // Zero for the flat walls between cells of the same height.
+    for (int32 QuadVertexIndex = 0; QuadVertexIndex < 4; ++QuadVertexIndex) {
+      Normals[VertexOffset + QuadVertexIndex] = WallNormal;
+    }
+    VertexOffset += 4;
+  }
+}
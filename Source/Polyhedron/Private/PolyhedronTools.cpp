@@ -6,68 +6,220 @@
 #include "PolyhedronSeeds.h"
 #include "PolyhedronOperations.h"
 #include "Helpers.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+namespace {
+  TAutoConsoleVariable<float> CVarPolyhedronCanonicalizeTimeBudgetMs(
+    TEXT("Polyhedron.Canonicalize.TimeBudgetMs"),
+    0.0f,
+    TEXT("Caps the time that the K notation symbol spends canonicalizing a polyhedron, in milliseconds; zero means no cap."),
+    ECVF_Default);
+
+  TAutoConsoleVariable<int32> CVarPolyhedronGenerationMemoryBudgetMB(
+    TEXT("Polyhedron.Generation.MemoryBudgetMB"),
+    4096,
+    TEXT("Refuses to generate the notations whose predicted peak memory exceeds this many megabytes; zero means no budget."),
+    ECVF_Default);
+
+  // The seeds have closed-form sizes, except for the Platonic solids, which are cheaper to build than to describe.
+  bool PredictSeed(const FPolyhedronNotationStep& Step, FPolyhedronMeshSize& OutSize) {
+    OutSize = FPolyhedronMeshSize();
+    int32 Sides = Step.Argument;
+    switch (Step.Symbol) {
+    case 'A':
+      if (Sides == 2) { OutSize = FPolyhedronMeshSize::Measure(FPolyhedronSeeds::Tetrahedron()); break; }
+      if (Sides < 3) return false;
+      OutSize.VertexCount = 2 * Sides;
+      OutSize.PolygonSideCounts.FindOrAdd(3) += 2 * Sides;
+      OutSize.PolygonSideCounts.FindOrAdd(Sides) += 2;
+      OutSize.VertexDegreeCounts.Add(4, 2 * Sides);
+      break;
+    case 'G': {
+      int32 M = Step.Argument, N = Step.SecondArgument;
+      if (M < 0 || N < 0 || M + N < 1) return false;
+      // The dual of the geodesic polyhedron of triangulation number T: 12 pentagons, and 10 (T - 1) hexagons.
+      int64 T = static_cast<int64>(M) * M + static_cast<int64>(M) * N + static_cast<int64>(N) * N;
+      OutSize.VertexCount = 20 * T;
+      OutSize.PolygonSideCounts.Add(5, 12);
+      if (T > 1) OutSize.PolygonSideCounts.Add(6, 10 * (T - 1));
+      OutSize.VertexDegreeCounts.Add(3, 20 * T);
+      break;
+    }
+    case 'P':
+      if (Sides < 3) return false;
+      OutSize.VertexCount = 2 * Sides;
+      OutSize.PolygonSideCounts.FindOrAdd(4) += Sides;
+      OutSize.PolygonSideCounts.FindOrAdd(Sides) += 2;
+      OutSize.VertexDegreeCounts.Add(3, 2 * Sides);
+      break;
+    case 'Y':
+      if (Sides < 3) return false;
+      OutSize.VertexCount = Sides + 1;
+      OutSize.PolygonSideCounts.FindOrAdd(3) += Sides;
+      OutSize.PolygonSideCounts.FindOrAdd(Sides) += 1;
+      OutSize.VertexDegreeCounts.FindOrAdd(3) += Sides;
+      OutSize.VertexDegreeCounts.FindOrAdd(Sides) += 1;
+      break;
+    case 'C': OutSize = FPolyhedronMeshSize::Measure(FPolyhedronSeeds::Cube()); break;
+    case 'D': OutSize = FPolyhedronMeshSize::Measure(FPolyhedronSeeds::Dodecahedron()); break;
+    case 'I': OutSize = FPolyhedronMeshSize::Measure(FPolyhedronSeeds::Icosahedron()); break;
+    case 'O': OutSize = FPolyhedronMeshSize::Measure(FPolyhedronSeeds::Octahedron()); break;
+    case 'T': OutSize = FPolyhedronMeshSize::Measure(FPolyhedronSeeds::Tetrahedron()); break;
+    default: return false;
+    }
+    OutSize.PolygonCount = 0;
+    OutSize.EdgeCount = 0;
+    for (const TPair<int32, int64>& SideCount : OutSize.PolygonSideCounts) {
+      OutSize.PolygonCount += SideCount.Value;
+      OutSize.EdgeCount += SideCount.Key * SideCount.Value;
+    }
+    OutSize.EdgeCount /= 2;
+    OutSize.PeakMemorySize = OutSize.GetMemorySize();
+    return true;
+  }
 
-FPolyhedronMesh FPolyhedronTools::GenerateFromConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, float Scale) {
-  REPORT_ERROR_RETURN_IF(ConwayPolyhedronNotation.Len() < 1, FPolyhedronMesh(), "Empty ConwayPolyhedronNotation makes no Polyhedron");
+  uint64 MakeHalfEdgeKey(int32 VertexFrom, int32 VertexTo) {
+    return (static_cast<uint64>(static_cast<uint32>(VertexFrom)) << 32) | static_cast<uint64>(static_cast<uint32>(VertexTo));
+  }
+}
 
+FPolyhedronMesh FPolyhedronTools::GenerateFromConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, float Scale, const FPolyhedronOperationParameters& Parameters) {
   // Some sample Conway notations that work:
   // I -> Icosahedron
   // dI -> Dodecahedron
   // tI -> Truncated Icosahedron or Soccer ball or G(1,1)
   // tktI -> Golf ball or G(3,3)
+  TArray<FPolyhedronNotationStep> Steps;
+  if (!ParseConwayPolyhedronNotation(ConwayPolyhedronNotation, Steps)) return FPolyhedronMesh();
+  FPolyhedronMeshSize PredictedSize;
+  if (PredictConwayPolyhedronNotation(Steps, PredictedSize) && !CheckMemoryBudget(PredictedSize)) return FPolyhedronMesh();
 
-  // The last letter (and the first to be processed) is the start polyhedron.
-  bool PolyhedronStarted = false;
-  int32 Argument = 0;
   FPolyhedronMesh Polyhedron;
+  for (const FPolyhedronNotationStep& Step : Steps) {
+    Polyhedron = ApplyConwayPolyhedronNotationStep(Step, Polyhedron, Parameters);
+  }
+  
+  Polyhedron = ScaleToSphere(Polyhedron, Scale);
+  return Polyhedron;
+}
+
+bool FPolyhedronTools::ParseConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, TArray<FPolyhedronNotationStep>& OutSteps) {
+  OutSteps.Reset();
+  REPORT_ERROR_RETURN_IF(ConwayPolyhedronNotation.Len() < 1, false, "Empty ConwayPolyhedronNotation makes no Polyhedron");
+
+  // The last letter (and the first to be processed) is the start polyhedron.
+  // The notation is parsed from back to front, so the digits of an argument arrive from the least significant one,
+  // and the second argument of a symbol arrives before its first argument.
+  int32 Argument = 0, ArgumentDigitFactor = 1, SecondArgument = 0;
+  bool bHasSecondArgument = false;
   auto NotationIterator = ConwayPolyhedronNotation.rbegin(), NotationIteratorEnd = ConwayPolyhedronNotation.rend();
   for (; NotationIterator != NotationIteratorEnd; ++NotationIterator) {
     // Parse any integers as an argument for the subsequent function.
     if (*NotationIterator >= '0' && *NotationIterator <= '9') {
-      Argument = (Argument * 10) + (*NotationIterator - TEXT('0'));
+      Argument += (*NotationIterator - TEXT('0')) * ArgumentDigitFactor;
+      ArgumentDigitFactor *= 10;
       continue;
     }
-
-    // Start with a Polyhedron seed.
-    if (!PolyhedronStarted) {
-      switch (*NotationIterator) {
-      case 'A': Polyhedron = FPolyhedronSeeds::Antiprism(Argument); break;
-      case 'C': Polyhedron = FPolyhedronSeeds::Cube(); break;
-      case 'D': Polyhedron = FPolyhedronSeeds::Dodecahedron(); break;
-      case 'I': Polyhedron = FPolyhedronSeeds::Icosahedron(); break;
-      case 'O': Polyhedron = FPolyhedronSeeds::Octahedron(); break;
-      case 'P': Polyhedron = FPolyhedronSeeds::Prism(Argument); break;
-      case 'T': Polyhedron = FPolyhedronSeeds::Tetrahedron(); break;
-      case 'Y': Polyhedron = FPolyhedronSeeds::Pyramid(Argument); break;
-      default: REPORT_ERROR("Unknown Starter Volume: %c", *NotationIterator); return FPolyhedronMesh();
-      }
-      PolyhedronStarted = true;
+    if (*NotationIterator == ',') {
+      if (bHasSecondArgument) { REPORT_ERROR("Too many arguments in ConwayPolyhedronNotation"); OutSteps.Reset(); return false; }
+      SecondArgument = Argument;
+      bHasSecondArgument = true;
       Argument = 0;
+      ArgumentDigitFactor = 1;
       continue;
     }
 
-    // The subsequent letters are Conway operations to be done on the polyhedron.
-    switch (*NotationIterator) {
-    case 'a': Polyhedron = FPolyhedronOperations::Ambo(Polyhedron); break;
-    case 'b': Polyhedron = FPolyhedronOperations::Bevel(Polyhedron); break;
-    case 'c': Polyhedron = FPolyhedronOperations::Chamfer(Polyhedron); break;
-    case 'd': Polyhedron = FPolyhedronOperations::Dual(Polyhedron); break;
-    case 'e': Polyhedron = FPolyhedronOperations::Expand(Polyhedron); break;
-    case 'g': Polyhedron = FPolyhedronOperations::Gyro(Polyhedron); break;
-    case 'j': Polyhedron = FPolyhedronOperations::Join(Polyhedron); break;
-    case 'k': Polyhedron = FPolyhedronOperations::Kis(Polyhedron, 0, 0.1); break;
-    case 'm': Polyhedron = FPolyhedronOperations::Meta(Polyhedron); break;
-    case 'n': Polyhedron = FPolyhedronOperations::Needle(Polyhedron); break;
-    case 'o': Polyhedron = FPolyhedronOperations::Ortho(Polyhedron); break;
-    case 's': Polyhedron = FPolyhedronOperations::Snub(Polyhedron); break;
-    case 't': Polyhedron = FPolyhedronOperations::Truncate(Polyhedron); break;
-    default: REPORT_ERROR("Unknown Polyhedron Operation: %c", *NotationIterator); return FPolyhedronMesh();
+    // Validate the letters up-front, so that no work is done on broken notations.
+    if (OutSteps.Num() == 0) {
+      switch (*NotationIterator) {
+      case 'A': case 'C': case 'D': case 'G': case 'I': case 'O': case 'P': case 'T': case 'Y': break;
+      default: REPORT_ERROR("Unknown Starter Volume: %c", *NotationIterator); OutSteps.Reset(); return false;
+      }
+    } else {
+      switch (*NotationIterator) {
+      case 'a': case 'b': case 'c': case 'd': case 'e': case 'g': case 'j': case 'k': case 'l': case 'm': case 'n': case 'o': case 'p': case 'q': case 'r': case 's': case 't': case 'u': case 'w': case 'K': break;
+      default: REPORT_ERROR("Unknown Polyhedron Operation: %c", *NotationIterator); OutSteps.Reset(); return false;
+      }
     }
+
+    FPolyhedronNotationStep& Step = OutSteps.AddDefaulted_GetRef();
+    Step.Symbol = *NotationIterator;
+    Step.Argument = Argument;
+    Step.SecondArgument = SecondArgument;
     Argument = 0;
+    ArgumentDigitFactor = 1;
+    SecondArgument = 0;
+    bHasSecondArgument = false;
   }
-  
-  Polyhedron = ScaleToSphere(Polyhedron, Scale);
-  return Polyhedron;
+
+  REPORT_ERROR_RETURN_IF(OutSteps.Num() == 0, false, "ConwayPolyhedronNotation has no Starter Volume");
+  return true;
+}
+
+FPolyhedronMesh FPolyhedronTools::ApplyConwayPolyhedronNotationStep(const FPolyhedronNotationStep& Step, const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters, FPolyhedronOperationRecorder* Recorder) {
+  switch (Step.Symbol) {
+  // Start with a Polyhedron seed.
+  case 'A': return FPolyhedronSeeds::Antiprism(Step.Argument);
+  case 'C': return FPolyhedronSeeds::Cube();
+  case 'D': return FPolyhedronSeeds::Dodecahedron();
+  case 'G': return FPolyhedronSeeds::Goldberg(Step.Argument, Step.SecondArgument);
+  case 'I': return FPolyhedronSeeds::Icosahedron();
+  case 'O': return FPolyhedronSeeds::Octahedron();
+  case 'P': return FPolyhedronSeeds::Prism(Step.Argument);
+  case 'T': return FPolyhedronSeeds::Tetrahedron();
+  case 'Y': return FPolyhedronSeeds::Pyramid(Step.Argument);
+
+  // The subsequent letters are Conway operations to be done on the polyhedron.
+  case 'a': return FPolyhedronOperations::Ambo(Input, Recorder);
+  case 'b': return FPolyhedronOperations::Bevel(Input, Parameters.KisApexOffset, Recorder);
+  case 'c': return FPolyhedronOperations::Chamfer(Input, Parameters.ChamferOffset, Recorder);
+  case 'd': return FPolyhedronOperations::Dual(Input, Recorder);
+  case 'e': return FPolyhedronOperations::Expand(Input, Recorder);
+  case 'g': return FPolyhedronOperations::Gyro(Input, Recorder);
+  case 'j': return FPolyhedronOperations::Join(Input, Recorder);
+  case 'k': return FPolyhedronOperations::Kis(Input, 0, Parameters.KisApexOffset, Recorder);
+  case 'l': return FPolyhedronOperations::Loft(Input, Recorder);
+  case 'm': return FPolyhedronOperations::Meta(Input, Parameters.KisApexOffset, Recorder);
+  case 'n': return FPolyhedronOperations::Needle(Input, Parameters.KisApexOffset, Recorder);
+  case 'o': return FPolyhedronOperations::Ortho(Input, Recorder);
+  case 'p': return FPolyhedronOperations::Propeller(Input, Recorder);
+  case 'q': return FPolyhedronOperations::Quinto(Input, Recorder);
+  case 'r': return FPolyhedronOperations::Reflect(Input, Recorder);
+  case 's': return FPolyhedronOperations::Snub(Input, Recorder);
+  case 't': return FPolyhedronOperations::Truncate(Input, Parameters.KisApexOffset, Recorder);
+  case 'u': return FPolyhedronOperations::Subdivide(Input, Step.Argument > 0 ? Step.Argument : 2, Recorder);
+  case 'w': return FPolyhedronOperations::Whirl(Input, Recorder);
+
+  // Canonicalization moves the vertices iteratively, there is no recipe to record.
+  case 'K':
+    REPORT_ERROR_RETURN_IF(Recorder != nullptr, FPolyhedronMesh(), "Canonicalization cannot be recorded");
+    return Canonicalize(Input, Step.Argument > 0 ? Step.Argument : 200, 1e-6, CVarPolyhedronCanonicalizeTimeBudgetMs.GetValueOnAnyThread() / 1000.0);
+  default: REPORT_ERROR("Unknown Conway Notation Symbol: %c", Step.Symbol); return FPolyhedronMesh();
+  }
+}
+
+bool FPolyhedronTools::PredictConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, FPolyhedronMeshSize& OutSize) {
+  TArray<FPolyhedronNotationStep> Steps;
+  if (!ParseConwayPolyhedronNotation(ConwayPolyhedronNotation, Steps)) return false;
+  return PredictConwayPolyhedronNotation(Steps, OutSize);
+}
+
+bool FPolyhedronTools::PredictConwayPolyhedronNotation(TArrayView<const FPolyhedronNotationStep> Steps, FPolyhedronMeshSize& OutSize) {
+  if (Steps.Num() == 0 || !PredictSeed(Steps[0], OutSize)) return false;
+  for (int32 StepIndex = 1; StepIndex < Steps.Num(); ++StepIndex) {
+    if (OutSize.VertexCount > MAX_int32 || 2 * OutSize.EdgeCount > MAX_int32) break;
+    OutSize = FPolyhedronOperations::PredictOperation(OutSize, Steps[StepIndex].Symbol, Steps[StepIndex].Argument);
+  }
+  return true;
+}
+
+bool FPolyhedronTools::CheckMemoryBudget(const FPolyhedronMeshSize& Size) {
+  REPORT_ERROR_RETURN_IF(Size.VertexCount > MAX_int32 || 2 * Size.EdgeCount > MAX_int32, false, "The polyhedron would have more than %d vertices or half-edges", MAX_int32);
+  int32 MemoryBudgetMB = CVarPolyhedronGenerationMemoryBudgetMB.GetValueOnAnyThread();
+  double PeakMemoryMB = static_cast<double>(Size.PeakMemorySize) / (1024.0 * 1024.0);
+  REPORT_ERROR_RETURN_IF(MemoryBudgetMB > 0 && PeakMemoryMB > MemoryBudgetMB, false, "The polyhedron would take %.0f MB to generate, over the %d MB of Polyhedron.Generation.MemoryBudgetMB", PeakMemoryMB, MemoryBudgetMB);
+  return true;
 }
 
 FVector FPolyhedronTools::CalculateNormal(const FVector& Position1, const FVector& Position2, const FVector& Position3) {
@@ -78,37 +230,27 @@ FVector FPolyhedronTools::CalculateNormal(const FVector& Position1, const FVecto
 
 TArray<FVector> FPolyhedronTools::GetPolygonCenters(const FPolyhedronMesh& Input) {
   TArray<FVector> Output;
-  Output.Reserve(Input.Polygons.Num());
+  Output.SetNumUninitialized(Input.Polygons.Num());
 
   // Calculate the center of polygon; essentially its average position.
-  for (const FPolyhedronPolygon& Polygon : Input.Polygons) {
+  ParallelFor(Input.Polygons.Num(), [&] (int32 PolygonIndex) {
+    const TArray<int32>& PolygonVertexIndices = Input.Polygons[PolygonIndex].VertexIndices;
     FVector Center = FVector::ZeroVector;
-    for (int32 VertexIndex : Polygon.VertexIndices) {
+    for (int32 VertexIndex : PolygonVertexIndices) {
       Center += Input.Vertices[VertexIndex];
     }
-    Output.Add(Center / Polygon.VertexIndices.Num());
-  }
+    Output[PolygonIndex] = Center / FMath::Max(PolygonVertexIndices.Num(), 1);
+  });
 
   return Output;
 }
 
 TArray<FVector> FPolyhedronTools::GetPolygonNormals(const FPolyhedronMesh& Input) {
   TArray<FVector> Output;
-  Output.Reserve(Input.Polygons.Num());
-
-  // Calculate the average normal for this polygon.
-  // -- An average polygon normal feels like a weird concept.
-  for (const FPolyhedronPolygon& Polygon : Input.Polygons) {
-    FVector Normal = FVector::ZeroVector;
-    const TArray<int32>& PolygonVertexIndices = Polygon.VertexIndices;
-
-    // Fan-triangulate this polygon to process each triangle's normal.
-    for (int32 PolygonVertexIndex = 2; PolygonVertexIndex < PolygonVertexIndices.Num(); ++PolygonVertexIndex) {
-      Normal += CalculateNormal(Input.Vertices[PolygonVertexIndices[0]], Input.Vertices[PolygonVertexIndices[PolygonVertexIndex - 1]], Input.Vertices[PolygonVertexIndices[PolygonVertexIndex]]);
-    }
-    Output.Add(Normal.GetSafeNormal());
-  }
-
+  Output.SetNumUninitialized(Input.Polygons.Num());
+  ParallelFor(Input.Polygons.Num(), [&] (int32 PolygonIndex) {
+    Output[PolygonIndex] = GetPolygonNormal(Input.Vertices, Input.Polygons[PolygonIndex]);
+  });
   return Output;
 }
 
@@ -124,14 +266,23 @@ FVector FPolyhedronTools::GetPolygonCenter(const FPolyhedronMesh& Polyhedron, co
 
 FVector FPolyhedronTools::GetPolygonNormal(const FPolyhedronMesh& Polyhedron, const FPolyhedronPolygon& Polygon) {
   REPORT_ERROR_RETURN_IF(Polygon.VertexIndices.Num() < 3, FVector::ZeroVector, "No a complete polygon.");
+  return GetPolygonNormal(Polyhedron.Vertices, Polygon);
+}
 
-  // Fan-triangulate this polygon to process each triangle's normal.
-  FVector Normal = FVector::ZeroVector;
+FVector FPolyhedronTools::GetPolygonNormal(TArrayView<const FVector> Vertices, const FPolyhedronPolygon& Polygon) {
+  // Newell's normal: one cross product per edge, and no normalization until the end. For a planar polygon, it matches
+  // the sum of the normals of its fan triangles, see CalculateNormal(); the polygons turn clockwise around it.
   const TArray<int32>& PolygonVertexIndices = Polygon.VertexIndices;
-  for (int32 PolygonVertexIndex = 2; PolygonVertexIndex < PolygonVertexIndices.Num(); ++PolygonVertexIndex) {
-    Normal += CalculateNormal(Polyhedron.Vertices[PolygonVertexIndices[0]], Polyhedron.Vertices[PolygonVertexIndices[PolygonVertexIndex - 1]], Polyhedron.Vertices[PolygonVertexIndices[PolygonVertexIndex]]);
+  if (PolygonVertexIndices.Num() < 3) return FVector::ZeroVector;
+  FVector Normal = FVector::ZeroVector;
+  FVector Previous = Vertices[PolygonVertexIndices.Last()];
+  for (int32 VertexIndex : PolygonVertexIndices) {
+    const FVector& Current = Vertices[VertexIndex];
+    Normal += FVector::CrossProduct(Current, Previous);
+    Previous = Current;
   }
-  return Normal.GetSafeNormal();
+  // Its length is twice the area of the polygon, tiny on large polyhedra: only drop the degenerate polygons.
+  return Normal.GetSafeNormal(1e-24);
 }
 
 FPolyhedronMesh FPolyhedronTools::ScaleToSphere(const FPolyhedronMesh& Input, double Radius) {
@@ -139,21 +290,16 @@ FPolyhedronMesh FPolyhedronTools::ScaleToSphere(const FPolyhedronMesh& Input, do
   // Assume that all Polyhedron have the origin as their center.
   double FurthestVertexDistanceSquared = 0.0;
   for (const FVector& VertexPosition : Input.Vertices) {
-    double VertexDistanceSquared = VertexPosition.Dot(VertexPosition);
-    if (VertexDistanceSquared > FurthestVertexDistanceSquared) {
-      FurthestVertexDistanceSquared = VertexDistanceSquared;
-    }
+    FurthestVertexDistanceSquared = FMath::Max(FurthestVertexDistanceSquared, VertexPosition.Dot(VertexPosition));
   }
-  FSphere BoundingSphere(Input.Vertices.GetData(), Input.Vertices.Num());
-  const FVector& Centroid = BoundingSphere.Center; // should this always be the zero-vector?
   float ScaleFactor = Radius / FMath::Sqrt(FurthestVertexDistanceSquared);
 
   // Rescale the polyhedron.
   FPolyhedronMesh Output;
-  Output.Vertices.Reserve(Input.Vertices.Num());
-  for (const FVector& InputVertex : Input.Vertices) {
-    Output.Vertices.Add(InputVertex * ScaleFactor);
-  }
+  Output.Vertices.SetNumUninitialized(Input.Vertices.Num());
+  ParallelFor(Input.Vertices.Num(), [&] (int32 VertexIndex) {
+    Output.Vertices[VertexIndex] = Input.Vertices[VertexIndex] * ScaleFactor;
+  });
 
   Output.Polygons = Input.Polygons;
   return Output;
@@ -162,25 +308,158 @@ FPolyhedronMesh FPolyhedronTools::ScaleToSphere(const FPolyhedronMesh& Input, do
 FPolyhedronMesh FPolyhedronTools::ProjectUntoSphere(const FPolyhedronMesh& Input, double Radius) {
   // Assume that all Polyhedron have the origin as their center.
   FPolyhedronMesh Output;
-  Output.Vertices.Reserve(Input.Vertices.Num());
-  for (const FVector& InputVertex : Input.Vertices) {
+  Output.Vertices.SetNumUninitialized(Input.Vertices.Num());
+  ParallelFor(Input.Vertices.Num(), [&] (int32 VertexIndex) {
     // Recenter at the origin and place back on the sphere.
-    Output.Vertices.Add(InputVertex.GetSafeNormal() * Radius);
-  }
+    Output.Vertices[VertexIndex] = Input.Vertices[VertexIndex].GetSafeNormal() * Radius;
+  });
 
   Output.Polygons = Input.Polygons;
   return Output;
 }
 
+FPolyhedronMesh FPolyhedronTools::Canonicalize(const FPolyhedronMesh& Input, int32 MaxIterations, double Tolerance, double TimeBudgetSeconds) {
+  // Based on George W. Hart's canonicalization, as done in Polyhedronisme: each iteration tangentifies the edges,
+  // recenters their tangent points on the origin and planarizes the polygons, with small steps to stay stable.
+  double StartTime = FPlatformTime::Seconds();
+  FPolyhedronMesh Output = Input;
+  int32 VertexTotal = Output.Vertices.Num();
+  int32 PolygonTotal = Output.Polygons.Num();
+  if (VertexTotal < 1 || PolygonTotal < 1) return Output; // Empty mesh.
+
+  // Flatten the adjacency into compressed rows, so that every kernel below gathers from contiguous arrays.
+  // Each outgoing half-edge of a vertex gives one neighbor vertex, and the polygon that the half-edge belongs to.
+  TArray<int32> VertexOffsets, VertexNeighbors, VertexPolygons, PolygonOffsets, PolygonVertices;
+  VertexOffsets.SetNumZeroed(VertexTotal + 1);
+  PolygonOffsets.SetNumUninitialized(PolygonTotal + 1);
+  int32 HalfEdgeTotal = 0;
+  for (int32 PolygonIndex = 0; PolygonIndex < PolygonTotal; ++PolygonIndex) {
+    PolygonOffsets[PolygonIndex] = HalfEdgeTotal;
+    for (int32 VertexIndex : Output.Polygons[PolygonIndex].VertexIndices) {
+      ++VertexOffsets[VertexIndex + 1];
+    }
+    HalfEdgeTotal += Output.Polygons[PolygonIndex].VertexIndices.Num();
+  }
+  PolygonOffsets[PolygonTotal] = HalfEdgeTotal;
+  for (int32 VertexIndex = 0; VertexIndex < VertexTotal; ++VertexIndex) {
+    VertexOffsets[VertexIndex + 1] += VertexOffsets[VertexIndex];
+  }
+  TArray<int32> VertexCursors(VertexOffsets.GetData(), VertexTotal);
+  VertexNeighbors.SetNumUninitialized(HalfEdgeTotal);
+  VertexPolygons.SetNumUninitialized(HalfEdgeTotal);
+  PolygonVertices.SetNumUninitialized(HalfEdgeTotal);
+  for (int32 PolygonIndex = 0; PolygonIndex < PolygonTotal; ++PolygonIndex) {
+    const TArray<int32>& PolygonVertexIndices = Output.Polygons[PolygonIndex].VertexIndices;
+    int32 VertexFrom = PolygonVertexIndices.Last();
+    for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < PolygonVertexIndices.Num(); ++PolygonVertexIndex) {
+      int32 VertexTo = PolygonVertexIndices[PolygonVertexIndex];
+      int32 VertexHalfEdgeIndex = VertexCursors[VertexFrom]++;
+      VertexNeighbors[VertexHalfEdgeIndex] = VertexTo;
+      VertexPolygons[VertexHalfEdgeIndex] = PolygonIndex;
+      PolygonVertices[PolygonOffsets[PolygonIndex] + PolygonVertexIndex] = VertexTo;
+      VertexFrom = VertexTo;
+    }
+  }
+
+  // The point of an edge closest to the origin.
+  auto GetEdgeTangentPoint = [] (const FVector& Position1, const FVector& Position2) {
+    FVector Edge = Position2 - Position1;
+    double EdgeLengthSquared = Edge.Dot(Edge);
+    return EdgeLengthSquared > 0.0 ? Position1 - Edge * (Position1.Dot(Edge) / EdgeLengthSquared) : Position1;
+  };
+
+  // The steps are sized for a unit sphere: start with the tangent points at a unit distance, on average.
+  TArray<FVector>& Vertices = Output.Vertices;
+  double TangentPointDistanceTotal = 0.0;
+  for (int32 VertexIndex = 0; VertexIndex < VertexTotal; ++VertexIndex) {
+    for (int32 VertexHalfEdgeIndex = VertexOffsets[VertexIndex]; VertexHalfEdgeIndex < VertexOffsets[VertexIndex + 1]; ++VertexHalfEdgeIndex) {
+      TangentPointDistanceTotal += GetEdgeTangentPoint(Vertices[VertexIndex], Vertices[VertexNeighbors[VertexHalfEdgeIndex]]).Size();
+    }
+  }
+  REPORT_ERROR_RETURN_IF(TangentPointDistanceTotal <= 0.0, Output, "Degenerate polyhedron cannot be canonicalized");
+  double UnitScaleFactor = static_cast<double>(HalfEdgeTotal) / TangentPointDistanceTotal;
+  for (FVector& Vertex : Vertices) {
+    Vertex *= UnitScaleFactor;
+  }
+
+  // Larger steps make the iterations oscillate.
+  constexpr double StabilityFactor = 0.1;
+  TArray<FVector> TangentVertices, TangentPointTotals, PolygonNormals, PolygonCenters;
+  TArray<double> VertexChanges;
+  TangentVertices.SetNumUninitialized(VertexTotal);
+  TangentPointTotals.SetNumUninitialized(VertexTotal);
+  VertexChanges.SetNumUninitialized(VertexTotal);
+  PolygonNormals.SetNumUninitialized(PolygonTotal);
+  PolygonCenters.SetNumUninitialized(PolygonTotal);
+  for (int32 Iteration = 0; Iteration < MaxIterations; ++Iteration) {
+    // Tangentify: pull the tangent point of every edge towards the unit sphere, through both of its vertices.
+    ParallelFor(VertexTotal, [&] (int32 VertexIndex) {
+      const FVector& Position = Vertices[VertexIndex];
+      FVector Offset = FVector::ZeroVector, TangentPointTotal = FVector::ZeroVector;
+      for (int32 VertexHalfEdgeIndex = VertexOffsets[VertexIndex]; VertexHalfEdgeIndex < VertexOffsets[VertexIndex + 1]; ++VertexHalfEdgeIndex) {
+        FVector TangentPoint = GetEdgeTangentPoint(Position, Vertices[VertexNeighbors[VertexHalfEdgeIndex]]);
+        Offset += (0.5 * StabilityFactor * (1.0 - TangentPoint.Size())) * TangentPoint;
+        TangentPointTotal += TangentPoint;
+      }
+      TangentVertices[VertexIndex] = Position + Offset;
+      TangentPointTotals[VertexIndex] = TangentPointTotal;
+    });
+
+    // Recenter: the tangent points average to the origin. Each edge counts once from each of its vertices.
+    FVector TangentPointCenter = FVector::ZeroVector;
+    for (const FVector& TangentPointTotal : TangentPointTotals) {
+      TangentPointCenter += TangentPointTotal;
+    }
+    TangentPointCenter /= HalfEdgeTotal;
+
+    // Planarize: fit a plane to every polygon. Newell's normal is robust to non-planar polygons, and to any translation.
+    ParallelFor(PolygonTotal, [&] (int32 PolygonIndex) {
+      FVector Normal = FVector::ZeroVector, Center = FVector::ZeroVector;
+      FVector Previous = TangentVertices[PolygonVertices[PolygonOffsets[PolygonIndex + 1] - 1]];
+      for (int32 PolygonHalfEdgeIndex = PolygonOffsets[PolygonIndex]; PolygonHalfEdgeIndex < PolygonOffsets[PolygonIndex + 1]; ++PolygonHalfEdgeIndex) {
+        const FVector& Current = TangentVertices[PolygonVertices[PolygonHalfEdgeIndex]];
+        Normal += FVector::CrossProduct(Previous, Current);
+        Center += Current;
+        Previous = Current;
+      }
+      Center = Center / (PolygonOffsets[PolygonIndex + 1] - PolygonOffsets[PolygonIndex]) - TangentPointCenter;
+      Normal = Normal.GetSafeNormal();
+      PolygonNormals[PolygonIndex] = Normal.Dot(Center) < 0.0 ? -Normal : Normal;
+      PolygonCenters[PolygonIndex] = Center;
+    });
+
+    // Then pull every vertex towards the planes of its polygons.
+    ParallelFor(VertexTotal, [&] (int32 VertexIndex) {
+      FVector Position = TangentVertices[VertexIndex] - TangentPointCenter;
+      FVector Offset = FVector::ZeroVector;
+      for (int32 VertexHalfEdgeIndex = VertexOffsets[VertexIndex]; VertexHalfEdgeIndex < VertexOffsets[VertexIndex + 1]; ++VertexHalfEdgeIndex) {
+        int32 PolygonIndex = VertexPolygons[VertexHalfEdgeIndex];
+        Offset += PolygonNormals[PolygonIndex] * PolygonNormals[PolygonIndex].Dot(PolygonCenters[PolygonIndex] - Position);
+      }
+      Position += StabilityFactor * Offset;
+      VertexChanges[VertexIndex] = FVector::DistSquared(Position, Vertices[VertexIndex]);
+      Vertices[VertexIndex] = Position;
+    });
+
+    double LargestVertexChange = 0.0;
+    for (double VertexChange : VertexChanges) {
+      LargestVertexChange = FMath::Max(LargestVertexChange, VertexChange);
+    }
+    if (LargestVertexChange < Tolerance * Tolerance) break;
+    if (TimeBudgetSeconds > 0.0 && FPlatformTime::Seconds() - StartTime >= TimeBudgetSeconds) break;
+  }
+
+  return Output;
+}
+
 FPolyhedronExtendedMesh FPolyhedronTools::ComputeEdgeDetails(const FPolyhedronMesh& Input) {
   FPolyhedronExtendedMesh Output;
 
-  // Copy the vertices and polygons.
-  Output.Vertices = Input.Vertices;
-  Output.Polygons = Input.Polygons;
-  int32 VertexTotal = Output.Vertices.Num();
+  // Only refer to the vertices and polygons.
+  Output.Mesh = &Input;
+  int32 VertexTotal = Input.Vertices.Num();
   if (VertexTotal < 1) return Output; // Empty mesh.
-  int32 PolygonTotal = Output.Polygons.Num();
+  int32 PolygonTotal = Input.Polygons.Num();
   if (PolygonTotal < 1) return Output; // Empty mesh.
 
   // Count the number of edges per vertex and per polygons, then cumulate them.
@@ -267,6 +546,137 @@ FPolyhedronExtendedMesh FPolyhedronTools::ComputeEdgeDetails(const FPolyhedronMe
   return Output;
 }
 
+FPolyhedronPolygonGraph FPolyhedronTools::ComputePolygonGraph(const FPolyhedronMesh& Input) {
+  // The half-edges are already numbered polygon by polygon: their offsets are the rows of the graph.
+  FPolyhedronExtendedMesh ExtendedInput = ComputeEdgeDetails(Input);
+  FPolyhedronPolygonGraph Graph;
+  Graph.Centers = GetPolygonCenters(Input);
+  if (Graph.Centers.Num() == 0) return Graph; // Empty mesh.
+  Graph.NeighborOffsets = MoveTemp(ExtendedInput.PolygonHalfEdgeOffsets);
+  Graph.Neighbors.SetNumUninitialized(ExtendedInput.PolygonHalfEdges.Num());
+  Graph.NeighborDistances.SetNumUninitialized(ExtendedInput.PolygonHalfEdges.Num());
+  ParallelFor(ExtendedInput.PolygonHalfEdges.Num(), [&] (int32 HalfEdgeIndex) {
+    const FPolyhedronDirectedHalfEdge& HalfEdge = ExtendedInput.PolygonHalfEdges[HalfEdgeIndex];
+    check(HalfEdge.PolygonIndexAcross != -1); // your mesh is not closed if this check triggers.
+    Graph.Neighbors[HalfEdgeIndex] = HalfEdge.PolygonIndexAcross;
+    Graph.NeighborDistances[HalfEdgeIndex] = static_cast<float>(FVector::Dist(Graph.Centers[HalfEdge.PolygonIndex], Graph.Centers[HalfEdge.PolygonIndexAcross]));
+  });
+  return Graph;
+}
+
+int32 FPolyhedronTools::GetPrimitiveOperationCount(TCHAR Symbol) {
+  switch (Symbol) {
+  case 'o': return 6;
+  case 'b': case 'm': return 4;
+  case 'j': case 's': case 't': return 3;
+  case 'e': case 'n': return 2;
+  default: return 1;
+  }
+}
+
+bool FPolyhedronTools::CutPatch(const FPolyhedronMesh& Polyhedron, TBitArray<> Selection, FPolyhedronMesh& OutPatch, TBitArray<>& OutTainted) {
+  int32 PolygonCount = Polyhedron.Polygons.Num();
+  TArray<int32> CapLoop;
+  for (int32 Attempt = 0; Attempt < 4 && CapLoop.Num() == 0; ++Attempt) {
+    TSet<uint64> HalfEdges;
+    for (TConstSetBitIterator<> It(Selection); It; ++It) {
+      const TArray<int32>& VertexIndices = Polyhedron.Polygons[It.GetIndex()].VertexIndices;
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < VertexIndices.Num(); ++PolygonVertexIndex) {
+        HalfEdges.Add(MakeHalfEdgeKey(VertexIndices[(PolygonVertexIndex + VertexIndices.Num() - 1) % VertexIndices.Num()], VertexIndices[PolygonVertexIndex]));
+      }
+    }
+
+    // The cap runs against the rim: every rim half-edge From->To becomes the cap half-edge To->From.
+    // The cap must be a simple loop, and share at most one edge with each polygon, for the operations to keep the patch manifold.
+    TMap<int32, int32> CapNextVertices;
+    bool bSimpleRim = true;
+    for (TConstSetBitIterator<> It(Selection); It; ++It) {
+      const TArray<int32>& VertexIndices = Polyhedron.Polygons[It.GetIndex()].VertexIndices;
+      int32 RimEdgeCount = 0;
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < VertexIndices.Num(); ++PolygonVertexIndex) {
+        int32 VertexFrom = VertexIndices[(PolygonVertexIndex + VertexIndices.Num() - 1) % VertexIndices.Num()], VertexTo = VertexIndices[PolygonVertexIndex];
+        if (HalfEdges.Contains(MakeHalfEdgeKey(VertexTo, VertexFrom))) continue;
+        ++RimEdgeCount;
+        if (RimEdgeCount > 1 || CapNextVertices.Contains(VertexTo)) bSimpleRim = false;
+        CapNextVertices.Add(VertexTo, VertexFrom);
+      }
+    }
+    if (bSimpleRim && CapNextVertices.Num() > 0) {
+      int32 FirstVertex = CapNextVertices.CreateConstIterator().Key(), Vertex = FirstVertex;
+      do {
+        CapLoop.Add(Vertex);
+        Vertex = CapNextVertices[Vertex];
+      } while (Vertex != FirstVertex && CapLoop.Num() <= CapNextVertices.Num());
+      if (CapLoop.Num() == CapNextVertices.Num()) break;
+      CapLoop.Reset();
+    }
+
+    // Grow the patch over the rim, hoping for a simpler one.
+    TSet<int32> RimVertices;
+    for (const TPair<int32, int32>& CapNextVertex : CapNextVertices) {
+      RimVertices.Add(CapNextVertex.Key);
+    }
+    TBitArray<> GrownSelection = Selection;
+    for (int32 PolygonIndex = 0; PolygonIndex < PolygonCount; ++PolygonIndex) {
+      for (int32 VertexIndex : Polyhedron.Polygons[PolygonIndex].VertexIndices) {
+        if (RimVertices.Contains(VertexIndex)) { GrownSelection[PolygonIndex] = true; break; }
+      }
+    }
+    Selection = MoveTemp(GrownSelection);
+    if (Selection.CountSetBits() * 2 > PolygonCount) return false;
+  }
+  if (CapLoop.Num() == 0) return false;
+
+  // Compact the vertices of the patch.
+  TArray<int32> PatchVertexIndices;
+  PatchVertexIndices.Init(INDEX_NONE, Polyhedron.Vertices.Num());
+  OutPatch = FPolyhedronMesh();
+  auto GetPatchVertexIndex = [&] (int32 VertexIndex) -> int32 {
+    if (PatchVertexIndices[VertexIndex] == INDEX_NONE) {
+      PatchVertexIndices[VertexIndex] = OutPatch.Vertices.Add(Polyhedron.Vertices[VertexIndex]);
+    }
+    return PatchVertexIndices[VertexIndex];
+  };
+  for (TConstSetBitIterator<> It(Selection); It; ++It) {
+    const FPolyhedronPolygon& Polygon = Polyhedron.Polygons[It.GetIndex()];
+    FPolyhedronPolygon& PatchPolygon = OutPatch.Polygons.AddDefaulted_GetRef();
+    PatchPolygon.MaterialIndex = Polygon.MaterialIndex;
+    PatchPolygon.VertexIndices.Reserve(Polygon.VertexIndices.Num());
+    for (int32 VertexIndex : Polygon.VertexIndices) {
+      PatchPolygon.VertexIndices.Add(GetPatchVertexIndex(VertexIndex));
+    }
+  }
+  FPolyhedronPolygon& CapPolygon = OutPatch.Polygons.AddDefaulted_GetRef();
+  OutTainted.Init(false, OutPatch.Vertices.Num());
+  for (int32 VertexIndex : CapLoop) {
+    CapPolygon.VertexIndices.Add(PatchVertexIndices[VertexIndex]);
+    OutTainted[PatchVertexIndices[VertexIndex]] = true;
+  }
+  return true;
+}
+
+TBitArray<> FPolyhedronTools::PropagateTaint(TBitArray<> Tainted, const FPolyhedronOperationRecorder& Recorder) {
+  for (const FPolyhedronOperationStage& Stage : Recorder.Stages) {
+    check(Stage.InputVertexCount == Tainted.Num());
+    TBitArray<> OutputTainted(false, Stage.Vertices.Num());
+    for (int32 VertexIndex = 0; VertexIndex < Stage.Vertices.Num(); ++VertexIndex) {
+      const FPolyhedronOperationStage::FVertex& Recipe = Stage.Vertices[VertexIndex];
+      bool bTainted = false;
+      for (int32 TermIndex = Recipe.TermOffset; TermIndex < Recipe.TermOffset + Recipe.TermCount && !bTainted; ++TermIndex) {
+        bTainted = Tainted[Stage.Terms[TermIndex].Key];
+      }
+      if (!bTainted && Recipe.NormalPolygonIndex != INDEX_NONE) {
+        for (int32 PolygonVertexIndex : Stage.InputPolygons[Recipe.NormalPolygonIndex].VertexIndices) {
+          bTainted = bTainted || Tainted[PolygonVertexIndex];
+        }
+      }
+      OutputTainted[VertexIndex] = bTainted;
+    }
+    Tainted = MoveTemp(OutputTainted);
+  }
+  return Tainted;
+}
+
 int32 FPolyhedronTools::GetPolygonAt(const FPolyhedronMesh& Input, const FVector& Location) {
 
   float BestDistanceSquared = 1e9f;
@@ -5,6 +5,14 @@
 #include "Helpers.h"
 #include "Polyhedron.h"
 #include "PolyhedronConway.h"
+#include "PolyhedronParametricMesh.h"
+#include "PolyhedronPathfinding.h"
+#include "PolyhedronPipeline.h"
+#include "PolyhedronSeeds.h"
+#include "PolyhedronStreaming.h"
+#include "PolyhedronSymmetry.h"
+#include "PolyhedronTerrain.h"
+#include "PolyhedronTools.h"
 #include "Components/MapTestSpawner.h"
 
 #if WITH_AUTOMATION_TESTS && WITH_EDITORONLY_DATA
@@ -101,5 +109,791 @@ TEST_CLASS(PolyhedronPerformanceTest, "Polyhedron") {
   }
 };
 
+TEST_CLASS(PolyhedronParametricTest, "Polyhedron") {
+
+  TEST_METHOD(Reevaluation) {
+    // Re-evaluating the recorded vertices must land where a full generation with the same parameters does.
+    FPolyhedronOperationParameters Parameters;
+    Parameters.KisApexOffset = 0.3;
+    Parameters.ChamferOffset = 0.05;
+    for (const TCHAR* Notation : { TEXT("tkI"), TEXT("cgC"), TEXT("bmD"), TEXT("snO"), TEXT("u3kC"), TEXT("wqC"), TEXT("rplD") }) {
+      FPolyhedronParametricMesh ParametricMesh;
+      ASSERT_THAT(IsTrue(ParametricMesh.Build(Notation)));
+      ParametricMesh.Evaluate(Parameters);
+
+      FPolyhedronMesh Expected = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(Notation, 100.0, Parameters);
+      const FPolyhedronMesh& Actual = ParametricMesh.GetPolyhedron();
+      ASSERT_THAT(AreEqual(Actual.GetVertexCount(), Expected.GetVertexCount()));
+      ASSERT_THAT(AreEqual(Actual.GetPolygonCount(), Expected.GetPolygonCount()));
+      for (int32 VertexIndex = 0; VertexIndex < Expected.GetVertexCount(); ++VertexIndex) {
+        ASSERT_THAT(IsTrue(Actual.Vertices[VertexIndex].Equals(Expected.Vertices[VertexIndex], 1e-4)));
+      }
+    }
+  }
+
+  TEST_METHOD(SinglePrecision) {
+    // The single precision replay stays within a float rounding of the double one, even after a long chain.
+    FPolyhedronOperationParameters Parameters;
+    Parameters.KisApexOffset = 0.3;
+    for (const TCHAR* Notation : { TEXT("tkI"), TEXT("u3kC"), TEXT("tktktI") }) {
+      FPolyhedronParametricMesh ParametricMesh;
+      ASSERT_THAT(IsTrue(ParametricMesh.Build(Notation)));
+      ParametricMesh.Evaluate(Parameters);
+      TArray<FVector> Expected = ParametricMesh.GetPolyhedron().Vertices;
+      ParametricMesh.Evaluate(Parameters, 100.0, /*bSinglePrecision=*/true);
+      const TArray<FVector>& Actual = ParametricMesh.GetPolyhedron().Vertices;
+      double LargestError = 0.0;
+      for (int32 VertexIndex = 0; VertexIndex < Expected.Num(); ++VertexIndex) {
+        LargestError = FMath::Max(LargestError, FVector::Dist(Actual[VertexIndex], Expected[VertexIndex]));
+      }
+      ASSERT_THAT(IsTrue(LargestError < 1e-3));
+    }
+  }
+};
+
+TEST_CLASS(PolyhedronSeedTest, "Polyhedron") {
+
+  TEST_METHOD(Goldberg) {
+    // GP(M, N) has 12 pentagons and 10 * (T - 1) hexagons, with T = M^2 + MN + N^2.
+    auto CheckGoldberg = [&] (int32 M, int32 N) {
+      int32 Triangulation = M * M + M * N + N * N;
+      FPolyhedronMesh Polyhedron = FPolyhedronSeeds::Goldberg(M, N);
+      ASSERT_THAT(AreEqual(Polyhedron.GetVertexCount(), 20 * Triangulation));
+      ASSERT_THAT(AreEqual(Polyhedron.GetPolygonCount(), 10 * Triangulation + 2));
+      int32 PentagonCount = 0, HexagonCount = 0;
+      for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+        PentagonCount += Polygon.VertexIndices.Num() == 5 ? 1 : 0;
+        HexagonCount += Polygon.VertexIndices.Num() == 6 ? 1 : 0;
+      }
+      ASSERT_THAT(AreEqual(PentagonCount, 12));
+      ASSERT_THAT(AreEqual(HexagonCount, 10 * (Triangulation - 1)));
+    };
+    CheckGoldberg(1, 0);
+    CheckGoldberg(1, 1);
+    CheckGoldberg(2, 1);
+    CheckGoldberg(1, 3);
+    CheckGoldberg(5, 0);
+    CheckGoldberg(6, 6);
+    CheckGoldberg(7, 4);
+
+    // The notation takes two arguments; the second one defaults to zero.
+    ASSERT_THAT(AreEqual(FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("G3,1")).GetPolygonCount(), 132));
+    ASSERT_THAT(AreEqual(FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("G3")).GetPolygonCount(), 92));
+  }
+
+  TEST_METHOD(Pipeline) {
+    // A compile-time pipeline builds the same polyhedron as its notation.
+    using namespace PolyhedronPipeline;
+    auto CheckPipeline = [&] (const FString& Notation, const FPolyhedronMesh& Actual) {
+      FPolyhedronMesh Expected = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(Notation);
+      ASSERT_THAT(AreEqual(Actual.GetVertexCount(), Expected.GetVertexCount()));
+      ASSERT_THAT(AreEqual(Actual.GetPolygonCount(), Expected.GetPolygonCount()));
+      for (int32 VertexIndex = 0; VertexIndex < Expected.GetVertexCount(); ++VertexIndex) {
+        ASSERT_THAT(IsTrue(Actual.Vertices[VertexIndex].Equals(Expected.Vertices[VertexIndex])));
+      }
+    };
+    using FGolfBall = TPolyhedronPipeline<FTruncate, FKis, FTruncate, FIcosahedron>;
+    ASSERT_THAT(AreEqual(FGolfBall::GetNotation(), FString(TEXT("tktI"))));
+    CheckPipeline(FGolfBall::GetNotation(), FGolfBall::Generate());
+    using FGeodesic = TPolyhedronPipeline<TSubdivide<3>, FDual, TGoldberg<2, 1>>;
+    CheckPipeline(FGeodesic::GetNotation(), FGeodesic::Generate());
+    CheckPipeline(TEXT("C"), TPolyhedronPipeline<FCube>::Generate());
+  }
+};
+
+TEST_CLASS(PolyhedronOperationTest, "Polyhedron") {
+
+  TEST_METHOD(Subdivide) {
+    // u4I is the class I geodesic sphere of frequency 4: 10 * 4^2 + 2 vertices and 20 * 4^2 triangles, all on the sphere.
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("u4I"));
+    ASSERT_THAT(AreEqual(Polyhedron.GetVertexCount(), 162));
+    ASSERT_THAT(AreEqual(Polyhedron.GetPolygonCount(), 320));
+    for (const FVector& Vertex : Polyhedron.Vertices) {
+      ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Vertex.Size(), 100.0, 1e-3)));
+    }
+
+    // The polygons that are not triangles are split as a fan around their center: each square of u2C makes 4 * 2^2 triangles.
+    FPolyhedronMesh Cube = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("u2C"));
+    ASSERT_THAT(AreEqual(Cube.GetVertexCount(), 50));
+    ASSERT_THAT(AreEqual(Cube.GetPolygonCount(), 96));
+    ASSERT_THAT(AreEqual(FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("du3C")).GetPolygonCount(), 110));
+  }
+
+  TEST_METHOD(LocalOperators) {
+    // Each operator repeats its pattern on the cube's 8 vertices, 12 edges, 6 squares and 24 half-edges.
+    auto CheckOperator = [&] (const TCHAR* Notation, int32 ExpectedVertexCount, int32 ExpectedPolygonCount) {
+      FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(Notation);
+      ASSERT_THAT(AreEqual(Polyhedron.GetVertexCount(), ExpectedVertexCount));
+      ASSERT_THAT(AreEqual(Polyhedron.GetPolygonCount(), ExpectedPolygonCount));
+      // The half-edges refer to the polyhedron, without a copy of it.
+      FPolyhedronExtendedMesh ExtendedPolyhedron = FPolyhedronTools::ComputeEdgeDetails(Polyhedron);
+      ASSERT_THAT(IsTrue(ExtendedPolyhedron.Mesh == &Polyhedron));
+      for (const FPolyhedronDirectedHalfEdge& HalfEdge : ExtendedPolyhedron.PolygonHalfEdges) {
+        ASSERT_THAT(IsTrue(HalfEdge.PolygonIndexAcross != -1));
+      }
+      // The polygons keep facing outward.
+      for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+        ASSERT_THAT(IsTrue(FPolyhedronTools::GetPolygonNormal(Polyhedron, Polygon).Dot(FPolyhedronTools::GetPolygonCenter(Polyhedron, Polygon)) > 0.0));
+      }
+    };
+    CheckOperator(TEXT("lC"), 32, 30);
+    CheckOperator(TEXT("pC"), 32, 30);
+    CheckOperator(TEXT("qC"), 44, 30);
+    CheckOperator(TEXT("wC"), 56, 30);
+    CheckOperator(TEXT("rC"), 8, 6);
+    CheckOperator(TEXT("rgC"), 38, 24);
+
+    // Reflecting twice gives the polyhedron back.
+    FPolyhedronMesh Cube = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("C"));
+    FPolyhedronMesh Reflected = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("rrC"));
+    for (int32 VertexIndex = 0; VertexIndex < Cube.GetVertexCount(); ++VertexIndex) {
+      ASSERT_THAT(IsTrue(Reflected.Vertices[VertexIndex].Equals(Cube.Vertices[VertexIndex], 1e-6)));
+    }
+
+    // A new shape is only a table: here, the midpoints of the edges joined around each vertex make the ambo's vertex triangles.
+    FPolyhedronLocalOperator Operator = {
+      { { EPolyhedronLocalElement::Edge, 0.5, 0.5 } },
+      { { EPolyhedronLocalElement::Vertex, { { EPolyhedronLocalWalk::Self, EPolyhedronLocalElement::Edge } } } }
+    };
+    FPolyhedronMesh Triangles = FPolyhedronOperations::ApplyLocalOperator(FPolyhedronSeeds::Cube(), Operator);
+    ASSERT_THAT(AreEqual(Triangles.GetVertexCount(), 12));
+    ASSERT_THAT(AreEqual(Triangles.GetPolygonCount(), 8));
+  }
+
+  TEST_METHOD(RegionMasks) {
+    FPolyhedronMesh Cube = FPolyhedronSeeds::Cube();
+    TBitArray<> OnePolygon = FPolyhedronOperations::MakePolygonMask(Cube, [] (int32 PolygonIndex) { return PolygonIndex == 0; });
+    TBitArray<> AllPolygons(true, Cube.GetPolygonCount());
+    auto CheckClosed = [&] (const FPolyhedronMesh& Polyhedron, int32 ExpectedVertexCount, int32 ExpectedPolygonCount) {
+      ASSERT_THAT(AreEqual(Polyhedron.GetVertexCount(), ExpectedVertexCount));
+      ASSERT_THAT(AreEqual(Polyhedron.GetPolygonCount(), ExpectedPolygonCount));
+      FPolyhedronExtendedMesh ExtendedPolyhedron = FPolyhedronTools::ComputeEdgeDetails(Polyhedron);
+      for (const FPolyhedronDirectedHalfEdge& HalfEdge : ExtendedPolyhedron.PolygonHalfEdges) {
+        ASSERT_THAT(IsTrue(HalfEdge.PolygonIndexAcross != -1));
+      }
+    };
+
+    // One square of the cube: 4 triangles, or 4 cut corners, or 4 pushed copies, or a 2x2 fan closed by its 4 neighbors.
+    CheckClosed(FPolyhedronOperations::Kis(Cube, OnePolygon), 9, 9);
+    CheckClosed(FPolyhedronOperations::Truncate(Cube, OnePolygon), 16, 10);
+    CheckClosed(FPolyhedronOperations::Chamfer(Cube, OnePolygon), 12, 10);
+    CheckClosed(FPolyhedronOperations::Subdivide(Cube, OnePolygon, 2), 21, 37);
+
+    // The vertices outside of the mask do not move.
+    FPolyhedronMesh Subdivided = FPolyhedronOperations::Subdivide(Cube, OnePolygon, 3);
+    for (int32 VertexIndex = 0; VertexIndex < Cube.GetVertexCount(); ++VertexIndex) {
+      ASSERT_THAT(IsTrue(Subdivided.Vertices[VertexIndex].Equals(Cube.Vertices[VertexIndex])));
+    }
+
+    // A full mask is the same as the unmasked operation.
+    FPolyhedronMesh Chamfered = FPolyhedronOperations::Chamfer(Cube);
+    FPolyhedronMesh MaskChamfered = FPolyhedronOperations::Chamfer(Cube, AllPolygons);
+    ASSERT_THAT(AreEqual(MaskChamfered.GetPolygonCount(), Chamfered.GetPolygonCount()));
+    for (int32 VertexIndex = 0; VertexIndex < Chamfered.GetVertexCount(); ++VertexIndex) {
+      ASSERT_THAT(IsTrue(MaskChamfered.Vertices[VertexIndex].Equals(Chamfered.Vertices[VertexIndex], 1e-9)));
+    }
+    ASSERT_THAT(AreEqual(FPolyhedronOperations::Kis(Cube, AllPolygons).GetPolygonCount(), FPolyhedronOperations::Kis(Cube).GetPolygonCount()));
+    CheckClosed(FPolyhedronOperations::Truncate(Cube, AllPolygons), 24, 14);
+  }
+
+  TEST_METHOD(PolygonCentersAndNormals) {
+    // The batches match the polygons one by one, and Newell's normals match the fan triangles of the planar polygons.
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tktI"));
+    TArray<FVector> Centers = FPolyhedronTools::GetPolygonCenters(Polyhedron);
+    TArray<FVector> Normals = FPolyhedronTools::GetPolygonNormals(Polyhedron);
+    ASSERT_THAT(AreEqual(Centers.Num(), Polyhedron.GetPolygonCount()));
+    ASSERT_THAT(AreEqual(Normals.Num(), Polyhedron.GetPolygonCount()));
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.GetPolygonCount(); ++PolygonIndex) {
+      const FPolyhedronPolygon& Polygon = Polyhedron.Polygons[PolygonIndex];
+      ASSERT_THAT(IsTrue(Centers[PolygonIndex].Equals(FPolyhedronTools::GetPolygonCenter(Polyhedron, Polygon))));
+      ASSERT_THAT(IsTrue(Normals[PolygonIndex].Equals(FPolyhedronTools::GetPolygonNormal(Polyhedron, Polygon))));
+      FVector FanNormal = FVector::ZeroVector;
+      for (int32 PolygonVertexIndex = 2; PolygonVertexIndex < Polygon.VertexIndices.Num(); ++PolygonVertexIndex) {
+        FanNormal += FPolyhedronTools::CalculateNormal(Polyhedron.Vertices[Polygon.VertexIndices[0]], Polyhedron.Vertices[Polygon.VertexIndices[PolygonVertexIndex - 1]], Polyhedron.Vertices[Polygon.VertexIndices[PolygonVertexIndex]]);
+      }
+      ASSERT_THAT(IsTrue(Normals[PolygonIndex].Equals(FanNormal.GetSafeNormal(), 1e-3)));
+    }
+
+    // Scaling fits the furthest vertex on the sphere, projecting moves every vertex on it.
+    FPolyhedronMesh Scaled = FPolyhedronTools::ScaleToSphere(Polyhedron, 10.0);
+    FPolyhedronMesh Projected = FPolyhedronTools::ProjectUntoSphere(Polyhedron, 10.0);
+    double FurthestVertexDistance = 0.0;
+    for (int32 VertexIndex = 0; VertexIndex < Polyhedron.GetVertexCount(); ++VertexIndex) {
+      FurthestVertexDistance = FMath::Max(FurthestVertexDistance, Scaled.Vertices[VertexIndex].Size());
+      ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Projected.Vertices[VertexIndex].Size(), 10.0, 1e-6)));
+    }
+    ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(FurthestVertexDistance, 10.0, 1e-4)));
+  }
+
+  TEST_METHOD(Canonicalize) {
+    // A skewed cube canonicalizes back into a cube: planar squares, with every edge tangent to the unit sphere.
+    FPolyhedronMesh Skewed = FPolyhedronSeeds::Cube();
+    for (int32 VertexIndex = 0; VertexIndex < Skewed.GetVertexCount(); ++VertexIndex) {
+      FVector Offset(FMath::Sin(1.0 + 3.0 * VertexIndex), FMath::Sin(2.0 + 3.0 * VertexIndex), FMath::Sin(3.0 + 3.0 * VertexIndex));
+      Skewed.Vertices[VertexIndex] = (Skewed.Vertices[VertexIndex] + 0.08 * Offset) * 37.0;
+    }
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::Canonicalize(Skewed, 1000);
+    ASSERT_THAT(AreEqual(Polyhedron.GetPolygonCount(), Skewed.GetPolygonCount()));
+    for (const FVector& Vertex : Polyhedron.Vertices) {
+      ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Vertex.Size(), FMath::Sqrt(1.5), 1e-3)));
+    }
+    for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+      FVector Normal = FPolyhedronTools::GetPolygonNormal(Polyhedron, Polygon);
+      FVector Center = FPolyhedronTools::GetPolygonCenter(Polyhedron, Polygon);
+      int32 VertexFrom = Polygon.VertexIndices.Last();
+      for (int32 VertexTo : Polygon.VertexIndices) {
+        ASSERT_THAT(IsTrue(FMath::Abs(Normal.Dot(Polyhedron.Vertices[VertexTo] - Center)) < 1e-4));
+        FVector Midpoint = 0.5 * (Polyhedron.Vertices[VertexFrom] + Polyhedron.Vertices[VertexTo]);
+        ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Midpoint.Size(), 1.0, 1e-3)));
+        VertexFrom = VertexTo;
+      }
+    }
+
+    // The K symbol keeps the topology, and cannot be recorded for re-evaluation.
+    ASSERT_THAT(AreEqual(FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("KtkD")).GetPolygonCount(), FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tkD")).GetPolygonCount()));
+    FPolyhedronParametricMesh ParametricMesh;
+    ASSERT_THAT(IsFalse(ParametricMesh.Build(TEXT("KtkD"))));
+  }
+
+  TEST_METHOD(Provenance) {
+    // Record tktI, remembering where the stages of tI end.
+    FPolyhedronOperationRecorder Recorder;
+    Recorder.bRecordProvenance = true;
+    FPolyhedronMesh Icosahedron = FPolyhedronSeeds::Icosahedron();
+    FPolyhedronMesh TruncatedIcosahedron = FPolyhedronOperations::Truncate(Icosahedron, 0.1, &Recorder);
+    int32 TruncatedStageIndex = Recorder.Stages.Num();
+    FPolyhedronMesh Polyhedron = FPolyhedronOperations::Truncate(FPolyhedronOperations::Kis(TruncatedIcosahedron, 0, 0.1, &Recorder), 0.1, &Recorder);
+
+    auto FindClosest = [] (const TArray<FVector>& Directions, const FVector& Direction) -> int32 {
+      int32 ClosestIndex = INDEX_NONE;
+      double ClosestDot = -2.0;
+      for (int32 Index = 0; Index < Directions.Num(); ++Index) {
+        double Dot = Directions[Index].GetSafeNormal().Dot(Direction.GetSafeNormal());
+        if (Dot > ClosestDot) {
+          ClosestIndex = Index;
+          ClosestDot = Dot;
+        }
+      }
+      return ClosestIndex;
+    };
+    TArray<FVector> TruncatedCenters;
+    for (const FPolyhedronPolygon& Polygon : TruncatedIcosahedron.Polygons) {
+      TruncatedCenters.Add(FPolyhedronTools::GetPolygonCenter(TruncatedIcosahedron, Polygon));
+    }
+
+    // Back to tI: the 32 polygons over the apexes, the 60 over the vertices, and the 180 over the half-edges of tI.
+    TArray<FPolyhedronProvenance> PolygonSources = Recorder.ComposePolygonSources(TruncatedStageIndex);
+    ASSERT_THAT(AreEqual(PolygonSources.Num(), Polyhedron.GetPolygonCount()));
+    int32 ElementCounts[4] = {};
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.GetPolygonCount(); ++PolygonIndex) {
+      const FPolyhedronProvenance& Source = PolygonSources[PolygonIndex];
+      ++ElementCounts[static_cast<int32>(Source.Element)];
+      ASSERT_THAT(IsTrue(Source.PolygonIndex >= 0 && Source.PolygonIndex < TruncatedIcosahedron.GetPolygonCount()));
+      FVector Center = FPolyhedronTools::GetPolygonCenter(Polyhedron, Polyhedron.Polygons[PolygonIndex]);
+      if (Source.Element == EPolyhedronLocalElement::Polygon) {
+        ASSERT_THAT(AreEqual(FindClosest(TruncatedCenters, Center), Source.Index));
+      } else if (Source.Element == EPolyhedronLocalElement::Vertex) {
+        ASSERT_THAT(AreEqual(FindClosest(TruncatedIcosahedron.Vertices, Center), Source.Index));
+      }
+    }
+    ASSERT_THAT(AreEqual(ElementCounts[static_cast<int32>(EPolyhedronLocalElement::Polygon)], 32));
+    ASSERT_THAT(AreEqual(ElementCounts[static_cast<int32>(EPolyhedronLocalElement::Vertex)], 60));
+    ASSERT_THAT(AreEqual(ElementCounts[static_cast<int32>(EPolyhedronLocalElement::HalfEdge)], 180));
+
+    // Back to I: each pentagon sits over a vertex of the icosahedron.
+    PolygonSources = Recorder.ComposePolygonSources();
+    ASSERT_THAT(AreEqual(PolygonSources.Num(), Polyhedron.GetPolygonCount()));
+    int32 PentagonCount = 0;
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.GetPolygonCount(); ++PolygonIndex) {
+      ASSERT_THAT(IsTrue(PolygonSources[PolygonIndex].PolygonIndex >= 0 && PolygonSources[PolygonIndex].PolygonIndex < Icosahedron.GetPolygonCount()));
+      if (Polyhedron.Polygons[PolygonIndex].VertexIndices.Num() != 5) continue;
+      ++PentagonCount;
+      ASSERT_THAT(IsTrue(PolygonSources[PolygonIndex].Element == EPolyhedronLocalElement::Vertex));
+      FVector Center = FPolyhedronTools::GetPolygonCenter(Polyhedron, Polyhedron.Polygons[PolygonIndex]);
+      ASSERT_THAT(AreEqual(FindClosest(Icosahedron.Vertices, Center), PolygonSources[PolygonIndex].Index));
+    }
+    ASSERT_THAT(AreEqual(PentagonCount, 12));
+    ASSERT_THAT(AreEqual(Recorder.ComposeVertexSources().Num(), Polyhedron.GetVertexCount()));
+
+    // The masked operations record their provenance too: every triangle of u2I stays over its face of I.
+    FPolyhedronOperationRecorder SubdivideRecorder;
+    SubdivideRecorder.bRecordProvenance = true;
+    FPolyhedronMesh Subdivided = FPolyhedronOperations::Subdivide(Icosahedron, 2, &SubdivideRecorder);
+    TArray<FVector> IcosahedronCenters;
+    for (const FPolyhedronPolygon& Polygon : Icosahedron.Polygons) {
+      IcosahedronCenters.Add(FPolyhedronTools::GetPolygonCenter(Icosahedron, Polygon));
+    }
+    PolygonSources = SubdivideRecorder.ComposePolygonSources();
+    ASSERT_THAT(AreEqual(PolygonSources.Num(), Subdivided.GetPolygonCount()));
+    for (int32 PolygonIndex = 0; PolygonIndex < Subdivided.GetPolygonCount(); ++PolygonIndex) {
+      FVector Center = FPolyhedronTools::GetPolygonCenter(Subdivided, Subdivided.Polygons[PolygonIndex]);
+      ASSERT_THAT(AreEqual(FindClosest(IcosahedronCenters, Center), PolygonSources[PolygonIndex].Index));
+    }
+  }
+
+  TEST_METHOD(SizePrediction) {
+    // The predicted sizes match the generated polyhedra, down to their polygon sizes and vertex degrees.
+    for (const TCHAR* Notation : { TEXT("tktI"), TEXT("u3kC"), TEXT("uaC"), TEXT("G3,1"), TEXT("wqC"), TEXT("sO"), TEXT("cgC"), TEXT("bpA5"), TEXT("olP4"), TEXT("mnY5"), TEXT("reA2") }) {
+      FPolyhedronMeshSize Predicted;
+      ASSERT_THAT(IsTrue(FPolyhedronTools::PredictConwayPolyhedronNotation(Notation, Predicted)));
+      FPolyhedronMeshSize Measured = FPolyhedronMeshSize::Measure(FPolyhedronTools::GenerateFromConwayPolyhedronNotation(Notation));
+      ASSERT_THAT(AreEqual(Predicted.VertexCount, Measured.VertexCount));
+      ASSERT_THAT(AreEqual(Predicted.EdgeCount, Measured.EdgeCount));
+      ASSERT_THAT(AreEqual(Predicted.PolygonCount, Measured.PolygonCount));
+      ASSERT_THAT(IsTrue(Predicted.PolygonSideCounts.OrderIndependentCompareEqual(Measured.PolygonSideCounts)));
+      ASSERT_THAT(IsTrue(Predicted.VertexDegreeCounts.OrderIndependentCompareEqual(Measured.VertexDegreeCounts)));
+      ASSERT_THAT(IsTrue(Predicted.PeakMemorySize >= Measured.GetMemorySize()));
+    }
+
+    // Broken seeds are not predicted, and the polyhedra past the int32 indices are refused before any work.
+    FPolyhedronMeshSize Predicted;
+    ASSERT_THAT(IsFalse(FPolyhedronTools::PredictConwayPolyhedronNotation(TEXT("kP2"), Predicted)));
+    ASSERT_THAT(IsTrue(FPolyhedronTools::PredictConwayPolyhedronNotation(TEXT("u100u100I"), Predicted)));
+    ASSERT_THAT(IsFalse(FPolyhedronTools::CheckMemoryBudget(Predicted)));
+    ASSERT_THAT(AreEqual(FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("u100u100I")).GetPolygonCount(), 0));
+  }
+};
+
+TEST_CLASS(PolyhedronSymmetryTest, "Polyhedron") {
+
+  TEST_METHOD(Rotations) {
+    ASSERT_THAT(AreEqual(FPolyhedronSymmetry::FindRotations(FPolyhedronSeeds::Tetrahedron()).Num(), 12));
+    ASSERT_THAT(AreEqual(FPolyhedronSymmetry::FindRotations(FPolyhedronSeeds::Cube()).Num(), 24));
+    ASSERT_THAT(AreEqual(FPolyhedronSymmetry::FindRotations(FPolyhedronSeeds::Octahedron()).Num(), 24));
+    ASSERT_THAT(AreEqual(FPolyhedronSymmetry::FindRotations(FPolyhedronSeeds::Icosahedron()).Num(), 60));
+    ASSERT_THAT(AreEqual(FPolyhedronSymmetry::FindRotations(FPolyhedronSeeds::Dodecahedron()).Num(), 60));
+    ASSERT_THAT(AreEqual(FPolyhedronSymmetry::FindRotations(FPolyhedronSeeds::Prism(5)).Num(), 10));
+    ASSERT_THAT(AreEqual(FPolyhedronSymmetry::FindRotations(FPolyhedronSeeds::Pyramid(5)).Num(), 5));
+    // The chiral Goldberg polyhedra keep all their rotations.
+    ASSERT_THAT(AreEqual(FPolyhedronSymmetry::FindRotations(FPolyhedronSeeds::Goldberg(3, 1)).Num(), 60));
+  }
+
+  TEST_METHOD(Generation) {
+    // The replicated domains must weld into the same polyhedron as the full generation.
+    for (const TCHAR* Notation : { TEXT("ku10I"), TEXT("tu8I"), TEXT("su6I"), TEXT("gu4aC"), TEXT("ku8P5"), TEXT("dkD") }) {
+      FPolyhedronMesh Expected = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(Notation);
+      FPolyhedronMesh Actual = FPolyhedronSymmetry::GenerateFromConwayPolyhedronNotation(Notation);
+      ASSERT_THAT(AreEqual(Actual.GetVertexCount(), Expected.GetVertexCount()));
+      ASSERT_THAT(AreEqual(Actual.GetPolygonCount(), Expected.GetPolygonCount()));
+      for (const FVector& ExpectedVertex : Expected.Vertices) {
+        ASSERT_THAT(IsTrue(Actual.Vertices.ContainsByPredicate([&] (const FVector& Vertex) { return Vertex.Equals(ExpectedVertex, 0.5); })));
+      }
+    }
+  }
+};
+
+TEST_CLASS(PolyhedronStreamingTest, "Polyhedron") {
+
+  TEST_METHOD(Tiles) {
+    // The base level of u4I has 320 polygons; k and u2 refine it.
+    FPolyhedronStreamer Streamer(TEXT("u2ku4I"), 100.0, EPolyhedronUVGeneration::Spherical, FPolyhedronOperationParameters(), 100);
+    ASSERT_THAT(IsTrue(Streamer.IsValid()));
+    ASSERT_THAT(AreEqual(Streamer.GetTileCount(), 320));
+    ASSERT_THAT(AreEqual(Streamer.GetMaxDepth(), 2));
+
+    // At every depth, the tiles cover the polyhedron exactly once.
+    const TCHAR* DepthNotations[] = { TEXT("u4I"), TEXT("ku4I"), TEXT("u2ku4I") };
+    for (int32 Depth = 0; Depth <= Streamer.GetMaxDepth(); ++Depth) {
+      int32 PolygonTotal = 0;
+      double FurthestVertexDistance = 0.0;
+      for (int32 TileIndex = 0; TileIndex < Streamer.GetTileCount(); ++TileIndex) {
+        FPolyhedronStreamingTile Tile = Streamer.GenerateTile(TileIndex, Depth);
+        ASSERT_THAT(IsTrue(Tile.Section.Triangles.Num() > 0));
+        PolygonTotal += Tile.Polyhedron.GetPolygonCount();
+        for (const FVector& Vertex : Tile.Polyhedron.Vertices) {
+          FurthestVertexDistance = FMath::Max(FurthestVertexDistance, Vertex.Size());
+        }
+      }
+      ASSERT_THAT(AreEqual(PolygonTotal, FPolyhedronTools::GenerateFromConwayPolyhedronNotation(DepthNotations[Depth]).GetPolygonCount()));
+      ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(FurthestVertexDistance, 100.0, 5.0)));
+    }
+  }
+
+  TEST_METHOD(Patches) {
+    // The three operations of t spread too far to patch u4I: the base level takes k as well.
+    FPolyhedronStreamer CoarseStreamer(TEXT("tku4I"), 100.0, EPolyhedronUVGeneration::Spherical, FPolyhedronOperationParameters(), 100);
+    ASSERT_THAT(IsTrue(CoarseStreamer.IsValid()));
+    ASSERT_THAT(AreEqual(CoarseStreamer.GetTileCount(), 960));
+    ASSERT_THAT(AreEqual(CoarseStreamer.GetMaxDepth(), 1));
+
+    // Each depth refines a patch trimmed from the previous one: at the full depth, it stays well below the full polyhedron.
+    FPolyhedronStreamer Streamer(TEXT("u2ku4I"), 100.0, EPolyhedronUVGeneration::Spherical, FPolyhedronOperationParameters(), 100);
+    ASSERT_THAT(IsTrue(Streamer.IsValid()));
+    int32 FullPolygonCount = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("u2ku4I")).GetPolygonCount();
+    for (int32 TileIndex = 0; TileIndex < Streamer.GetTileCount(); TileIndex += 17) {
+      FPolyhedronStreamingTile Tile = Streamer.GenerateTile(TileIndex, Streamer.GetMaxDepth());
+      ASSERT_THAT(AreEqual(Tile.TileIndex, TileIndex));
+      ASSERT_THAT(IsTrue(Tile.PatchPolygonCount * 4 < FullPolygonCount));
+    }
+
+    // The base level of a tile is its own polygon.
+    ASSERT_THAT(AreEqual(Streamer.GenerateTile(0, 0).PatchPolygonCount, 1));
+  }
+
+  TEST_METHOD(BaseOnly) {
+    // The base level of I is all of it, and K must run on the full polyhedron: neither has finer depths.
+    const TCHAR* Notations[] = { TEXT("I"), TEXT("KkI") };
+    for (const TCHAR* Notation : Notations) {
+      FPolyhedronStreamer Streamer(Notation, 100.0, EPolyhedronUVGeneration::Spherical, FPolyhedronOperationParameters(), 100);
+      ASSERT_THAT(IsTrue(Streamer.IsValid()));
+      ASSERT_THAT(AreEqual(Streamer.GetTileCount(), FPolyhedronTools::GenerateFromConwayPolyhedronNotation(Notation).GetPolygonCount()));
+      ASSERT_THAT(AreEqual(Streamer.GetMaxDepth(), 0));
+      for (int32 TileIndex = 0; TileIndex < Streamer.GetTileCount(); ++TileIndex) {
+        ASSERT_THAT(IsTrue(Streamer.GetResidentTile(TileIndex).Section.Triangles.Num() > 0));
+      }
+    }
+  }
+
+  TEST_METHOD(Update) {
+    FPolyhedronStreamer Streamer(TEXT("tku4I"), 100.0, EPolyhedronUVGeneration::Spherical, FPolyhedronOperationParameters(), 100);
+    ASSERT_THAT(IsTrue(Streamer.IsValid()));
+    FPolyhedronStreamer::FSettings Settings;
+    Settings.DetailDistance = 1.0;
+
+    // Without memory to spare, every tile stays at the base level.
+    FVector ViewLocation = FPolyhedronTools::GetPolygonCenter(Streamer.GetBasePolyhedron(), Streamer.GetBasePolyhedron().Polygons[0]);
+    Settings.MemoryBudgetBytes = 0;
+    ASSERT_THAT(AreEqual(Streamer.Update(MakeArrayView(&ViewLocation, 1), Settings).Num(), 0));
+    ASSERT_THAT(AreEqual(Streamer.GetJobCount(), 0));
+
+    // The tile under the viewer is refined to the full depth, the opposite one stays at the base level.
+    Settings.MemoryBudgetBytes = 256ll << 20;
+    for (int32 Attempt = 0; Attempt < 1000 && Streamer.GetResidentTile(0).Depth != Streamer.GetMaxDepth(); ++Attempt) {
+      Streamer.Update(MakeArrayView(&ViewLocation, 1), Settings);
+      FPlatformProcess::Sleep(0.01f);
+    }
+    ASSERT_THAT(AreEqual(Streamer.GetResidentTile(0).Depth, Streamer.GetMaxDepth()));
+    int32 OppositeTileIndex = FPolyhedronTools::GetPolygonAt(Streamer.GetBasePolyhedron(), -ViewLocation);
+    ASSERT_THAT(IsTrue(OppositeTileIndex > 0));
+    ASSERT_THAT(AreEqual(Streamer.GetResidentTile(OppositeTileIndex).Depth, 0));
+
+    // Without viewers, the tiles fall back to the base level right away.
+    Streamer.Update(TArrayView<const FVector>(), Settings);
+    ASSERT_THAT(AreEqual(Streamer.GetResidentTile(0).Depth, 0));
+  }
+};
+
+TEST_CLASS(PolyhedronPathfindingTest, "Polyhedron") {
+
+  TEST_METHOD(Graph) {
+    // Each square of the cube has 4 neighbors, across its half-edges, and each of them lists it back at the same distance.
+    FPolyhedronMesh Cube = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("C"));
+    FPolyhedronPolygonGraph Graph = FPolyhedronTools::ComputePolygonGraph(Cube);
+    ASSERT_THAT(AreEqual(Graph.GetPolygonCount(), 6));
+    ASSERT_THAT(AreEqual(Graph.Neighbors.Num(), 24));
+    for (int32 PolygonIndex = 0; PolygonIndex < Graph.GetPolygonCount(); ++PolygonIndex) {
+      TArrayView<const int32> Neighbors = Graph.GetNeighbors(PolygonIndex);
+      ASSERT_THAT(AreEqual(Neighbors.Num(), 4));
+      for (int32 NeighborIndex = 0; NeighborIndex < Neighbors.Num(); ++NeighborIndex) {
+        int32 BackIndex = Graph.GetNeighbors(Neighbors[NeighborIndex]).Find(PolygonIndex);
+        ASSERT_THAT(IsTrue(BackIndex != INDEX_NONE));
+        ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Graph.GetNeighborDistances(Neighbors[NeighborIndex])[BackIndex], Graph.GetNeighborDistances(PolygonIndex)[NeighborIndex])));
+      }
+    }
+  }
+
+  TEST_METHOD(Paths) {
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tktI"));
+    FPolyhedronPolygonGraph Graph = FPolyhedronTools::ComputePolygonGraph(Polyhedron);
+    FPolyhedronPathfinder Pathfinder(Graph);
+
+    // A* finds the same costs as Dijkstra, along paths of neighbors.
+    TArray<FPolyhedronPathQuery> Queries;
+    for (int32 QueryIndex = 0; QueryIndex < 16; ++QueryIndex) {
+      Queries.Add({ (QueryIndex * 37) % Graph.GetPolygonCount(), (QueryIndex * 101 + 50) % Graph.GetPolygonCount() });
+    }
+    TArray<FPolyhedronPath> Paths = FPolyhedronPathfinder::FindPaths(Graph, Queries);
+    ASSERT_THAT(AreEqual(Paths.Num(), Queries.Num()));
+    for (int32 QueryIndex = 0; QueryIndex < Queries.Num(); ++QueryIndex) {
+      const FPolyhedronPath& Path = Paths[QueryIndex];
+      ASSERT_THAT(IsTrue(Path.IsValid()));
+      ASSERT_THAT(AreEqual(Path.PolygonIndices[0], Queries[QueryIndex].StartPolygonIndex));
+      ASSERT_THAT(AreEqual(Path.PolygonIndices.Last(), Queries[QueryIndex].GoalPolygonIndex));
+      for (int32 PathIndex = 1; PathIndex < Path.PolygonIndices.Num(); ++PathIndex) {
+        ASSERT_THAT(IsTrue(Graph.GetNeighbors(Path.PolygonIndices[PathIndex - 1]).Contains(Path.PolygonIndices[PathIndex])));
+      }
+      Pathfinder.ComputeCosts(MakeArrayView(&Queries[QueryIndex].StartPolygonIndex, 1));
+      ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Pathfinder.GetCost(Queries[QueryIndex].GoalPolygonIndex), Path.Cost, 1e-2f)));
+    }
+
+    // Blocking the neighbors of a polygon cuts it off; making them expensive only slows the way through.
+    int32 Start = 0;
+    TArray<float> PolygonCosts;
+    PolygonCosts.Init(1.0f, Graph.GetPolygonCount());
+    for (int32 Neighbor : Graph.GetNeighbors(Start)) {
+      PolygonCosts[Neighbor] = -1.0f;
+    }
+    FPolyhedronPath Path;
+    FPolyhedronPathfinder BlockedPathfinder(Graph, PolygonCosts);
+    ASSERT_THAT(IsFalse(BlockedPathfinder.FindPath(Start, Graph.GetPolygonCount() - 1, Path)));
+    ASSERT_THAT(IsTrue(BlockedPathfinder.FindPath(Start, Start, Path)));
+    ASSERT_THAT(AreEqual(Path.PolygonIndices.Num(), 1));
+    for (int32 Neighbor : Graph.GetNeighbors(Start)) {
+      PolygonCosts[Neighbor] = 10.0f;
+    }
+    FPolyhedronPathfinder ExpensivePathfinder(Graph, PolygonCosts);
+    ASSERT_THAT(IsTrue(ExpensivePathfinder.FindPath(Start, Graph.GetPolygonCount() - 1, Path)));
+    FPolyhedronPath CheapPath;
+    ASSERT_THAT(IsTrue(Pathfinder.FindPath(Start, Graph.GetPolygonCount() - 1, CheapPath)));
+    ASSERT_THAT(IsTrue(Path.Cost > CheapPath.Cost));
+
+    // Dijkstra stops at MaxCost.
+    Pathfinder.ComputeCosts(MakeArrayView(&Start, 1), 1.0f);
+    ASSERT_THAT(AreEqual(Pathfinder.GetCost(Start), 0.0f));
+    ASSERT_THAT(AreEqual(Pathfinder.GetCost(Graph.GetNeighbors(Start)[0]), TNumericLimits<float>::Max()));
+  }
+
+  TEST_METHOD(Partition) {
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tktI"));
+    FPolyhedronPolygonGraph Graph = FPolyhedronTools::ComputePolygonGraph(Polyhedron);
+    TArray<int32> Seeds = { 0, 100, 200 };
+    FPolyhedronPartition Partition = FPolyhedronPathfinder::Partition(Graph, Seeds);
+    ASSERT_THAT(AreEqual(Partition.RegionIndices.Num(), Graph.GetPolygonCount()));
+
+    // Each polygon is as far from its seed as the closest seed that Dijkstra finds.
+    FPolyhedronPathfinder Pathfinder(Graph);
+    Pathfinder.ComputeCosts(Seeds);
+    TArray<float> ClosestCosts;
+    for (int32 PolygonIndex = 0; PolygonIndex < Graph.GetPolygonCount(); ++PolygonIndex) {
+      ClosestCosts.Add(Pathfinder.GetCost(PolygonIndex));
+    }
+    for (int32 RegionIndex = 0; RegionIndex < Seeds.Num(); ++RegionIndex) {
+      ASSERT_THAT(AreEqual(Partition.RegionIndices[Seeds[RegionIndex]], RegionIndex));
+      Pathfinder.ComputeCosts(MakeArrayView(&Seeds[RegionIndex], 1));
+      for (int32 PolygonIndex = 0; PolygonIndex < Graph.GetPolygonCount(); ++PolygonIndex) {
+        if (Partition.RegionIndices[PolygonIndex] != RegionIndex) continue;
+        ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Partition.Distances[PolygonIndex], Pathfinder.GetCost(PolygonIndex), 1e-2f)));
+        ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Partition.Distances[PolygonIndex], ClosestCosts[PolygonIndex], 1e-2f)));
+      }
+    }
+
+    // By steps, the neighbors of a seed are one step away; past MaxDistance, the polygons belong to no region.
+    FPolyhedronPartitionSettings Settings;
+    Settings.bCountSteps = true;
+    Settings.MaxDistance = 2.0f;
+    FPolyhedronPartition Steps = FPolyhedronPathfinder::Partition(Graph, Seeds, Settings);
+    for (int32 Neighbor : Graph.GetNeighbors(Seeds[0])) {
+      ASSERT_THAT(AreEqual(Steps.Distances[Neighbor], 1.0f));
+    }
+    int32 ReachedCount = 0;
+    for (int32 RegionIndex : Steps.RegionIndices) {
+      ReachedCount += RegionIndex != INDEX_NONE ? 1 : 0;
+    }
+    ASSERT_THAT(IsTrue(ReachedCount > Seeds.Num() && ReachedCount < Graph.GetPolygonCount()));
+
+    // The regions can paint the materials of the polyhedron.
+    TArray<int32> RegionMaterialIndices = { 3, 4, 5 };
+    Partition.AssignMaterialIndices(Polyhedron, RegionMaterialIndices);
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.GetPolygonCount(); ++PolygonIndex) {
+      ASSERT_THAT(AreEqual(Polyhedron.Polygons[PolygonIndex].MaterialIndex, 3 + Partition.RegionIndices[PolygonIndex]));
+    }
+  }
+};
+
+TEST_CLASS(PolyhedronTerrainTest, "Polyhedron") {
+
+  TEST_METHOD(Displacement) {
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tktI"));
+    FPolyhedronPolygonGraph Graph = FPolyhedronTools::ComputePolygonGraph(Polyhedron);
+    FPolyhedronTerrainSettings Settings;
+    Settings.ChunkPolygonCount = 32;
+    FPolyhedronTerrain Terrain(Polyhedron, Settings);
+    // 272 polygons make about 8.5 chunks of 32: the closest cube map around the polyhedron has one cell per face.
+    ASSERT_THAT(AreEqual(Polyhedron.GetPolygonCount(), 272));
+    ASSERT_THAT(AreEqual(Terrain.GetChunkCount(), 6));
+
+    // Each chunk holds its caps, then one quad per edge; a flat terrain has no dirty chunk.
+    TArray<int32> CapVertexTotals, ChunkPolygonCounts;
+    CapVertexTotals.SetNumZeroed(Terrain.GetChunkCount());
+    ChunkPolygonCounts.SetNumZeroed(Terrain.GetChunkCount());
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.GetPolygonCount(); ++PolygonIndex) {
+      CapVertexTotals[Terrain.GetChunkIndex(PolygonIndex)] += Polyhedron.Polygons[PolygonIndex].VertexIndices.Num();
+      ++ChunkPolygonCounts[Terrain.GetChunkIndex(PolygonIndex)];
+    }
+    // The seeds are spread over the surface, so that no chunk is more than twice the average.
+    for (int32 ChunkPolygonCount : ChunkPolygonCounts) {
+      ASSERT_THAT(IsTrue(ChunkPolygonCount > 0 && ChunkPolygonCount * Terrain.GetChunkCount() <= 2 * Polyhedron.GetPolygonCount()));
+    }
+    int32 WallTotal = 0;
+    for (int32 ChunkIndex = 0; ChunkIndex < Terrain.GetChunkCount(); ++ChunkIndex) {
+      const FPolyhedronSection& Section = Terrain.GetChunkSection(ChunkIndex);
+      ASSERT_THAT(IsFalse(Terrain.IsChunkDirty(ChunkIndex)));
+      ASSERT_THAT(AreEqual(Section.UVs.Num(), Section.Positions.Num()));
+      WallTotal += (Section.Positions.Num() - CapVertexTotals[ChunkIndex]) / 4;
+    }
+    ASSERT_THAT(AreEqual(WallTotal, Graph.Neighbors.Num() / 2));
+
+    // Raising one cell only dirties its chunk and the chunks of the walls along it.
+    int32 RaisedPolygonIndex = 100;
+    Terrain.SetHeight(RaisedPolygonIndex, 10.0f);
+    TSet<int32> ExpectedChunkIndices = { Terrain.GetChunkIndex(RaisedPolygonIndex) };
+    for (int32 Neighbor : Graph.GetNeighbors(RaisedPolygonIndex)) {
+      if (Neighbor < RaisedPolygonIndex) ExpectedChunkIndices.Add(Terrain.GetChunkIndex(Neighbor));
+    }
+    TArray<int32> UpdatedChunkIndices = Terrain.Update();
+    ASSERT_THAT(AreEqual(UpdatedChunkIndices.Num(), ExpectedChunkIndices.Num()));
+    for (int32 ChunkIndex : UpdatedChunkIndices) {
+      ASSERT_THAT(IsTrue(ExpectedChunkIndices.Contains(ChunkIndex)));
+      ASSERT_THAT(IsFalse(Terrain.IsChunkDirty(ChunkIndex)));
+    }
+
+    // The raised cap sits 10 further from the center, and only its walls stand, facing away from it.
+    const FPolyhedronSection& RaisedSection = Terrain.GetChunkSection(Terrain.GetChunkIndex(RaisedPolygonIndex));
+    FVector RaisedVertex = Polyhedron.Vertices[Polyhedron.Polygons[RaisedPolygonIndex].VertexIndices[0]];
+    ASSERT_THAT(IsTrue(RaisedSection.Positions.ContainsByPredicate([&] (const FVector& Position) {
+      return Position.Equals(RaisedVertex + 10.0 * RaisedVertex.GetSafeNormal(), 1e-3);
+    })));
+    int32 StandingWallCount = 0;
+    for (int32 ChunkIndex = 0; ChunkIndex < Terrain.GetChunkCount(); ++ChunkIndex) {
+      const FPolyhedronSection& Section = Terrain.GetChunkSection(ChunkIndex);
+      for (int32 WallVertexOffset = CapVertexTotals[ChunkIndex]; WallVertexOffset < Section.Positions.Num(); WallVertexOffset += 4) {
+        if (Section.Normals[WallVertexOffset].IsZero()) continue;
+        FVector WallCenter = (Section.Positions[WallVertexOffset] + Section.Positions[WallVertexOffset + 2]) / 2.0;
+        ASSERT_THAT(IsTrue(Section.Normals[WallVertexOffset].Dot(WallCenter - Graph.Centers[RaisedPolygonIndex]) > 0.0));
+        ++StandingWallCount;
+      }
+    }
+    ASSERT_THAT(AreEqual(StandingWallCount, Graph.GetNeighbors(RaisedPolygonIndex).Num()));
+
+    // Setting the same heights again dirties nothing.
+    TArray<float> Heights;
+    for (int32 PolygonIndex = 0; PolygonIndex < Terrain.GetPolygonCount(); ++PolygonIndex) {
+      Heights.Add(Terrain.GetHeight(PolygonIndex));
+    }
+    Terrain.SetHeights(Heights);
+    ASSERT_THAT(AreEqual(Terrain.Update().Num(), 0));
+  }
+
+  TEST_METHOD(Materials) {
+    // Paint two halves of the polyhedron with their own material.
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tktI"));
+    FPolyhedronPolygonGraph Graph = FPolyhedronTools::ComputePolygonGraph(Polyhedron);
+    int32 OppositePolygonIndex = FPolyhedronTools::GetPolygonAt(Polyhedron, -Graph.Centers[0]);
+    TArray<int32> Seeds = { 0, OppositePolygonIndex }, RegionMaterialIndices = { 3, 5 };
+    FPolyhedronPathfinder::Partition(Graph, Seeds).AssignMaterialIndices(Polyhedron, RegionMaterialIndices);
+    FPolyhedronTerrainSettings Settings;
+    Settings.ChunkPolygonCount = 32;
+    FPolyhedronTerrain Terrain(Polyhedron, Settings);
+
+    // The chunks never mix materials, and their sections keep the material of their cells.
+    TSet<int32> SectionMaterialIndices;
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.GetPolygonCount(); ++PolygonIndex) {
+      int32 MaterialIndex = Terrain.GetChunkSection(Terrain.GetChunkIndex(PolygonIndex)).MaterialIndex;
+      ASSERT_THAT(AreEqual(MaterialIndex, Polyhedron.Polygons[PolygonIndex].MaterialIndex));
+      SectionMaterialIndices.Add(MaterialIndex);
+    }
+    ASSERT_THAT(AreEqual(SectionMaterialIndices.Num(), 2));
+    ASSERT_THAT(IsTrue(Terrain.GetChunkCount() > 6));
+  }
+};
+
+TEST_CLASS(PolyhedronSectionTest, "Polyhedron") {
+
+  TEST_METHOD(PolygonUVs) {
+    // 1280 triangles make two rows of polygon states.
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("u8I"));
+    ASSERT_THAT(AreEqual(Polyhedron.GetPolygonCount(), 1280));
+    FPolyhedronSectionBuilder SectionBuilder(Polyhedron, EPolyhedronUVGeneration::Cellular, /*bBuildGeometry=*/true, /*bEncodePolygonIndices=*/true);
+    ASSERT_THAT(IsTrue(SectionBuilder.Build()));
+    ASSERT_THAT(AreEqual(SectionBuilder.GetSections().Num(), 1));
+    const FPolyhedronSection& Section = SectionBuilder.GetSections()[0];
+    ASSERT_THAT(AreEqual(Section.PolygonUVs.Num(), Section.Positions.Num()));
+
+    // Every vertex of a polygon holds the integer texel of the polygon.
+    int32 VertexOffset = 0;
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.GetPolygonCount(); ++PolygonIndex) {
+      FVector2D PolygonUV(PolygonIndex % UPolyhedronComponent::PolygonStateTextureWidth, PolygonIndex / UPolyhedronComponent::PolygonStateTextureWidth);
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < Polyhedron.Polygons[PolygonIndex].VertexIndices.Num(); ++PolygonVertexIndex) {
+        ASSERT_THAT(IsTrue(Section.PolygonUVs[VertexOffset++] == PolygonUV));
+      }
+    }
+    ASSERT_THAT(IsTrue(Section.PolygonUVs.Last() == FVector2D(255.0, 1.0)));
+
+    // Without the option, the sections carry no polygon indices.
+    FPolyhedronSectionBuilder PlainSectionBuilder(Polyhedron, EPolyhedronUVGeneration::Cellular);
+    PlainSectionBuilder.Build();
+    ASSERT_THAT(AreEqual(PlainSectionBuilder.GetSections()[0].PolygonUVs.Num(), 0));
+  }
+
+  TEST_METHOD(SliceUVs) {
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tktI"));
+    for (int32 PolygonIndex = 0; PolygonIndex < Polyhedron.GetPolygonCount(); ++PolygonIndex) {
+      Polyhedron.Polygons[PolygonIndex].MaterialIndex = PolygonIndex % 3;
+    }
+    FPolyhedronSectionBuilder CellularBuilder(Polyhedron, EPolyhedronUVGeneration::Cellular);
+    CellularBuilder.Build();
+    ASSERT_THAT(AreEqual(CellularBuilder.GetSections().Num(), 3));
+
+    // The texture array keeps every polygon in one section, with the cellular texture coordinates of its polygons.
+    FPolyhedronSectionBuilder ArrayBuilder(Polyhedron, EPolyhedronUVGeneration::CellularArray);
+    ArrayBuilder.Build();
+    ASSERT_THAT(AreEqual(ArrayBuilder.GetSections().Num(), 1));
+    const FPolyhedronSection& Section = ArrayBuilder.GetSections()[0];
+    ASSERT_THAT(AreEqual(Section.UVs.Num(), Section.Positions.Num()));
+    ASSERT_THAT(AreEqual(Section.SliceUVs.Num(), Section.Positions.Num()));
+    TArray<int32> CellularVertexOffsets = { 0, 0, 0 };
+    int32 VertexOffset = 0;
+    for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+      const FPolyhedronSection& CellularSection = CellularBuilder.GetSections()[Polygon.MaterialIndex];
+      for (int32 PolygonVertexIndex = 0; PolygonVertexIndex < Polygon.VertexIndices.Num(); ++PolygonVertexIndex) {
+        ASSERT_THAT(IsTrue(Section.SliceUVs[VertexOffset] == FVector2D(Polygon.MaterialIndex, 0.0)));
+        ASSERT_THAT(IsTrue(Section.UVs[VertexOffset++].Equals(CellularSection.UVs[CellularVertexOffsets[Polygon.MaterialIndex]++])));
+      }
+    }
+  }
+
+  TEST_METHOD(SphericalUVs) {
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tktI"));
+    FPolyhedronSectionBuilder SectionBuilder(Polyhedron, EPolyhedronUVGeneration::Spherical);
+    SectionBuilder.Build();
+    const FPolyhedronSection& Section = SectionBuilder.GetSections()[0];
+
+    // The approximated projection stays close to the exact one, up to the wrapping fix-ups of each polygon.
+    int32 VertexOffset = 0;
+    for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+      for (int32 VertexIndex : Polygon.VertexIndices) {
+        const FVector& Vertex = Polyhedron.Vertices[VertexIndex];
+        double ExactU = 1.0 - (FMath::Atan2(Vertex.Y, Vertex.X) + UE_DOUBLE_PI) / UE_DOUBLE_TWO_PI;
+        double ExactV = 1.0 - (FMath::Asin(Vertex.Z / Vertex.Size()) + UE_DOUBLE_HALF_PI) / UE_DOUBLE_PI;
+        const FVector2D& UV = Section.UVs[VertexOffset++];
+        ASSERT_THAT(IsTrue(FMath::Abs(UV.X - ExactU - FMath::RoundToDouble(UV.X - ExactU)) < 1e-5));
+        ASSERT_THAT(IsTrue(FMath::Abs(UV.Y - ExactV) < 1e-5));
+      }
+    }
+  }
+
+  TEST_METHOD(Tangents) {
+    FPolyhedronMesh Polyhedron = FPolyhedronTools::GenerateFromConwayPolyhedronNotation(TEXT("tktI"));
+    for (EPolyhedronUVGeneration UVGeneration : { EPolyhedronUVGeneration::Cellular, EPolyhedronUVGeneration::Spherical, EPolyhedronUVGeneration::Cubic }) {
+      FPolyhedronSectionBuilder SectionBuilder(Polyhedron, UVGeneration);
+      SectionBuilder.Build();
+      const FPolyhedronSection& Section = SectionBuilder.GetSections()[0];
+      ASSERT_THAT(AreEqual(Section.Tangents.Num(), Section.Positions.Num()));
+
+      // Along the edges from the first vertex of each polygon, U grows with the tangent and V with the bitangent.
+      int32 VertexOffset = 0;
+      for (const FPolyhedronPolygon& Polygon : Polyhedron.Polygons) {
+        const FProcMeshTangent& Tangent = Section.Tangents[VertexOffset];
+        FVector Normal = Section.Normals[VertexOffset];
+        ASSERT_THAT(IsTrue(FMath::IsNearlyEqual(Tangent.TangentX.Size(), 1.0, 1e-3)));
+        ASSERT_THAT(IsTrue(FMath::Abs(Tangent.TangentX.Dot(Normal)) < 1e-3));
+        FVector Bitangent = Normal.Cross(Tangent.TangentX) * (Tangent.bFlipTangentY ? -1.0 : 1.0);
+        FVector PolygonCenter = FPolyhedronTools::GetPolygonCenter(Polyhedron, Polygon);
+        bool bNearPole = FMath::Abs(PolygonCenter.GetSafeNormal().Z) > 0.8;
+        for (int32 PolygonVertexIndex = 1; PolygonVertexIndex < Polygon.VertexIndices.Num() && !(UVGeneration == EPolyhedronUVGeneration::Spherical && bNearPole); ++PolygonVertexIndex) {
+          FVector Edge = Section.Positions[VertexOffset + PolygonVertexIndex] - Section.Positions[VertexOffset];
+          FVector2D UVEdge = Section.UVs[VertexOffset + PolygonVertexIndex] - Section.UVs[VertexOffset];
+          if (FMath::Abs(Edge.Dot(Tangent.TangentX)) > 0.2 * Edge.Size()) {
+            ASSERT_THAT(AreEqual(Edge.Dot(Tangent.TangentX) > 0.0, UVEdge.X > 0.0));
+          }
+          if (FMath::Abs(Edge.Dot(Bitangent)) > 0.2 * Edge.Size()) {
+            ASSERT_THAT(AreEqual(Edge.Dot(Bitangent) > 0.0, UVEdge.Y > 0.0));
+          }
+        }
+        VertexOffset += Polygon.VertexIndices.Num();
+      }
+    }
+  }
+};
 
 #endif // WITH_AUTOMATION_TESTS
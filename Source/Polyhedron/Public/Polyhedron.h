@@ -46,11 +46,16 @@ public:
   int32 PolygonIndex, PolygonIndexAcross;
 };
 
+/**
+ * The half-edges of a mesh, as a view over it: the vertices and polygons are not copied, so the mesh must outlive them.
+ */
 USTRUCT()
-struct POLYHEDRON_API FPolyhedronExtendedMesh : public FPolyhedronMesh {
+struct POLYHEDRON_API FPolyhedronExtendedMesh {
   GENERATED_BODY()
 
 public:
+  const FPolyhedronMesh* Mesh = nullptr;
+
   // Used for finding edges faster and to generate more compact work buffers.
   TArray<int32> PolygonHalfEdgeOffsets;
   TArray<int32> VertexHalfEdgeOffsets;
@@ -63,6 +68,26 @@ public: // Helpers
   FPolyhedronDirectedHalfEdge* FindHalfEdge(int32 Vertex1, int32 Vertex2);
 };
 
+/**
+ * The polygons of a polyhedron and their neighbors, as a compressed sparse row graph.
+ * The neighbors of a polygon are listed in the order of its half-edges: its k-th neighbor is across its k-th half-edge.
+ */
+USTRUCT()
+struct POLYHEDRON_API FPolyhedronPolygonGraph {
+  GENERATED_BODY()
+
+public:
+  TArray<int32> NeighborOffsets; // PolygonCount + 1 entries.
+  TArray<int32> Neighbors;
+  TArray<float> NeighborDistances; // Between the polygon centers.
+  TArray<FVector> Centers;
+
+public: // Helpers
+  int32 GetPolygonCount() const { return Centers.Num(); }
+  TArrayView<const int32> GetNeighbors(int32 PolygonIndex) const { return MakeArrayView(Neighbors.GetData() + NeighborOffsets[PolygonIndex], NeighborOffsets[PolygonIndex + 1] - NeighborOffsets[PolygonIndex]); }
+  TArrayView<const float> GetNeighborDistances(int32 PolygonIndex) const { return MakeArrayView(NeighborDistances.GetData() + NeighborOffsets[PolygonIndex], NeighborOffsets[PolygonIndex + 1] - NeighborOffsets[PolygonIndex]); }
+};
+
 UENUM(BlueprintType)
 enum class EPolyhedronUVGeneration : uint8
 {
@@ -76,5 +101,8 @@ enum class EPolyhedronUVGeneration : uint8
   Spherical,
   // Texture Coordinates are generated by applying a cubic projection. This generates texels of non-uniform sizes.
   // This UV generation may show seams.
-  Cubic
+  Cubic,
+  // Texture Coordinates are generated as with Cellular, for a texture array: the MaterialIndex of each polygon picks its slice.
+  // All the polygons go to a single mesh section, drawn with the first material.
+  CellularArray
 };
@@ -8,6 +8,61 @@
 #include "PolyhedronComponent.generated.h"
 
 struct FPolyhedronMesh;
+class FPolyhedronTerrain;
+class UTexture2D;
+
+/**
+ * The mesh buffers of one UPolyhedronComponent section. Each material index gets its own section, except with
+ * EPolyhedronUVGeneration::CellularArray, where the material indices pick texture array slices within a single section.
+ */
+struct POLYHEDRON_API FPolyhedronSection {
+  int32 MaterialIndex = 0;
+  TArray<FVector> Positions;
+  TArray<FVector> Normals;
+  TArray<FVector2D> UVs;
+  // The texel of the polygon of each vertex in the polygon state texture, see UPolyhedronComponent::bEncodePolygonIndices.
+  TArray<FVector2D> PolygonUVs;
+  // The texture array slice of each vertex, in U, with EPolyhedronUVGeneration::CellularArray.
+  TArray<FVector2D> SliceUVs;
+  // Follow the texture coordinates, so that the normal maps need no tangent calculation; empty without texture coordinates.
+  TArray<FProcMeshTangent> Tangents;
+  TArray<int32> Triangles;
+};
+
+/**
+ * Converts a polyhedron into its mesh sections, in resumable slices of polygons.
+ * The polyhedron must outlive the builder.
+ */
+class POLYHEDRON_API FPolyhedronSectionBuilder {
+public:
+  // Without bBuildGeometry, only the texture coordinates are built; see UPolyhedronComponent::UpdatePolyhedronUVs().
+  // With bEncodePolygonIndices, the geometry also gets the PolygonUVs.
+  FPolyhedronSectionBuilder(const FPolyhedronMesh& Polyhedron, EPolyhedronUVGeneration UVGeneration, bool bBuildGeometry = true, bool bEncodePolygonIndices = false);
+
+public:
+  // The section of a polygon, or INDEX_NONE for the polygons that are not drawn.
+  static int32 GetSectionIndex(const FPolyhedronPolygon& Polygon, EPolyhedronUVGeneration UVGeneration);
+  // The tangent of a polygon, along which its U texture coordinate grows, found analytically for each UV generation.
+  static FProcMeshTangent GetPolygonTangent(const FPolyhedronMesh& Polyhedron, const FPolyhedronPolygon& Polygon, const FVector& PolygonNormal, EPolyhedronUVGeneration UVGeneration);
+  // Projects the vertices, then processes polygons until they are all done, returning true, or until the time budget runs out.
+  bool Build(double TimeBudgetSeconds = TNumericLimits<double>::Max());
+  bool IsComplete() const { return NextPolygonIndex >= Polyhedron.Polygons.Num(); }
+  float GetProgress() const;
+  TArray<FPolyhedronSection>& GetSections() { return Sections; }
+
+private:
+  const FPolyhedronMesh& Polyhedron;
+  EPolyhedronUVGeneration UVGeneration;
+  bool bBuildGeometry;
+  bool bEncodePolygonIndices;
+  TArray<FPolyhedronSection> Sections;
+  int32 NextPolygonIndex = 0;
+  // The projection of each vertex, shared by its polygons: its Spherical texture coordinates, or its Cubic direction.
+  // Build() projects the vertices before it processes the polygons.
+  TArray<FVector2D> VertexUVs;
+  TArray<FVector> VertexDirections;
+  int32 NextProjectedVertexIndex = 0;
+};
 
 /**
  * UPolyhedronComponent
@@ -21,4 +76,50 @@ public:
 
 public: // ProceduralMesh Generation
   void SetPolyhedronMesh(const FPolyhedronMesh& PolyhedronMesh, bool bEnableCollision = false, EPolyhedronUVGeneration UVGeneration = EPolyhedronUVGeneration::Spherical);
+  void SetPolyhedronSections(const TArray<FPolyhedronSection>& Sections, bool bEnableCollision = false);
+  // Replaces a single mesh section, ignoring the material index of the section; see FPolyhedronStreamer.
+  void SetPolyhedronTileSection(int32 SectionIndex, const FPolyhedronSection& Section, bool bEnableCollision = false);
+
+public: // ProceduralMesh Updates, which keep the triangles of the current mesh sections
+  void RescalePolyhedronMesh(double ScaleFactor);
+  // Returns false when the polyhedron no longer matches the mesh sections, which then need a SetPolyhedronMesh().
+  bool UpdatePolyhedronUVs(const FPolyhedronMesh& PolyhedronMesh, EPolyhedronUVGeneration UVGeneration);
+  // Moves the vertices of a polyhedron with unchanged polygons; the texture coordinates are kept as-is.
+  // UVGeneration is the one that the mesh sections were built with: it decides which section each polygon went to, and
+  // the tangents that follow the new normals.
+  bool UpdatePolyhedronVertices(const FPolyhedronMesh& PolyhedronMesh, EPolyhedronUVGeneration UVGeneration = EPolyhedronUVGeneration::None);
+
+public: // Terrain, with one mesh section per chunk
+  // Updates the terrain, then replaces every mesh section. The section of each chunk takes Materials[MaterialIndex] for the
+  // material index of its cells, or the material of the first section when it is out of Materials.
+  void SetPolyhedronTerrain(FPolyhedronTerrain& Terrain, bool bEnableCollision = false, TArrayView<UMaterialInterface* const> Materials = TArrayView<UMaterialInterface* const>());
+  // Updates the terrain, then only moves the vertices of the mesh sections of its dirty chunks.
+  void UpdatePolyhedronTerrain(FPolyhedronTerrain& Terrain);
+
+public: // Polygon States, to recolor the polygons without touching the mesh sections
+  // Stores the texel of its polygon in the second texture coordinates of each vertex, as integers: the materials sample
+  // the polygon state texture at (UV1 + 0.5) / TextureSize, with nearest filtering. Applies to the next mesh sections.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron") bool bEncodePolygonIndices = false;
+  // The polygon state texture holds the states of this many polygons per row.
+  static constexpr int32 PolygonStateTextureWidth = 1024;
+  // The mesh keeps its texture coordinates in half floats, which hold the integers up to 2048 exactly: past this many
+  // polygons, the rows would round to their neighbors, and the polygon indices are not encoded.
+  static constexpr int32 MaxEncodedPolygonCount = PolygonStateTextureWidth * 2048;
+  // The states of the polygons past the count are dropped, the new ones are zero.
+  void SetPolygonStateCount(int32 PolygonCount);
+  UFUNCTION(BlueprintCallable, Category="Polyhedron") void SetPolygonState(int32 PolygonIndex, FColor State);
+  void SetPolygonStates(TArrayView<const FColor> States);
+  FColor GetPolygonState(int32 PolygonIndex) const { return PolygonStates.IsValidIndex(PolygonIndex) ? PolygonStates[PolygonIndex] : FColor(ForceInitToZero); }
+  // Uploads the rows of states changed since the last call, creating the texture when the row count changes.
+  UFUNCTION(BlueprintCallable, Category="Polyhedron") UTexture2D* UpdatePolygonStateTexture();
+  // Sets the polygon state texture on a texture parameter of every material of the component, through dynamic material
+  // instances; call it once the materials are set. The texture is set again whenever it is created anew.
+  UFUNCTION(BlueprintCallable, Category="Polyhedron") void BindPolygonStateTexture(FName ParameterName = TEXT("PolygonStates"));
+private:
+  UPROPERTY(Transient) TObjectPtr<UTexture2D> PolygonStateTexture;
+  FName PolygonStateParameterName;
+  TArray<FColor> PolygonStates;
+  // The rows of the texture to upload, [Begin, End).
+  int32 DirtyPolygonStateRowBegin = MAX_int32;
+  int32 DirtyPolygonStateRowEnd = 0;
 };
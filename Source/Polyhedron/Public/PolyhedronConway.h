@@ -7,9 +7,30 @@
 #include "CoreMinimal.h"
 #include "Polyhedron.h"
 #include "PolyhedronComponent.h"
+#include "PolyhedronOperations.h"
+#include "PolyhedronParametricMesh.h"
+#if WITH_EDITOR
+#include "Containers/Ticker.h"
+#endif
 #include "PolyhedronConway.generated.h"
 
 class APolyhedronConway;
+class FPolyhedronGenerationJob;
+class FPolyhedronStreamer;
+
+/**
+ * The derived data of a APolyhedronConway that no longer matches its properties.
+ * Only a Topology change reruns the Conway operations; the others update the existing mesh sections.
+ */
+enum class EPolyhedronDirtyFlags : uint8 {
+  None = 0,
+  Topology = 1 << 0,
+  Scale = 1 << 1,
+  UVs = 1 << 2,
+  Material = 1 << 3,
+  Parameters = 1 << 4,
+};
+ENUM_CLASS_FLAGS(EPolyhedronDirtyFlags);
 
 /**
  * This Actor displays a polyhedron determined by a Conway Polyhedron Notation string.
@@ -23,27 +44,111 @@ public:
 
 public: // Event-Handlers
 	void BeginPlay() override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	void PostLoad() override;
+	void PostRegisterAllComponents() override;
 #if WITH_EDITOR
 	void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
 public: // Polyhedron Definition
 	const FPolyhedronMesh& GetPolyhedron() const { return Polyhedron; }
+	// These setters only update the derived data that their property affects.
+	UFUNCTION(BlueprintCallable, Category="Polyhedron") void SetConwayPolyhedronNotation(const FString& InConwayPolyhedronNotation);
+	UFUNCTION(BlueprintCallable, Category="Polyhedron") void SetScale(float InScale);
+	UFUNCTION(BlueprintCallable, Category="Polyhedron") void SetMaterial(UMaterialInterface* InMaterial);
+	UFUNCTION(BlueprintCallable, Category="Polyhedron") void SetUVGeneration(EPolyhedronUVGeneration InUVGeneration);
+	// Cheap enough to be called every frame: the topology is built once, then only the vertices move.
+	UFUNCTION(BlueprintCallable, Category="Polyhedron") void SetOperationParameters(const FPolyhedronOperationParameters& InOperationParameters);
 protected: 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Recreate)) FString ConwayPolyhedronNotation = TEXT("I");
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Recreate)) float Scale = 100.0;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Rescale)) float Scale = 100.0;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Recreate)) bool bEnableCollision = true;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (AttachMaterial)) TObjectPtr<UMaterialInterface> Material;
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Recreate)) EPolyhedronUVGeneration UVGeneration = EPolyhedronUVGeneration::Spherical;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (RegenerateUVs)) EPolyhedronUVGeneration UVGeneration = EPolyhedronUVGeneration::Spherical;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Reshape)) FPolyhedronOperationParameters OperationParameters;
+	// Replay the OperationParameters in floats: half the memory traffic per frame, but the vertices move by about 1e-5 of the Scale, which shows on large polyhedra.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Reshape)) bool bSinglePrecisionReshape = false;
+	// Run the last operations on one fundamental domain of the seed's rotations only, then replicate it. Pays off on long notations.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Recreate)) bool bUseSymmetry = false;
+	// Flatten the polygons and pull the edges tangent to a sphere once the notation is applied, as the K notation symbol does.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron", meta = (Recreate)) bool bCanonicalize = false;
+	// The notation actually generated, with the options that map to notation symbols.
+	FString GetGenerationNotation() const;
 private:
 	FPolyhedronMesh Polyhedron;
+	bool bPolyhedronGenerated = false;
+	// The Scale and UVGeneration that the current mesh sections were built with.
+	float GeneratedScale = 0.0;
+	EPolyhedronUVGeneration GeneratedUVGeneration = EPolyhedronUVGeneration::None;
+	// Built on the first parameter change, to re-evaluate the vertices of the current notation.
+	TUniquePtr<FPolyhedronParametricMesh> ParametricMesh;
+
+public: // Lazy Generation
+	bool IsGenerationDeferred() const;
+	bool IsPolyhedronGenerated() const { return bPolyhedronGenerated; }
+	bool ShouldReleaseWhenFar() const { return bReleaseWhenFar; }
+	float GetGenerationDistance() const { return GenerationDistance; }
+	float GetReleaseDistance() const { return FMath::Max(ReleaseDistance, GenerationDistance); }
+	double GetBoundingRadius() const { return Scale * GetActorScale3D().GetAbsMax(); }
+	TUniquePtr<FPolyhedronGenerationJob> CreateGenerationJob() const;
+	void ApplyGenerationJob(FPolyhedronGenerationJob& Job);
+	void ReleasePolyhedron();
+protected:
+	// Wait for a viewer to come within GenerationDistance of the polyhedron before generating it in game worlds.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron|Lazy Generation") bool bDeferGeneration = false;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron|Lazy Generation", meta = (EditCondition = "bDeferGeneration", ClampMin = "0.0")) float GenerationDistance = 10000.0;
+	// Free the polyhedron mesh again once every viewer is further than ReleaseDistance.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron|Lazy Generation", meta = (EditCondition = "bDeferGeneration")) bool bReleaseWhenFar = false;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron|Lazy Generation", meta = (EditCondition = "bDeferGeneration && bReleaseWhenFar", ClampMin = "0.0")) float ReleaseDistance = 20000.0;
+
+public: // Streaming
+	bool IsStreaming() const { return bStreamSurface; }
+	// Refines the tiles around the viewers, given in world space; called every frame by the UPolyhedronGenerationSubsystem.
+	void UpdateStreaming(TArrayView<const FVector> WorldViewLocations);
+protected:
+	// Split the polyhedron into tiles, refined to the full notation only around the viewers, for polyhedra too large to
+	// generate at once. Outside of game worlds, only the base level of the tiles is shown.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron|Streaming", meta = (Recreate)) bool bStreamSurface = false;
+	// The notation is applied on the whole polyhedron until it has this many polygons, which become the tiles.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron|Streaming", meta = (Recreate, EditCondition = "bStreamSurface", ClampMin = "1")) int32 StreamingTileCount = 500;
+	// The tiles within this distance of a viewer get the full notation; each doubling of the distance drops one operation.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron|Streaming", meta = (EditCondition = "bStreamSurface", ClampMin = "0.0")) float StreamingDetailDistance = 1000.0;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron|Streaming", meta = (EditCondition = "bStreamSurface", ClampMin = "1")) int32 StreamingMemoryBudgetMB = 256;
+	void StartStreaming();
+	void StopStreaming();
+private:
+	TSharedPtr<FPolyhedronStreamer, ESPMode::ThreadSafe> Streamer;
+	int32 StreamingSerial = 0;
 
 protected: // Polyhedron Component
+	// Brings the stale derived data up to date, falling back to a full generation whenever an update is not possible.
+	void UpdatePolyhedron(EPolyhedronDirtyFlags DirtyFlags);
 	void GeneratePolyhedron();
+	void RescalePolyhedron();
+	void RegeneratePolyhedronUVs();
+	void ReshapePolyhedron();
 	void AttachMaterial();
+
+#if WITH_EDITOR
+protected: // Editor Preview
+	// Shows a cheap prefix of the notation right away, then refines it in the background once the edits settle down.
+	void GeneratePreviewPolyhedron();
+	void StartRefinementJob(int32 RefinementEditSerial);
+	void CancelRefinement();
+	bool IsRefinementPending() const { return RefinementTickerHandle.IsValid() || RefinementJob.IsValid(); }
+private:
+	int32 EditSerial = 0;
+	FTSTicker::FDelegateHandle RefinementTickerHandle;
+	TSharedPtr<FPolyhedronGenerationJob, ESPMode::ThreadSafe> RefinementJob;
+#endif
 protected:
 	UPROPERTY(Transient, VisibleAnywhere, BlueprintReadOnly, Category = "Polyhedron") TObjectPtr<UPolyhedronComponent> PolyhedronComponent;
 	UPROPERTY(Transient, VisibleAnywhere, BlueprintReadOnly, Category = "Polyhedron") int32 VertexCount = 0;
 	UPROPERTY(Transient, VisibleAnywhere, BlueprintReadOnly, Category = "Polyhedron") int32 PolygonCount = 0;
+	// The size of the full notation, predicted by each edit before the preview; the preview may have fewer polygons.
+	UPROPERTY(Transient, VisibleAnywhere, BlueprintReadOnly, Category = "Polyhedron") int64 PredictedVertexCount = 0;
+	UPROPERTY(Transient, VisibleAnywhere, BlueprintReadOnly, Category = "Polyhedron") int64 PredictedPolygonCount = 0;
+	// The most memory that generating the full notation holds at once, see Polyhedron.Generation.MemoryBudgetMB.
+	UPROPERTY(Transient, VisibleAnywhere, BlueprintReadOnly, Category = "Polyhedron") float PredictedMemoryMB = 0.0;
 };
@@ -0,0 +1,68 @@
+// Copyright 2024 TabbyCoder
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Polyhedron.h"
+#include "PolyhedronComponent.h"
+#include "PolyhedronTools.h"
+#include <atomic>
+
+enum class EPolyhedronGenerationJobState : uint8 {
+  Running,
+  Completed,
+  Cancelled,
+  Failed
+};
+
+/**
+ * Generates a polyhedron from its Conway Polyhedron Notation in resumable time slices.
+ * Each call to Run() applies operations, then builds mesh sections by ranges of polygons, until its time budget runs out.
+ * A job can run on any thread, but only one thread at a time; Cancel() may be called from any thread.
+ */
+class POLYHEDRON_API FPolyhedronGenerationJob {
+public:
+  FPolyhedronGenerationJob(const FString& ConwayPolyhedronNotation, float Scale = 100.0, EPolyhedronUVGeneration UVGeneration = EPolyhedronUVGeneration::Spherical, const FPolyhedronOperationParameters& OperationParameters = FPolyhedronOperationParameters(), bool bEncodePolygonIndices = false);
+  FPolyhedronGenerationJob(const FPolyhedronGenerationJob&) = delete;
+  FPolyhedronGenerationJob& operator=(const FPolyhedronGenerationJob&) = delete;
+
+public: // Execution
+  // Resumes the generation; returns true once the job is finished, whether completed, cancelled or failed.
+  bool Run(double TimeBudgetSeconds = TNumericLimits<double>::Max());
+  void Cancel() { bCancelRequested = true; }
+
+public: // Status
+  EPolyhedronGenerationJobState GetState() const { return State; }
+  bool IsFinished() const { return State != EPolyhedronGenerationJobState::Running; }
+  bool IsCancelled() const { return bCancelRequested || State == EPolyhedronGenerationJobState::Cancelled; }
+  float GetProgress() const { return Progress; }
+  const FString& GetConwayPolyhedronNotation() const { return ConwayPolyhedronNotation; }
+  float GetScale() const { return Scale; }
+  EPolyhedronUVGeneration GetUVGeneration() const { return UVGeneration; }
+  const FPolyhedronOperationParameters& GetOperationParameters() const { return OperationParameters; }
+
+public: // Results, valid once completed
+  const FPolyhedronMesh& GetPolyhedron() const { return Polyhedron; }
+  FPolyhedronMesh& GetPolyhedron() { return Polyhedron; }
+  TArray<FPolyhedronSection>& GetSections();
+
+private:
+  void UpdateProgress();
+
+private:
+  FString ConwayPolyhedronNotation;
+  float Scale;
+  EPolyhedronUVGeneration UVGeneration;
+  FPolyhedronOperationParameters OperationParameters;
+  bool bEncodePolygonIndices;
+
+  TArray<FPolyhedronNotationStep> Steps;
+  int32 NextStepIndex = INDEX_NONE; // INDEX_NONE until the notation is parsed.
+  bool bScaled = false;
+  FPolyhedronMesh Polyhedron;
+  TUniquePtr<FPolyhedronSectionBuilder> SectionBuilder;
+
+  std::atomic<bool> bCancelRequested = false;
+  std::atomic<EPolyhedronGenerationJobState> State = EPolyhedronGenerationJobState::Running;
+  std::atomic<float> Progress = 0.0f;
+};
@@ -0,0 +1,56 @@
+// Copyright 2024 TabbyCoder
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PolyhedronGenerationJob.h"
+#include "PolyhedronGenerationSubsystem.generated.h"
+
+class APolyhedronConway;
+
+/**
+ * Generates the deferred polyhedra of a game world, closest-first, within a per-frame time budget.
+ * Polyhedra only register here when their bDeferGeneration property is enabled.
+ * Each admitted polyhedron gets a resumable generation job; the jobs share the frame budget fairly.
+ * The streamed polyhedra register separately, and get the viewer locations every frame, see APolyhedronConway::UpdateStreaming().
+ */
+UCLASS()
+class POLYHEDRON_API UPolyhedronGenerationSubsystem : public UTickableWorldSubsystem {
+  GENERATED_BODY()
+
+public: // UTickableWorldSubsystem
+  void Tick(float DeltaTime) override;
+  TStatId GetStatId() const override;
+protected:
+  bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public: // Registration
+  void RegisterPolyhedron(APolyhedronConway* Polyhedron);
+  void UnregisterPolyhedron(APolyhedronConway* Polyhedron);
+  int32 GetRegisteredPolyhedronCount() const { return Polyhedra.Num(); }
+  void RegisterStreamingPolyhedron(APolyhedronConway* Polyhedron);
+  void UnregisterStreamingPolyhedron(APolyhedronConway* Polyhedron);
+
+private:
+  struct FJob {
+    TWeakObjectPtr<APolyhedronConway> Polyhedron;
+    TUniquePtr<FPolyhedronGenerationJob> Job;
+  };
+  void AdmitJobs(const TArray<APolyhedronConway*>& Candidates);
+  void RunJobs();
+
+private:
+  struct FViewPoint {
+    FVector Location;
+    FVector Direction;
+    double HalfFOVRadians;
+  };
+  void GatherViewPoints(TArray<FViewPoint>& OutViewPoints) const;
+
+private:
+  TArray<TWeakObjectPtr<APolyhedronConway>> Polyhedra;
+  TArray<TWeakObjectPtr<APolyhedronConway>> StreamingPolyhedra;
+  TArray<FJob> Jobs;
+  int32 NextJobIndex = 0;
+};
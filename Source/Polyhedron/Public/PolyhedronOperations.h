@@ -8,6 +8,192 @@
 #include "Polyhedron.h"
 #include "PolyhedronOperations.generated.h"
 
+enum class EPolyhedronOperationParameter : uint8 {
+  None,
+  KisApexOffset,
+  ChamferOffset
+};
+
+/**
+ * The continuous parameters of the Conway operations. They move vertices around, but never change the topology.
+ */
+USTRUCT(BlueprintType)
+struct POLYHEDRON_API FPolyhedronOperationParameters {
+  GENERATED_BODY()
+
+public:
+  // Height of the Kis pyramids, along the normal of their base polygon. Needle, Zip, Truncate, Meta and Bevel are built on Kis.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron") double KisApexOffset = 0.1;
+  // Distance that Chamfer pushes the faces apart.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Polyhedron") double ChamferOffset = 0.1;
+
+public:
+  bool operator==(const FPolyhedronOperationParameters& Other) const { return KisApexOffset == Other.KisApexOffset && ChamferOffset == Other.ChamferOffset; }
+  bool operator!=(const FPolyhedronOperationParameters& Other) const { return !(*this == Other); }
+  // The value that scales the factors of a vertex recipe; 1 without a Parameter.
+  double GetValue(EPolyhedronOperationParameter Parameter) const;
+};
+
+/**
+ * How one output vertex of an operation derives from the vertices and polygons of its input:
+ *   Position = Sum(Weight * InputVertex), then += Parameter * RadialFactor * Position, then += Parameter * NormalFactor * InputPolygonNormal.
+ * Without a Parameter, the factors apply as-is.
+ */
+struct POLYHEDRON_API FPolyhedronVertexRecipe {
+  TArray<TPair<int32, double>, TInlineAllocator<4>> Terms;
+  EPolyhedronOperationParameter Parameter = EPolyhedronOperationParameter::None;
+  double RadialFactor = 0.0;
+  int32 NormalPolygonIndex = INDEX_NONE;
+  double NormalFactor = 0.0;
+  bool bNormalize = false;
+  // Projects the position onto the sphere whose radius is the weighted average of the term radii.
+  bool bKeepTermRadius = false;
+};
+
+/**
+ * The elements of the input polyhedron that a local operator attaches its vertices and faces to.
+ * Every element is reached through one of its half-edges: any half-edge out of a Vertex, the half-edge of an Edge
+ * that starts at its lowest vertex, any half-edge of a Polygon, or the HalfEdge itself.
+ */
+enum class EPolyhedronLocalElement : uint8 {
+  Vertex,
+  Edge,
+  Polygon,
+  HalfEdge
+};
+
+/**
+ * The element of the input that one output vertex or polygon of an operation comes from.
+ * Vertices and polygons are indexed as in the input; an Edge is indexed by its half-edge that starts at its lowest vertex,
+ * and the half-edges are numbered polygon by polygon, in the order of their vertices.
+ * PolygonIndex is the input polygon that the element belongs to: the polygon itself, the polygon of the half-edge,
+ * or the first polygon, by index, around a vertex.
+ */
+struct POLYHEDRON_API FPolyhedronProvenance {
+  EPolyhedronLocalElement Element = EPolyhedronLocalElement::Polygon;
+  int32 Index = INDEX_NONE;
+  int32 PolygonIndex = INDEX_NONE;
+};
+
+/**
+ * The vertex recipes of one operation, flattened in output vertex order.
+ */
+struct POLYHEDRON_API FPolyhedronOperationStage {
+  struct FVertex {
+    int32 TermOffset;
+    int32 TermCount;
+    int32 NormalPolygonIndex;
+    EPolyhedronOperationParameter Parameter;
+    bool bNormalize;
+    bool bKeepTermRadius;
+    double RadialFactor;
+    double NormalFactor;
+  };
+  void AddVertex(const FPolyhedronVertexRecipe& Recipe);
+
+  int32 InputVertexCount = 0;
+  TArray<FVertex> Vertices;
+  TArray<TPair<int32, double>> Terms;
+  // Only kept by the operations whose recipes refer to input polygon normals.
+  TArray<FPolyhedronPolygon> InputPolygons;
+  // Only recorded when the recorder asks for them, in output vertex and output polygon order.
+  TArray<FPolyhedronProvenance> VertexSources;
+  TArray<FPolyhedronProvenance> PolygonSources;
+};
+
+/**
+ * Records the vertex recipes of a sequence of operations, so that their positions can be re-evaluated without rebuilding the topology.
+ * The operations record into it when one is given to them.
+ */
+struct POLYHEDRON_API FPolyhedronOperationRecorder {
+  FPolyhedronOperationStage& AddStage(const FPolyhedronMesh& Input, bool bKeepInputPolygons);
+
+  // Chains the sources of the stages, from the last output back to the input of the FirstStageIndex-th stage, in a single
+  // pass over their elements. An element that comes from an edge or a half-edge of an intermediate stage is traced back
+  // through its polygon. Empty unless the stages were recorded with bRecordProvenance.
+  TArray<FPolyhedronProvenance> ComposeVertexSources(int32 FirstStageIndex = 0) const;
+  TArray<FPolyhedronProvenance> ComposePolygonSources(int32 FirstStageIndex = 0) const;
+
+  TArray<FPolyhedronOperationStage> Stages;
+  // Also record where each output vertex and polygon comes from, see FPolyhedronProvenance.
+  bool bRecordProvenance = false;
+};
+
+/**
+ * The steps from one half-edge to its neighbors; Next and Previous stay within its polygon.
+ */
+enum class EPolyhedronLocalWalk : uint8 {
+  Self,
+  Next,
+  Previous,
+  Twin
+};
+
+/**
+ * One output vertex per input element of its kind, placed from the half-edge of the element:
+ *   Position = FromWeight * From + ToWeight * To + CenterWeight * PolygonCenter, then moved as a FPolyhedronVertexRecipe.
+ * A Vertex only weighs From, an Edge weighs From and To equally, and a Polygon only weighs its center.
+ * Only the Polygon and HalfEdge vertices can follow the normal of their polygon.
+ */
+struct POLYHEDRON_API FPolyhedronLocalVertex {
+  EPolyhedronLocalElement Element = EPolyhedronLocalElement::Vertex;
+  double FromWeight = 0.0;
+  double ToWeight = 0.0;
+  double CenterWeight = 0.0;
+  EPolyhedronOperationParameter Parameter = EPolyhedronOperationParameter::None;
+  double RadialFactor = 0.0;
+  double NormalFactor = 0.0;
+  bool bNormalize = false;
+};
+
+/**
+ * A corner of an output face: the Index-th FPolyhedronLocalVertex of the Element kind, on the half-edge reached by Walk.
+ */
+struct POLYHEDRON_API FPolyhedronLocalCorner {
+  EPolyhedronLocalWalk Walk = EPolyhedronLocalWalk::Self;
+  EPolyhedronLocalElement Element = EPolyhedronLocalElement::Vertex;
+  int32 Index = 0;
+};
+
+/**
+ * One output face per input element of its kind. The Corners are repeated for each half-edge of the element, in order:
+ * around a Vertex (each next half-edge is the Twin of the Previous one), along both halves of an Edge (the second
+ * half is the Twin of the first), around a Polygon, or once for a HalfEdge.
+ */
+struct POLYHEDRON_API FPolyhedronLocalFace {
+  EPolyhedronLocalElement Element = EPolyhedronLocalElement::Polygon;
+  TArray<FPolyhedronLocalCorner> Corners;
+  bool bReverse = false;
+};
+
+/**
+ * A local Conway operator, as a table: the pattern that it repeats on every element of the input polyhedron.
+ * See FPolyhedronOperations::ApplyLocalOperator().
+ */
+struct POLYHEDRON_API FPolyhedronLocalOperator {
+  TArray<FPolyhedronLocalVertex> Vertices;
+  TArray<FPolyhedronLocalFace> Faces;
+};
+
+/**
+ * The size of a polyhedron without its geometry: its element counts, and how many of its polygons have each number of
+ * sides and how many of its vertices have each degree. That is all the operations need to predict the size of their output.
+ */
+struct POLYHEDRON_API FPolyhedronMeshSize {
+  int64 VertexCount = 0;
+  int64 EdgeCount = 0;
+  int64 PolygonCount = 0;
+  // Side count -> polygon count, and degree -> vertex count.
+  TMap<int32, int64> PolygonSideCounts;
+  TMap<int32, int64> VertexDegreeCounts;
+  // The most memory held at once while the operations built this polyhedron, including their work buffers; only predicted.
+  int64 PeakMemorySize = 0;
+
+  static FPolyhedronMeshSize Measure(const FPolyhedronMesh& Polyhedron);
+  // The memory of a FPolyhedronMesh of this size: its vertices, its polygons and their vertex indices.
+  int64 GetMemorySize() const;
+};
+
 /*
 * Regroups the Polyhedron Operations functions.
 */
@@ -15,29 +201,75 @@ USTRUCT()
 struct POLYHEDRON_API FPolyhedronOperations {
   GENERATED_BODY()
 
+public: // Local Operators
+  // Applies any operator table in a single pass over the half-edges of the input; most operations below are such tables.
+  static FPolyhedronMesh ApplyLocalOperator(const FPolyhedronMesh& Input, const FPolyhedronLocalOperator& Operator, const FPolyhedronOperationParameters& Parameters = FPolyhedronOperationParameters(), FPolyhedronOperationRecorder* Recorder = nullptr);
+
+public: // Size Prediction
+  // The exact size of the output of ApplyLocalOperator(), from the size of its input alone.
+  static FPolyhedronMeshSize PredictLocalOperator(const FPolyhedronMeshSize& Input, const FPolyhedronLocalOperator& Operator);
+  // The size of the output of Subdivide() on every polygon. The counts are exact; the degrees of the input vertices are
+  // only exact when every vertex has the same polygons around it, as on the seeds and most of their operations.
+  static FPolyhedronMeshSize PredictSubdivide(const FPolyhedronMeshSize& Input, int32 Frequency = 2);
+  // The size of the output of the operation behind a notation symbol, such as 't' or 'u', with the argument of its symbol.
+  static FPolyhedronMeshSize PredictOperation(const FPolyhedronMeshSize& Input, TCHAR Symbol, int32 Argument = 0);
+
+public: // Region Masks
+  // A polygon mask holds one bit per polygon of the input; the masked operations below only refine the polygons set in it,
+  // and close the mesh around them so that it stays manifold. Build one again after each operation: the polygons are renumbered.
+  static TBitArray<> MakePolygonMask(const FPolyhedronMesh& Input, TFunctionRef<bool(int32 PolygonIndex)> Predicate);
+
 public: // Edge Factor 1
-  static FPolyhedronMesh Dual(const FPolyhedronMesh& Input);
+  static FPolyhedronMesh Dual(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
+  // The point reflection through the origin, which turns the chiral polyhedra into their mirror image.
+  static FPolyhedronMesh Reflect(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
 
 public: // Edge Factor 2
-  static FPolyhedronMesh Ambo(const FPolyhedronMesh& Input);
-  static FPolyhedronMesh Join(const FPolyhedronMesh& Input);
+  static FPolyhedronMesh Ambo(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
+  static FPolyhedronMesh Join(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
 
 public: // Edge Factor 3
-  static FPolyhedronMesh Kis(const FPolyhedronMesh& Input, int32 SideFilter = 0, double ApexOffset = 0.1);
-  static FPolyhedronMesh Needle(const FPolyhedronMesh& Input);
-  static FPolyhedronMesh Zip(const FPolyhedronMesh& Input);
-  static FPolyhedronMesh Truncate(const FPolyhedronMesh& Input);
+  static FPolyhedronMesh Kis(const FPolyhedronMesh& Input, int32 SideFilter = 0, double ApexOffset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  // Only raises a pyramid on the polygons set in PolygonMask, the others are kept as they are.
+  static FPolyhedronMesh Kis(const FPolyhedronMesh& Input, const TBitArray<>& PolygonMask, double ApexOffset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  static FPolyhedronMesh Needle(const FPolyhedronMesh& Input, double ApexOffset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  static FPolyhedronMesh Zip(const FPolyhedronMesh& Input, double ApexOffset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  static FPolyhedronMesh Truncate(const FPolyhedronMesh& Input, double ApexOffset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  // Cuts every corner of the polygons set in PolygonMask a third of the way along its edges; the neighbors that share
+  // these corners lose them too. The other vertices do not move.
+  static FPolyhedronMesh Truncate(const FPolyhedronMesh& Input, const TBitArray<>& PolygonMask, FPolyhedronOperationRecorder* Recorder = nullptr);
 
 public: // Edge Factor 4
-  static FPolyhedronMesh Chamfer(const FPolyhedronMesh& Input, double Offset = 0.1);
-  static FPolyhedronMesh Expand(const FPolyhedronMesh& Input);
-  static FPolyhedronMesh Ortho(const FPolyhedronMesh& Input);
+  static FPolyhedronMesh Chamfer(const FPolyhedronMesh& Input, double Offset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  // Only pushes the polygons set in PolygonMask apart: a hexagon replaces the edges between two of them, and a
+  // quadrilateral the edges towards the others. Same as Chamfer() when every polygon is set.
+  static FPolyhedronMesh Chamfer(const FPolyhedronMesh& Input, const TBitArray<>& PolygonMask, double Offset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  static FPolyhedronMesh Expand(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
+  static FPolyhedronMesh Ortho(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
 
 public: // Edge Factor 5
-  static FPolyhedronMesh Gyro(const FPolyhedronMesh& Input);
-  static FPolyhedronMesh Snub(const FPolyhedronMesh& Input);
+  static FPolyhedronMesh Gyro(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
+  static FPolyhedronMesh Snub(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
+  // Insets each polygon by a third, and joins it to its original edges with quadrilaterals.
+  static FPolyhedronMesh Loft(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
+  // Turns each polygon into a smaller copy, rotated, and surrounded by quadrilaterals.
+  static FPolyhedronMesh Propeller(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
 
 public: // Edge Factor 6
-  static FPolyhedronMesh Meta(const FPolyhedronMesh& Input);
-  static FPolyhedronMesh Bevel(const FPolyhedronMesh& Input);
+  static FPolyhedronMesh Meta(const FPolyhedronMesh& Input, double ApexOffset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  static FPolyhedronMesh Bevel(const FPolyhedronMesh& Input, double ApexOffset = 0.1, FPolyhedronOperationRecorder* Recorder = nullptr);
+  // Splits each polygon into a central copy, surrounded by one pentagon per vertex.
+  static FPolyhedronMesh Quinto(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
+
+public: // Edge Factor 7
+  // Splits each polygon into a central rotated copy, surrounded by one hexagon per edge.
+  static FPolyhedronMesh Whirl(const FPolyhedronMesh& Input, FPolyhedronOperationRecorder* Recorder = nullptr);
+
+public: // Edge Factor N^2
+  // Geodesic subdivision of class I: splits each triangle into Frequency^2 triangles, projected onto the sphere of their corners.
+  // Other polygons are split as a fan of triangles around their center first.
+  static FPolyhedronMesh Subdivide(const FPolyhedronMesh& Input, int32 Frequency = 2, FPolyhedronOperationRecorder* Recorder = nullptr);
+  // Only subdivides the polygons set in PolygonMask. Their neighbors become a fan of triangles around their center,
+  // through the new points on the edges they share.
+  static FPolyhedronMesh Subdivide(const FPolyhedronMesh& Input, const TBitArray<>& PolygonMask, int32 Frequency = 2, FPolyhedronOperationRecorder* Recorder = nullptr);
 };
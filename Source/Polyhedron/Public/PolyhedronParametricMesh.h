@@ -0,0 +1,46 @@
+// Copyright 2024 TabbyCoder
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Polyhedron.h"
+#include "PolyhedronOperations.h"
+
+/**
+ * A polyhedron whose topology is built once from its Conway Polyhedron Notation, and whose vertex positions
+ * can then be re-evaluated for new operation parameters. This is meant for animating the operation parameters:
+ * the re-evaluation replays the recorded vertex recipes, in parallel, without running the operations again.
+ */
+class POLYHEDRON_API FPolyhedronParametricMesh {
+public:
+  // Applies the notation, recording how the vertices of each operation derive from its input. Returns false for an invalid notation, or one that canonicalizes.
+  bool Build(const FString& ConwayPolyhedronNotation, float Scale = 100.0, const FPolyhedronOperationParameters& Parameters = FPolyhedronOperationParameters());
+  // Re-evaluates the vertex positions of the polyhedron; its polygons never change.
+  // With bSinglePrecision, the vertices are replayed in floats, which halves the memory traffic of the replay; the
+  // reductions (the normals, the radii and the scale) stay in doubles. The vertices then move by up to about 1e-5 of the
+  // Scale. Build() and the operations themselves always run in doubles, so this does not lower their peak memory.
+  void Evaluate(const FPolyhedronOperationParameters& Parameters, float Scale = 100.0, bool bSinglePrecision = false);
+
+public:
+  bool IsValid() const { return Polyhedron.Polygons.Num() > 0; }
+  const FString& GetConwayPolyhedronNotation() const { return ConwayPolyhedronNotation; }
+  const FPolyhedronMesh& GetPolyhedron() const { return Polyhedron; }
+
+private:
+  FString ConwayPolyhedronNotation;
+  TArray<FVector> SeedVertices;
+  FPolyhedronOperationRecorder Recorder;
+  FPolyhedronMesh Polyhedron;
+
+  // Work buffers, kept around between evaluations.
+  template <typename FReal>
+  struct TWorkBuffers {
+    TArray<UE::Math::TVector<FReal>> InputVertices, OutputVertices;
+    TArray<UE::Math::TVector<FReal>> InputPolygonNormals;
+  };
+  TWorkBuffers<double> DoubleWorkBuffers;
+  TWorkBuffers<float> FloatWorkBuffers;
+
+  template <typename FReal>
+  void Evaluate(const FPolyhedronOperationParameters& Parameters, float Scale, TWorkBuffers<FReal>& WorkBuffers);
+};
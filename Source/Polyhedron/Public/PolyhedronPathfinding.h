@@ -0,0 +1,103 @@
+// Copyright 2024 TabbyCoder
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Polyhedron.h"
+
+/**
+ * One path search, from one polygon to another.
+ */
+struct POLYHEDRON_API FPolyhedronPathQuery {
+  int32 StartPolygonIndex = INDEX_NONE;
+  int32 GoalPolygonIndex = INDEX_NONE;
+};
+
+/**
+ * The polygons crossed by a path, from its start to its goal; empty when the goal cannot be reached.
+ */
+struct POLYHEDRON_API FPolyhedronPath {
+  TArray<int32> PolygonIndices;
+  float Cost = 0.0f;
+
+  bool IsValid() const { return PolygonIndices.Num() > 0; }
+};
+
+/**
+ * How FPolyhedronPathfinder::Partition() grows its regions.
+ */
+struct POLYHEDRON_API FPolyhedronPartitionSettings {
+  // Grow by steps from polygon to polygon, instead of by the distance between their centers.
+  bool bCountSteps = false;
+  // Scales the steps as in FPolyhedronPathfinder; a negative cost blocks the polygon. Must outlive the partition.
+  TArrayView<const float> PolygonCosts;
+  // The polygons further than this from every seed belong to no region.
+  float MaxDistance = TNumericLimits<float>::Max();
+};
+
+/**
+ * The regions grown from seed polygons: each polygon belongs to the region of its closest seed, where the regions are
+ * numbered as their seeds. Two seeds at the same distance go to the lowest region.
+ */
+struct POLYHEDRON_API FPolyhedronPartition {
+  // INDEX_NONE for the polygons that no region reached.
+  TArray<int32> RegionIndices;
+  // TNumericLimits<float>::Max() for the polygons that no region reached.
+  TArray<float> Distances;
+
+  // Paints each region with a material: RegionMaterialIndices[RegionIndex], or the region index itself without them.
+  // The polygons that no region reached keep their material.
+  void AssignMaterialIndices(FPolyhedronMesh& Polyhedron, TArrayView<const int32> RegionMaterialIndices = TArrayView<const int32>()) const;
+};
+
+/**
+ * Searches the paths between the polygons of a FPolyhedronPolygonGraph, walking from polygon center to polygon center.
+ * The scratch buffers are allocated once, for the whole graph, and reused by every search: keep one pathfinder per
+ * thread. The graph and the polygon costs must outlive the pathfinder.
+ */
+class POLYHEDRON_API FPolyhedronPathfinder {
+public:
+  // Each step between two centers is walked half in each polygon, where the distance is scaled by the cost of the polygon.
+  // Without PolygonCosts, every cost is 1; a negative cost blocks the polygon.
+  FPolyhedronPathfinder(const FPolyhedronPolygonGraph& Graph, TArrayView<const float> PolygonCosts = TArrayView<const float>());
+
+public: // A*
+  // The cheapest path between two polygons; the straight line between their centers guides the search.
+  bool FindPath(int32 StartPolygonIndex, int32 GoalPolygonIndex, FPolyhedronPath& OutPath);
+  // Runs the queries over the worker threads, with one pathfinder per thread.
+  static TArray<FPolyhedronPath> FindPaths(const FPolyhedronPolygonGraph& Graph, TArrayView<const FPolyhedronPathQuery> Queries, TArrayView<const float> PolygonCosts = TArrayView<const float>());
+
+public: // Dijkstra
+  // The cost from the closest source to every polygon, up to MaxCost. The results stay readable until the next search.
+  void ComputeCosts(TArrayView<const int32> SourcePolygonIndices, float MaxCost = TNumericLimits<float>::Max());
+  // TNumericLimits<float>::Max() for the polygons that the last search did not reach.
+  float GetCost(int32 PolygonIndex) const;
+  // The path from the closest source of the last search to a polygon that it reached.
+  bool GetPath(int32 PolygonIndex, FPolyhedronPath& OutPath) const;
+
+public: // Partition
+  // Grows one region from each seed at once, over the worker threads: each round relaxes the polygons that improved in the
+  // previous round, until no polygon improves. The result does not depend on the thread timings.
+  static FPolyhedronPartition Partition(const FPolyhedronPolygonGraph& Graph, TArrayView<const int32> SeedPolygonIndices, const FPolyhedronPartitionSettings& Settings = FPolyhedronPartitionSettings());
+
+private:
+  struct FOpenPolygon {
+    float Priority;
+    float Cost;
+    int32 PolygonIndex;
+  };
+  void Search(TArrayView<const int32> SourcePolygonIndices, int32 GoalPolygonIndex, float MaxCost);
+  bool IsReached(int32 PolygonIndex) const { return Stamps[PolygonIndex] == Stamp; }
+
+  const FPolyhedronPolygonGraph& Graph;
+  TArrayView<const float> PolygonCosts;
+  // Scales the straight line to the goal, so that it never overestimates the cost left with costs below 1.
+  float HeuristicScale = 1.0f;
+
+  // A polygon is reached in the current search when its stamp matches; this saves clearing the buffers between searches.
+  TArray<uint32> Stamps;
+  uint32 Stamp = 0;
+  TArray<float> Costs;
+  TArray<int32> Parents;
+  TArray<FOpenPolygon> OpenPolygons;
+};
@@ -0,0 +1,71 @@
+// Copyright 2024 TabbyCoder
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Polyhedron.h"
+#include "PolyhedronOperations.h"
+#include "PolyhedronSeeds.h"
+#include "PolyhedronTools.h"
+
+/**
+ * The steps of a TPolyhedronPipeline: one per symbol of the Conway Polyhedron Notation, with its arguments as template
+ * parameters. Canonicalization is left out, since its time budget is only known at runtime.
+ */
+namespace PolyhedronPipeline {
+  // Seeds
+  template <int32 Sides> struct TAntiprism { static FString GetNotation() { return FString::Printf(TEXT("A%d"), Sides); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Antiprism(Sides); } };
+  struct FCube { static FString GetNotation() { return TEXT("C"); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Cube(); } };
+  struct FDodecahedron { static FString GetNotation() { return TEXT("D"); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Dodecahedron(); } };
+  template <int32 M, int32 N = 0> struct TGoldberg { static FString GetNotation() { return FString::Printf(TEXT("G%d,%d"), M, N); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Goldberg(M, N); } };
+  struct FIcosahedron { static FString GetNotation() { return TEXT("I"); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Icosahedron(); } };
+  struct FOctahedron { static FString GetNotation() { return TEXT("O"); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Octahedron(); } };
+  template <int32 Sides> struct TPrism { static FString GetNotation() { return FString::Printf(TEXT("P%d"), Sides); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Prism(Sides); } };
+  struct FTetrahedron { static FString GetNotation() { return TEXT("T"); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Tetrahedron(); } };
+  template <int32 Sides> struct TPyramid { static FString GetNotation() { return FString::Printf(TEXT("Y%d"), Sides); } static FPolyhedronMesh Apply() { return FPolyhedronSeeds::Pyramid(Sides); } };
+
+  // Operations, with the same parameters as FPolyhedronTools::ApplyConwayPolyhedronNotationStep().
+  struct FAmbo { static FString GetNotation() { return TEXT("a"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Ambo(Input); } };
+  struct FBevel { static FString GetNotation() { return TEXT("b"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Bevel(Input, Parameters.KisApexOffset); } };
+  struct FChamfer { static FString GetNotation() { return TEXT("c"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Chamfer(Input, Parameters.ChamferOffset); } };
+  struct FDual { static FString GetNotation() { return TEXT("d"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Dual(Input); } };
+  struct FExpand { static FString GetNotation() { return TEXT("e"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Expand(Input); } };
+  struct FGyro { static FString GetNotation() { return TEXT("g"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Gyro(Input); } };
+  struct FJoin { static FString GetNotation() { return TEXT("j"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Join(Input); } };
+  struct FKis { static FString GetNotation() { return TEXT("k"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Kis(Input, 0, Parameters.KisApexOffset); } };
+  struct FLoft { static FString GetNotation() { return TEXT("l"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Loft(Input); } };
+  struct FMeta { static FString GetNotation() { return TEXT("m"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Meta(Input, Parameters.KisApexOffset); } };
+  struct FNeedle { static FString GetNotation() { return TEXT("n"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Needle(Input, Parameters.KisApexOffset); } };
+  struct FOrtho { static FString GetNotation() { return TEXT("o"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Ortho(Input); } };
+  struct FPropeller { static FString GetNotation() { return TEXT("p"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Propeller(Input); } };
+  struct FQuinto { static FString GetNotation() { return TEXT("q"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Quinto(Input); } };
+  struct FReflect { static FString GetNotation() { return TEXT("r"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Reflect(Input); } };
+  struct FSnub { static FString GetNotation() { return TEXT("s"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Snub(Input); } };
+  struct FTruncate { static FString GetNotation() { return TEXT("t"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Truncate(Input, Parameters.KisApexOffset); } };
+  template <int32 Frequency = 2> struct TSubdivide { static FString GetNotation() { return FString::Printf(TEXT("u%d"), Frequency); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Subdivide(Input, Frequency); } };
+  struct FWhirl { static FString GetNotation() { return TEXT("w"); } static FPolyhedronMesh Apply(const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters) { return FPolyhedronOperations::Whirl(Input); } };
+}
+
+/**
+ * A Conway Polyhedron Notation fixed at compile time, for the polyhedra defined in code. The steps are listed in the order
+ * of the notation, the seed last: TPolyhedronPipeline<FTruncate, FKis, FTruncate, FIcosahedron> is tktI.
+ * The operations are called directly, without parsing the notation nor dispatching each of its symbols.
+ */
+template <typename... TSteps>
+struct TPolyhedronPipeline {
+  static_assert(sizeof...(TSteps) > 0, "A polyhedron pipeline needs a seed");
+
+  // Same as FPolyhedronTools::GenerateFromConwayPolyhedronNotation(GetNotation(), Scale, Parameters).
+  static FPolyhedronMesh Generate(float Scale = 100.0, const FPolyhedronOperationParameters& Parameters = FPolyhedronOperationParameters()) {
+    FPolyhedronMeshSize PredictedSize;
+    if (FPolyhedronTools::PredictConwayPolyhedronNotation(GetNotation(), PredictedSize) && !FPolyhedronTools::CheckMemoryBudget(PredictedSize)) return FPolyhedronMesh();
+    return FPolyhedronTools::ScaleToSphere(Apply<TSteps...>(Parameters), Scale);
+  }
+  static FString GetNotation() { return (TSteps::GetNotation() + ...); }
+
+private:
+  template <typename TSeed>
+  static FPolyhedronMesh Apply(const FPolyhedronOperationParameters& Parameters) { return TSeed::Apply(); }
+  template <typename TStep, typename TNextStep, typename... TRemainingSteps>
+  static FPolyhedronMesh Apply(const FPolyhedronOperationParameters& Parameters) { return TStep::Apply(Apply<TNextStep, TRemainingSteps...>(Parameters), Parameters); }
+};
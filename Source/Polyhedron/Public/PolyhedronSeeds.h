@@ -19,6 +19,8 @@ public: // Polyhedron Creation Functions
   static FPolyhedronMesh Antiprism(int32 Sides);
   static FPolyhedronMesh Cube();
   static FPolyhedronMesh Dodecahedron();
+  // Goldberg polyhedron GP(M, N): 12 pentagons and 10 * (M^2 + MN + N^2 - 1) hexagons, built directly from the icosahedron lattice.
+  static FPolyhedronMesh Goldberg(int32 M, int32 N);
   static FPolyhedronMesh Icosahedron();
   static FPolyhedronMesh Octahedron();
   static FPolyhedronMesh Prism(int32 Sides);
@@ -0,0 +1,82 @@
+// Copyright 2024 TabbyCoder
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Polyhedron.h"
+#include "PolyhedronComponent.h"
+#include "PolyhedronOperations.h"
+
+/**
+ * One tile of a streamed polyhedron at one depth: the polygons that the notation makes over one polygon of its base
+ * level, once Depth refinement steps are applied. A skirt hangs from the rim of the tile towards the center of the
+ * polyhedron, to hide the cracks towards the neighbor tiles of other depths.
+ */
+struct POLYHEDRON_API FPolyhedronStreamingTile {
+  int32 TileIndex = INDEX_NONE;
+  int32 Depth = 0;
+  // The polygons of the tile, without its skirt, scaled like the full polyhedron.
+  FPolyhedronMesh Polyhedron;
+  // The mesh buffers of the tile and its skirt, all with the first material.
+  FPolyhedronSection Section;
+  // The memory held by the polyhedron and the section, measured once the tile is built.
+  int64 AllocatedSize = 0;
+  // The polygons of the patch that the tile was cut from, at its depth: the work that refining it took.
+  int32 PatchPolygonCount = 0;
+};
+
+/**
+ * Streams the surface of a polyhedron that is too large to hold in full.
+ * The notation is split in two: its base steps run once on the whole polyhedron, and each polygon of that base level
+ * becomes a tile. The remaining refinement steps only run on a patch around a tile, which keeps the polygons that descend
+ * from it; each refinement step is one more level of detail. The tiles close to the viewers are refined to the full
+ * notation, the others stop at coarser depths, within a memory budget.
+ * Update() runs on the game thread and generates the tiles on worker threads. The rest is immutable once constructed.
+ */
+class POLYHEDRON_API FPolyhedronStreamer {
+public:
+  // The base steps run until the polyhedron has BasePolygonCount polygons, and always include the canonicalization and
+  // reflection steps, which move every vertex of the polyhedron. They also run until the patch around a tile stays well
+  // below half of the polyhedron at the full depth. The streamer stays invalid when the predicted size of the base steps
+  // is over the memory budget, see FPolyhedronTools::CheckMemoryBudget().
+  FPolyhedronStreamer(const FString& ConwayPolyhedronNotation, float Scale = 100.0, EPolyhedronUVGeneration UVGeneration = EPolyhedronUVGeneration::Spherical, const FPolyhedronOperationParameters& OperationParameters = FPolyhedronOperationParameters(), int32 BasePolygonCount = 500);
+  ~FPolyhedronStreamer();
+  FPolyhedronStreamer(const FPolyhedronStreamer&) = delete;
+  FPolyhedronStreamer& operator=(const FPolyhedronStreamer&) = delete;
+
+public: // Tiles
+  bool IsValid() const { return Base.IsValid(); }
+  // The base level, scaled like the full polyhedron; each of its polygons is a tile.
+  const FPolyhedronMesh& GetBasePolyhedron() const;
+  int32 GetTileCount() const;
+  // The number of refinement steps; the tiles at this depth make up the full polyhedron. A tile that cannot be cut at a
+  // depth is generated without TileIndex, and Update() keeps it coarser from then on.
+  int32 GetMaxDepth() const;
+  // Generates one tile right away, on the calling thread.
+  FPolyhedronStreamingTile GenerateTile(int32 TileIndex, int32 Depth) const;
+
+public: // Streaming
+  struct FSettings {
+    // The tiles within DetailDistance of a viewer get the full depth; each doubling of the distance drops one step.
+    double DetailDistance = 1000.0;
+    // Caps the estimated size of the resident tiles; the farthest tiles are kept coarser to stay within it.
+    int64 MemoryBudgetBytes = 256ll << 20;
+  };
+  // Picks the depth of every tile from the viewer locations, in the space of the polyhedron, then starts and collects
+  // the generation jobs. Returns the indices of the tiles whose resident mesh changed.
+  TArray<int32> Update(TArrayView<const FVector> ViewLocations, const FSettings& Settings);
+  // The tile currently shown; the base level until a finer depth is generated.
+  const FPolyhedronStreamingTile& GetResidentTile(int32 TileIndex) const { return *ResidentTiles[TileIndex]; }
+  int64 GetResidentSize() const { return ResidentSize; }
+  int32 GetJobCount() const { return Jobs.Num(); }
+
+private:
+  struct FBase;
+  struct FJob;
+  TSharedPtr<const FBase, ESPMode::ThreadSafe> Base;
+  TArray<TSharedPtr<const FPolyhedronStreamingTile, ESPMode::ThreadSafe>> ResidentTiles;
+  TArray<int32> TargetDepths;
+  TArray<int32> TileMaxDepths;
+  TArray<TSharedPtr<FJob, ESPMode::ThreadSafe>> Jobs;
+  int64 ResidentSize = 0;
+};
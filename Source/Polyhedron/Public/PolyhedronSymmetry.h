@@ -0,0 +1,26 @@
+// Copyright 2024 TabbyCoder
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Polyhedron.h"
+#include "PolyhedronOperations.h"
+#include "PolyhedronSymmetry.generated.h"
+
+/**
+ * Symmetry-aware generation. The seeds are highly symmetric and the Conway operations preserve their rotations:
+ * once the mesh is fine enough, the remaining operations only run on a patch around one fundamental domain of the
+ * seed's rotation group. The domain is then replicated with the rotations, and welded into the full polyhedron.
+ */
+USTRUCT()
+struct POLYHEDRON_API FPolyhedronSymmetry {
+  GENERATED_BODY()
+
+public:
+  // Same polyhedron as FPolyhedronTools::GenerateFromConwayPolyhedronNotation(), but exactly symmetric: the normals of
+  // non-planar polygons depend on their first vertex, so the two can differ by a tiny fraction of an edge.
+  // Falls back to the full generation whenever a patch would not pay off, or would not weld into a closed mesh.
+  static FPolyhedronMesh GenerateFromConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, float Scale = 100.0, const FPolyhedronOperationParameters& Parameters = FPolyhedronOperationParameters());
+  // The rotations about the origin that map the polyhedron onto itself, starting with the identity.
+  static TArray<FMatrix> FindRotations(const FPolyhedronMesh& Polyhedron);
+};
@@ -0,0 +1,72 @@
+// Copyright 2024 TabbyCoder
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Polyhedron.h"
+#include "PolyhedronComponent.h"
+
+/**
+ * How FPolyhedronTerrain splits its surface into chunks.
+ */
+struct POLYHEDRON_API FPolyhedronTerrainSettings {
+  // The chunks grow from seeds spread evenly over the surface, about one per ChunkPolygonCount polygons; each chunk is
+  // one mesh section.
+  int32 ChunkPolygonCount = 1024;
+  // The walls take the texture coordinates of the rims of the caps above and below them. CellularArray falls back to
+  // Cellular, since the chunks take over the mesh sections.
+  EPolyhedronUVGeneration UVGeneration = EPolyhedronUVGeneration::Spherical;
+};
+
+/**
+ * Raises each polygon of a closed polyhedron, as the cap of a cell, by its own height along the directions of its vertices
+ * from the center of the polyhedron. Walls close the steps between neighbor cells of different heights.
+ * The cells are grouped into chunks of neighbors with the same material, one mesh section each. A height edit only
+ * dirties the chunks of the cell and of the walls along it, and Update() only rewrites the vertices of the dirty chunks.
+ * Every edge keeps its wall, flat between cells of the same height, so that the chunks never change their triangles and
+ * UPolyhedronComponent::UpdatePolyhedronTerrain() can update their sections in place.
+ */
+class POLYHEDRON_API FPolyhedronTerrain {
+public:
+  FPolyhedronTerrain(const FPolyhedronMesh& Polyhedron, const FPolyhedronTerrainSettings& Settings = FPolyhedronTerrainSettings());
+
+public: // Heights
+  int32 GetPolygonCount() const { return Heights.Num(); }
+  float GetHeight(int32 PolygonIndex) const { return Heights[PolygonIndex]; }
+  void SetHeight(int32 PolygonIndex, float Height);
+  // Only dirties the chunks around the heights that change.
+  void SetHeights(TArrayView<const float> InHeights);
+
+public: // Chunks
+  int32 GetChunkCount() const { return Chunks.Num(); }
+  int32 GetChunkIndex(int32 PolygonIndex) const { return PolygonChunkIndices[PolygonIndex]; }
+  bool IsChunkDirty(int32 ChunkIndex) const { return DirtyChunks[ChunkIndex]; }
+  // Moves the vertices of the dirty chunks to their heights, in parallel, and returns the indices of these chunks.
+  TArray<int32> Update();
+  // The caps of the chunk, in polygon order, followed by its walls. The material index of the section is the one of its cells.
+  const FPolyhedronSection& GetChunkSection(int32 ChunkIndex) const { return Chunks[ChunkIndex].Section; }
+
+private:
+  // The wall along a half-edge of a polygon, towards the polygon across it; it belongs to the lower polygon index.
+  struct FWall {
+    int32 PolygonIndex;
+    int32 PolygonIndexAcross;
+    int32 VertexIndexFrom, VertexIndexTo;
+  };
+  struct FChunk {
+    int32 MaterialIndex = 0;
+    TArray<int32> PolygonIndices;
+    TArray<FWall> Walls;
+    FPolyhedronSection Section;
+  };
+  void DisplaceChunk(FChunk& Chunk) const;
+  FVector GetDisplacedVertex(int32 VertexIndex, float Height) const { return Polyhedron.Vertices[VertexIndex] + Height * VertexDirections[VertexIndex]; }
+
+  FPolyhedronMesh Polyhedron;
+  FPolyhedronPolygonGraph Graph;
+  TArray<FVector> VertexDirections;
+  TArray<float> Heights;
+  TArray<int32> PolygonChunkIndices;
+  TArray<FChunk> Chunks;
+  TBitArray<> DirtyChunks;
+};
@@ -6,14 +6,43 @@
 
 #include "CoreMinimal.h"
 #include "Polyhedron.h"
+#include "PolyhedronOperations.h"
 #include "PolyhedronTools.generated.h"
 
+/**
+ * One parsed symbol of a Conway Polyhedron Notation string, with its numeric argument.
+ */
+USTRUCT()
+struct POLYHEDRON_API FPolyhedronNotationStep {
+  GENERATED_BODY()
+
+public:
+  TCHAR Symbol = 0;
+  int32 Argument = 0;
+  // Only used by the symbols with two arguments, written "G3,1".
+  int32 SecondArgument = 0;
+};
+
 USTRUCT()
 struct POLYHEDRON_API FPolyhedronTools {
   GENERATED_BODY()
 
 public: // Conway Notation
-  static FPolyhedronMesh GenerateFromConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, float Scale = 100.0);
+  static FPolyhedronMesh GenerateFromConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, float Scale = 100.0, const FPolyhedronOperationParameters& Parameters = FPolyhedronOperationParameters());
+  // Splits the notation into steps, in processing order: the seed comes first, followed by the operations.
+  static bool ParseConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, TArray<FPolyhedronNotationStep>& OutSteps);
+  // With a Recorder, the operations also record how their vertices derive from their input, see FPolyhedronParametricMesh.
+  static FPolyhedronMesh ApplyConwayPolyhedronNotationStep(const FPolyhedronNotationStep& Step, const FPolyhedronMesh& Input, const FPolyhedronOperationParameters& Parameters = FPolyhedronOperationParameters(), FPolyhedronOperationRecorder* Recorder = nullptr);
+
+public: // Size Prediction
+  // Predicts the size of the polyhedron that the notation builds, and the most memory that building it holds at once, from
+  // the element counts alone: only the Platonic seeds are built. Fails on the notations and seeds that cannot be generated,
+  // without reporting them again. Stops at the first step past the int32 indices, which is already too large.
+  static bool PredictConwayPolyhedronNotation(const FString& ConwayPolyhedronNotation, FPolyhedronMeshSize& OutSize);
+  static bool PredictConwayPolyhedronNotation(TArrayView<const FPolyhedronNotationStep> Steps, FPolyhedronMeshSize& OutSize);
+  // Reports an error and returns false when a polyhedron of this size does not fit in the int32 indices, or when building
+  // it would hold more than Polyhedron.Generation.MemoryBudgetMB at once.
+  static bool CheckMemoryBudget(const FPolyhedronMeshSize& Size);
 
 public: // Polygon Operations
   static FVector CalculateNormal(const FVector& Position1, const FVector& Position2, const FVector& Position3);
@@ -21,13 +50,35 @@ public: // Polygon Operations
   static TArray<FVector> GetPolygonNormals(const FPolyhedronMesh& Input);
   static FVector GetPolygonCenter(const FPolyhedronMesh& Polyhedron, const FPolyhedronPolygon& Polygon);
   static FVector GetPolygonNormal(const FPolyhedronMesh& Polyhedron, const FPolyhedronPolygon& Polygon);
+  // Same as above, on a bare vertex array, and without reporting the incomplete polygons: their normal is zero.
+  static FVector GetPolygonNormal(TArrayView<const FVector> Vertices, const FPolyhedronPolygon& Polygon);
 
 public: // Polyhedra Operations
   static FPolyhedronMesh ScaleToSphere(const FPolyhedronMesh& Input, double Radius = 100.0);
   static FPolyhedronMesh ProjectUntoSphere(const FPolyhedronMesh& Input, double Radius = 100.0);
+  // Moves the vertices towards the canonical form of the polyhedron, keeping its topology: every polygon becomes planar
+  // and every edge tangent to the unit sphere. Stops once no vertex moves more than Tolerance in an iteration, after
+  // MaxIterations, or after the first iteration that ends past TimeBudgetSeconds; zero means no time budget.
+  static FPolyhedronMesh Canonicalize(const FPolyhedronMesh& Input, int32 MaxIterations = 200, double Tolerance = 1e-6, double TimeBudgetSeconds = 0.0);
 
 public: // Polyhedra Extended Operations
+  // The result refers to Input, which must outlive it.
   static FPolyhedronExtendedMesh ComputeEdgeDetails(const FPolyhedronMesh& Input);
+  static FPolyhedronExtendedMesh ComputeEdgeDetails(FPolyhedronMesh&& Input) = delete;
+  // The polygon adjacency of a closed polyhedron, for FPolyhedronPathfinder.
+  static FPolyhedronPolygonGraph ComputePolygonGraph(const FPolyhedronMesh& Input);
+
+public: // Patches
+  // The number of primitive operations (the local operators and Subdivide) behind each operation symbol.
+  // Each one spreads the influence of a vertex by about one ring of polygons.
+  static int32 GetPrimitiveOperationCount(TCHAR Symbol);
+  // Cuts the selected polygons out of the polyhedron, and closes the hole with a single cap polygon, so that the Conway
+  // operations can run on the patch alone. Only the vertices on the rim of the cap are returned as tainted.
+  // The selection may grow to find a simple rim; fails once it would cover half of the polyhedron.
+  static bool CutPatch(const FPolyhedronMesh& Polyhedron, TBitArray<> Selection, FPolyhedronMesh& OutPatch, TBitArray<>& OutTainted);
+  // A vertex is tainted when the cap influenced it: through its recipe terms, or through the normal of a tainted polygon.
+  // After the operations, the polygons without tainted vertices are exactly the ones that the full polyhedron has.
+  static TBitArray<> PropagateTaint(TBitArray<> Tainted, const FPolyhedronOperationRecorder& Recorder);
 
 public: // Locations
   static int32 GetPolygonAt(const FPolyhedronMesh& Input, const FVector& Location);